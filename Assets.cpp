@@ -0,0 +1,167 @@
+#include "Assets.h"
+#include "GG_AssetPack.h"
+
+#include <SDL_image.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+const TextureAsset TEXTURE_ASSETS[] = {
+    { TEX_BACKGROUND1,         TEX_BACKGROUND_GRAY1,      "Background1",    "BackgroundGray1",      "Layer1.png",               1 },
+    { TEX_BACKGROUND2,         TEX_BACKGROUND_GRAY2,      "Background2",    "BackgroundGray2",      "Layer2.png",               1 },
+    { TEX_BACKGROUND3,         TEX_BACKGROUND_GRAY3,      "Background3",    "BackgroundGray3",      "Layer3.png",               1 },
+    { TEX_BACKGROUND4,         TEX_BACKGROUND_GRAY4,      "Background4",    "BackgroundGray4",      "Layer4.png",               1 },
+    { TEX_BACKGROUND5,         TEX_BACKGROUND_GRAY5,      "Background5",    "BackgroundGray5",      "Layer5.png",               1 },
+    { TEX_BACKGROUND6,         TEX_BACKGROUND_GRAY6,      "Background6",    "BackgroundGray6",      "Layer6.png",               1 },
+    { TEX_BACKGROUND7,         TEX_BACKGROUND_GRAY7,      "Background7",    "BackgroundGray7",      "Layer7.png",               1 },
+    { TEX_FOREGROUND,          TEX_FOREGROUND_GRAY,       "Foreground",     "ForegroundGray",       "Layer0.png",               1 },
+    { TEX_TILES,               TEX_TILES_GRAY,            "Tiles",          "TilesGray",            "tiles.tga",                7 },
+    { TEX_TILES2,              TEX_TILES2_GRAY,           "Tiles2",         "TilesGray2",           "tiles2.tga",               7 },
+    { TEX_EXPLOSION,           TEX_EXPLOSION_GRAY,        "Explosion",      "ExplosionGray",        "explosion.tga",            16 },
+    { TEX_ROBOT_IDLE,          TEX_ROBOT_IDLE_GRAY,       "RobotIdle",      "RobotIdleGray",        "robot_idle.png",           8 },
+    { TEX_ROBOT_RUN,           TEX_ROBOT_RUN_GRAY,        "RobotRun",       "RobotRunGray",         "robot_run.png",            6 },
+    { TEX_ROBOT_JUMP,          TEX_ROBOT_JUMP_GRAY,       "RobotJump",      "RobotJumpGray",        "robot_jump.png",           8 },
+    { TEX_ROBOT_DIE,           TEX_ROBOT_DIE_GRAY,        "RobotDie",       "RobotDieGray",         "robot_die.png",            8 },
+    { TEX_ROBOT_WALK,          TEX_ROBOT_WALK_GRAY,       "RobotWalk",      "RobotWalkGray",        "robot_walk.png",           8 },
+    { TEX_ROBOT_CELEBRATE,     TEX_ROBOT_CELEBRATE_GRAY,  "RobotCelebrate", "RobotCelebrateGray",   "robot_celebrate.png",      13 },
+    { TEX_METEOR,              TEX_METEOR_GRAY,           "Meteor",         "MeteorGray",           "meteor.png",               1 },
+    { TEX_CRAWLER_WALK,        TEX_CRAWLER_WALK_GRAY,     "CrawlerWalk",    "CrawlerWalkGray",      "crawler_walk.png",         8 },
+    { TEX_CRAWLER_IDLE,        TEX_CRAWLER_IDLE_GRAY,     "CrawlerIdle",    "CrawlerIdleGray",      "crawler_idle.png",         8 },
+    { TEX_CRAWLER_WALK_PINK,   GG::INVALID_TEXTURE_ID,    "CrawlerWalkPink", NULL,                  "crawler_walk_pink.png",    8 },
+    { TEX_CRAWLER_IDLE_PINK,   GG::INVALID_TEXTURE_ID,    "CrawlerIdlePink", NULL,                  "crawler_idle_pink.png",    8 },
+    { TEX_CRAWLER_DIE,         TEX_CRAWLER_DIE_GRAY,      "CrawlerDie",     "CrawlerDieGray",       "crawler_die.png",          8 },
+    { TEX_COIN,                TEX_COIN_GRAY,             "Coin",           "CoinGray",             "coin.png",                 10 },
+    { TEX_FLAG_POLE,           TEX_FLAG_POLE_GRAY,        "FlagPole",       "FlagPoleGray",         "flagpole.png",             1 },
+    { TEX_MUSHROOM,            TEX_MUSHROOM_GRAY,         "Mushroom",       "MushroomGray",         "mushroom.png",             1 },
+};
+
+const int NUM_TEXTURE_ASSETS = sizeof(TEXTURE_ASSETS) / sizeof(TEXTURE_ASSETS[0]);
+
+const char* const LEVEL_FILES[] = {
+    "0.txt", "1.txt", "2.txt", "3.txt", "4.txt", "5.txt", "6.txt"
+};
+
+const int NUM_LEVEL_FILES = sizeof(LEVEL_FILES) / sizeof(LEVEL_FILES[0]);
+
+bool InternTextureIds(GG::TextureManager* texMgr)
+{
+    bool ok = true;
+
+    for (int i = 0; i < NUM_TEXTURE_ASSETS; i++) {
+        const TextureAsset& asset = TEXTURE_ASSETS[i];
+
+        if (texMgr->InternTexture(asset.name) != asset.id) {
+            ok = false;
+        }
+        if (asset.grayName && texMgr->InternTexture(asset.grayName) != asset.grayId) {
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "*** The BuiltinTexture ids don't match the texture manifest" << std::endl;
+    }
+    return ok;
+}
+
+const ClipAsset CLIP_ASSETS[] = {
+    { CLIP_BACKGROUND1,        "Background1",       TEX_BACKGROUND1,       TEX_BACKGROUND_GRAY1,      0.0f,   false },
+    { CLIP_BACKGROUND2,        "Background2",       TEX_BACKGROUND2,       TEX_BACKGROUND_GRAY2,      0.0f,   false },
+    { CLIP_BACKGROUND3,        "Background3",       TEX_BACKGROUND3,       TEX_BACKGROUND_GRAY3,      0.0f,   false },
+    { CLIP_BACKGROUND4,        "Background4",       TEX_BACKGROUND4,       TEX_BACKGROUND_GRAY4,      0.0f,   false },
+    { CLIP_BACKGROUND5,        "Background5",       TEX_BACKGROUND5,       TEX_BACKGROUND_GRAY5,      0.0f,   false },
+    { CLIP_BACKGROUND6,        "Background6",       TEX_BACKGROUND6,       TEX_BACKGROUND_GRAY6,      0.0f,   false },
+    { CLIP_BACKGROUND7,        "Background7",       TEX_BACKGROUND7,       TEX_BACKGROUND_GRAY7,      0.0f,   false },
+    { CLIP_FOREGROUND,         "Foreground",        TEX_FOREGROUND,        TEX_FOREGROUND_GRAY,       0.0f,   false },
+    { CLIP_TILES,              "Tiles",             TEX_TILES,             TEX_TILES_GRAY,            0.0f,   false },
+    { CLIP_TILES2,             "Tiles2",            TEX_TILES2,            TEX_TILES2_GRAY,           0.0f,   false },
+    { CLIP_EXPLOSION,          "Explosion",         TEX_EXPLOSION,         TEX_EXPLOSION_GRAY,        1.15f,  false },
+    { CLIP_ROBOT_IDLE,         "RobotIdle",         TEX_ROBOT_IDLE,        TEX_ROBOT_IDLE_GRAY,       1.0f,   true },
+    { CLIP_ROBOT_RUN,          "RobotRun",          TEX_ROBOT_RUN,         TEX_ROBOT_RUN_GRAY,        0.5f,   true },
+    { CLIP_ROBOT_JUMP,         "RobotJump",         TEX_ROBOT_JUMP,        TEX_ROBOT_JUMP_GRAY,       1.0f,   true },
+    { CLIP_ROBOT_DIE,          "RobotDie",          TEX_ROBOT_DIE,         TEX_ROBOT_DIE_GRAY,        1.4f,   false },
+    { CLIP_ROBOT_WALK,         "RobotWalk",         TEX_ROBOT_WALK,        TEX_ROBOT_WALK_GRAY,       1.0f,   true },
+    { CLIP_ROBOT_CELEBRATE,    "RobotCelebrate",    TEX_ROBOT_CELEBRATE,   TEX_ROBOT_CELEBRATE_GRAY,  1.4f,   true },
+    { CLIP_METEOR,             "Meteor",            TEX_METEOR,            TEX_METEOR_GRAY,           0.0f,   false },
+    { CLIP_CRAWLER_WALK,       "CrawlerWalk",       TEX_CRAWLER_WALK,      TEX_CRAWLER_WALK_GRAY,     0.5f,   true },
+    { CLIP_CRAWLER_IDLE,       "CrawlerIdle",       TEX_CRAWLER_IDLE,      TEX_CRAWLER_IDLE_GRAY,     0.5f,   true },
+    { CLIP_CRAWLER_WALK_PINK,  "CrawlerWalkPink",   TEX_CRAWLER_WALK_PINK, TEX_CRAWLER_WALK_GRAY,     0.5f,   true },   // there's no pink grayscale,
+    { CLIP_CRAWLER_IDLE_PINK,  "CrawlerIdlePink",   TEX_CRAWLER_IDLE_PINK, TEX_CRAWLER_IDLE_GRAY,     0.5f,   true },   // it looks the same
+    { CLIP_CRAWLER_DIE,        "CrawlerDie",        TEX_CRAWLER_DIE,       TEX_CRAWLER_DIE_GRAY,      0.5f,   false },
+    { CLIP_COIN,               "Coin",              TEX_COIN,              TEX_COIN_GRAY,             0.75f,  true },
+    { CLIP_FLAG_POLE,          "FlagPole",          TEX_FLAG_POLE,         TEX_FLAG_POLE_GRAY,        0.0f,   false },
+    { CLIP_MUSHROOM,           "Mushroom",          TEX_MUSHROOM,          TEX_MUSHROOM_GRAY,         0.0f,   false },
+};
+
+const int NUM_CLIP_ASSETS = sizeof(CLIP_ASSETS) / sizeof(CLIP_ASSETS[0]);
+
+bool RegisterClips(GG::ClipLibrary* clips, const GG::TextureManager* texMgr)
+{
+    bool ok = true;
+
+    for (int i = 0; i < NUM_CLIP_ASSETS; i++) {
+        const ClipAsset& asset = CLIP_ASSETS[i];
+
+        GG::ClipId id = clips->AddClip(asset.name, texMgr->GetTexture(asset.texId), texMgr->GetTexture(asset.grayTexId),
+                                       asset.duration, asset.loopable);
+        if (id != asset.id) {
+            ok = false;
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "*** The BuiltinClip ids don't match the clip manifest" << std::endl;
+    }
+    return ok;
+}
+
+bool BuildAssetPack(const std::string& mediaDir, const std::string& packPath)
+{
+    if (!IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG)) {
+        std::cerr << "*** Failed to initialize SDL_image: " << IMG_GetError() << std::endl;
+        return false;
+    }
+
+    GG::AssetPackWriter writer;
+    bool ok = true;
+
+    for (int i = 0; i < NUM_TEXTURE_ASSETS && ok; i++) {
+        const TextureAsset& asset = TEXTURE_ASSETS[i];
+
+        SDL_Surface* surf = IMG_Load((mediaDir + asset.filename).c_str());
+        if (!surf) {
+            std::cerr << "*** Failed to load image '" << asset.filename << "': " << IMG_GetError() << std::endl;
+            ok = false;
+            break;
+        }
+
+        ok = writer.AddImage(asset.filename, asset.name, asset.grayName ? asset.grayName : "", asset.numCells, surf);
+        SDL_FreeSurface(surf);
+    }
+
+    for (int i = 0; i < NUM_LEVEL_FILES && ok; i++) {
+        std::ifstream f((mediaDir + LEVEL_FILES[i]).c_str(), std::ios::binary);
+        if (!f.good()) {
+            std::cerr << "*** Error: failed to open " << LEVEL_FILES[i] << std::endl;
+            ok = false;
+            break;
+        }
+
+        std::vector<char> text((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        ok = writer.AddText(LEVEL_FILES[i], text.empty() ? NULL : &text[0], text.size());
+    }
+
+    if (ok) {
+        ok = writer.Write(packPath);
+    }
+
+    if (ok) {
+        std::cout << "*** Wrote " << NUM_TEXTURE_ASSETS << " images and " << NUM_LEVEL_FILES
+                  << " levels to '" << packPath << "'" << std::endl;
+    }
+
+    IMG_Quit();
+    return ok;
+}
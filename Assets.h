@@ -0,0 +1,185 @@
+#ifndef ASSETS_H_
+#define ASSETS_H_
+
+#include "GG_AnimationClip.h"
+#include "GG_Graphics.h"
+
+#include <string>
+
+/*
+================================================================================
+
+Built-in texture ids
+
+    The ids of the textures in the manifest below, in manifest order (each
+    texture followed by its grayscale version, if it has one).  Calling
+    InternTextureIds right after creating the TextureManager makes these
+    the actual ids, so entities can look up their textures without going
+    through the names at all.
+
+================================================================================
+*/
+enum BuiltinTexture {
+    TEX_BACKGROUND1,        TEX_BACKGROUND_GRAY1,
+    TEX_BACKGROUND2,        TEX_BACKGROUND_GRAY2,
+    TEX_BACKGROUND3,        TEX_BACKGROUND_GRAY3,
+    TEX_BACKGROUND4,        TEX_BACKGROUND_GRAY4,
+    TEX_BACKGROUND5,        TEX_BACKGROUND_GRAY5,
+    TEX_BACKGROUND6,        TEX_BACKGROUND_GRAY6,
+    TEX_BACKGROUND7,        TEX_BACKGROUND_GRAY7,
+    TEX_FOREGROUND,         TEX_FOREGROUND_GRAY,
+    TEX_TILES,              TEX_TILES_GRAY,
+    TEX_TILES2,             TEX_TILES2_GRAY,
+    TEX_EXPLOSION,          TEX_EXPLOSION_GRAY,
+    TEX_ROBOT_IDLE,         TEX_ROBOT_IDLE_GRAY,
+    TEX_ROBOT_RUN,          TEX_ROBOT_RUN_GRAY,
+    TEX_ROBOT_JUMP,         TEX_ROBOT_JUMP_GRAY,
+    TEX_ROBOT_DIE,          TEX_ROBOT_DIE_GRAY,
+    TEX_ROBOT_WALK,         TEX_ROBOT_WALK_GRAY,
+    TEX_ROBOT_CELEBRATE,    TEX_ROBOT_CELEBRATE_GRAY,
+    TEX_METEOR,             TEX_METEOR_GRAY,
+    TEX_CRAWLER_WALK,       TEX_CRAWLER_WALK_GRAY,
+    TEX_CRAWLER_IDLE,       TEX_CRAWLER_IDLE_GRAY,
+    TEX_CRAWLER_WALK_PINK,
+    TEX_CRAWLER_IDLE_PINK,
+    TEX_CRAWLER_DIE,        TEX_CRAWLER_DIE_GRAY,
+    TEX_COIN,               TEX_COIN_GRAY,
+    TEX_FLAG_POLE,          TEX_FLAG_POLE_GRAY,
+    TEX_MUSHROOM,           TEX_MUSHROOM_GRAY,
+
+    NUM_BUILTIN_TEXTURES
+};
+
+/*
+================================================================================
+
+Asset manifest
+
+    Every texture the game loads at startup, and every level file, in one
+    place.  Game::LoadTextures loads the textures from this table, and the
+    asset pack builder packs the same table, so the two can't drift apart.
+
+    Textures with a grayName also get a grayscale version under that name.
+
+================================================================================
+*/
+struct TextureAsset {
+    GG::TextureId           id;
+    GG::TextureId           grayId;         // INVALID_TEXTURE_ID if there's no grayscale version
+    const char*             name;
+    const char*             grayName;       // NULL if there's no grayscale version
+    const char*             filename;       // relative to the media directory
+    int                     numCells;
+};
+
+extern const TextureAsset   TEXTURE_ASSETS[];
+extern const int            NUM_TEXTURE_ASSETS;
+
+extern const char* const    LEVEL_FILES[];  // relative to the media directory, indexed by scene
+extern const int            NUM_LEVEL_FILES;
+
+/*
+================================================================================
+
+InternTextureIds
+
+    Interns the manifest's texture names, so that they get the ids in the
+    BuiltinTexture enum.  Must be called before any textures are loaded.
+    Returns false if the enum and the manifest disagree.
+
+================================================================================
+*/
+bool InternTextureIds(GG::TextureManager* texMgr);
+
+/*
+================================================================================
+
+Built-in animation clips
+
+    The ids of the clips in the clip manifest below, in manifest order.
+    RegisterClips makes these the actual ids, the same way InternTextureIds
+    does for the textures.
+
+================================================================================
+*/
+enum BuiltinClip {
+    CLIP_BACKGROUND1,
+    CLIP_BACKGROUND2,
+    CLIP_BACKGROUND3,
+    CLIP_BACKGROUND4,
+    CLIP_BACKGROUND5,
+    CLIP_BACKGROUND6,
+    CLIP_BACKGROUND7,
+    CLIP_FOREGROUND,
+    CLIP_TILES,
+    CLIP_TILES2,
+    CLIP_EXPLOSION,
+    CLIP_ROBOT_IDLE,
+    CLIP_ROBOT_RUN,
+    CLIP_ROBOT_JUMP,
+    CLIP_ROBOT_DIE,
+    CLIP_ROBOT_WALK,
+    CLIP_ROBOT_CELEBRATE,
+    CLIP_METEOR,
+    CLIP_CRAWLER_WALK,
+    CLIP_CRAWLER_IDLE,
+    CLIP_CRAWLER_WALK_PINK,
+    CLIP_CRAWLER_IDLE_PINK,
+    CLIP_CRAWLER_DIE,
+    CLIP_COIN,
+    CLIP_FLAG_POLE,
+    CLIP_MUSHROOM,
+
+    NUM_BUILTIN_CLIPS
+};
+
+/*
+================================================================================
+
+Clip manifest
+
+    Every animation clip, and the still image of everything that doesn't
+    animate, with the textures it plays.  A duration of 0 makes a still.
+
+================================================================================
+*/
+struct ClipAsset {
+    GG::ClipId              id;
+    const char*             name;
+    GG::TextureId           texId;
+    GG::TextureId           grayTexId;
+    float                   duration;       // in seconds, 0 for stills
+    bool                    loopable;
+};
+
+extern const ClipAsset      CLIP_ASSETS[];
+extern const int            NUM_CLIP_ASSETS;
+
+/*
+================================================================================
+
+RegisterClips
+
+    Adds the manifest's clips to clips, so that they get the ids in the
+    BuiltinClip enum.  The textures have to be loaded by now.  Returns
+    false if the enum and the manifest disagree.
+
+================================================================================
+*/
+bool RegisterClips(GG::ClipLibrary* clips, const GG::TextureManager* texMgr);
+
+/*
+================================================================================
+
+BuildAssetPack
+
+    Decodes everything in the manifest from the media directory and writes
+    it all into an asset pack (see GG_AssetPack.h).  This is the offline
+    part of the asset pipeline, run with --build-pack; it needs SDL_image,
+    but no window or renderer.
+
+================================================================================
+*/
+bool BuildAssetPack(const std::string& mediaDir, const std::string& packPath);
+
+#endif
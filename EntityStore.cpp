@@ -0,0 +1,734 @@
+#include "EntityStore.h"
+#include "Assets.h"
+
+#include <iostream>
+
+static const float CRAWLER_SPEED = 60;      // default speed in pixels per second
+static const float METEOR_SPEED = 200;      // in pixels per second
+
+/*
+================================================================================
+
+RemoveAt
+
+    Removes element i from a component array by moving the last element
+    into its place.
+
+================================================================================
+*/
+template <class T>
+static void RemoveAt(std::vector<T>& v, int i)
+{
+    v[i] = v.back();
+    v.pop_back();
+}
+
+static void RemoveAt(GG::RenderableArray& a, int i)
+{
+    a.Remove(i);
+}
+
+//
+// The tables
+//
+
+void CrawlerTable::Reserve(int n)
+{
+    posX.reserve(n);
+    posY.reserve(n);
+    rect.reserve(n);
+    prevRect.reserve(n);
+    collisionRect.reserve(n);
+    tileRect.reserve(n);
+    anim.Reserve(n);
+    ai.reserve(n);
+    grayscale.reserve(n);
+}
+
+void CrawlerTable::Remove(int i)
+{
+    RemoveAt(posX, i);
+    RemoveAt(posY, i);
+    RemoveAt(rect, i);
+    RemoveAt(prevRect, i);
+    RemoveAt(collisionRect, i);
+    RemoveAt(tileRect, i);
+    RemoveAt(anim, i);
+    RemoveAt(ai, i);
+    RemoveAt(grayscale, i);
+}
+
+void CrawlerTable::Clear()
+{
+    posX.clear();
+    posY.clear();
+    rect.clear();
+    prevRect.clear();
+    collisionRect.clear();
+    tileRect.clear();
+    anim.Clear();
+    ai.clear();
+    grayscale.clear();
+}
+
+void CoinTable::Reserve(int n)
+{
+    rect.reserve(n);
+    anim.Reserve(n);
+    soundDelay.reserve(n);
+    grayscale.reserve(n);
+}
+
+void CoinTable::Remove(int i)
+{
+    RemoveAt(rect, i);
+    RemoveAt(anim, i);
+    RemoveAt(soundDelay, i);
+    RemoveAt(grayscale, i);
+}
+
+void CoinTable::Clear()
+{
+    rect.clear();
+    anim.Clear();
+    soundDelay.clear();
+    grayscale.clear();
+}
+
+void MeteorTable::Reserve(int n)
+{
+    posY.reserve(n);
+    rect.reserve(n);
+    prevRect.reserve(n);
+    anim.Reserve(n);
+    rotAngle.reserve(n);
+    rotSpeed.reserve(n);
+    grayscale.reserve(n);
+}
+
+void MeteorTable::Remove(int i)
+{
+    RemoveAt(posY, i);
+    RemoveAt(rect, i);
+    RemoveAt(prevRect, i);
+    RemoveAt(anim, i);
+    RemoveAt(rotAngle, i);
+    RemoveAt(rotSpeed, i);
+    RemoveAt(grayscale, i);
+}
+
+void MeteorTable::Clear()
+{
+    posY.clear();
+    rect.clear();
+    prevRect.clear();
+    anim.Clear();
+    rotAngle.clear();
+    rotSpeed.clear();
+    grayscale.clear();
+}
+
+void ExplosionTable::Reserve(int n)
+{
+    rect.reserve(n);
+    anim.Reserve(n);
+    timeToLive.reserve(n);
+    grayscale.reserve(n);
+}
+
+void ExplosionTable::Remove(int i)
+{
+    RemoveAt(rect, i);
+    RemoveAt(anim, i);
+    RemoveAt(timeToLive, i);
+    RemoveAt(grayscale, i);
+}
+
+void ExplosionTable::Clear()
+{
+    rect.clear();
+    anim.Clear();
+    timeToLive.clear();
+    grayscale.clear();
+}
+
+void MushroomTable::Reserve(int n)
+{
+    rect.reserve(n);
+    anim.Reserve(n);
+    grayscale.reserve(n);
+}
+
+void MushroomTable::Remove(int i)
+{
+    RemoveAt(rect, i);
+    RemoveAt(anim, i);
+    RemoveAt(grayscale, i);
+}
+
+void MushroomTable::Clear()
+{
+    rect.clear();
+    anim.Clear();
+    grayscale.clear();
+}
+
+/*
+================================================================================
+
+EntityStore constructor
+
+    Creates an empty store.  Call Initialize before spawning anything.
+
+================================================================================
+*/
+EntityStore::EntityStore()
+    : mClips(NULL)
+    , mRandom(NULL)
+    , mGrayscale(false)
+{
+    for (int i = 0; i < NUM_KINDS; i++) {
+        mHighWater[i] = 0;
+    }
+}
+
+/*
+================================================================================
+
+EntityStore::Initialize
+
+    Hooks the tables up to the clip library (the clips have to be
+    registered by now) and the world's clip clock, and reserves room for
+    the specified number of entities of each kind.  The crawlers'
+    decisions get drawn from random, which belongs to the world the store
+    is in.
+
+================================================================================
+*/
+void EntityStore::Initialize(const GG::ClipLibrary* clips, const GG::ClipClock* clock, int capacity, GG::Random* random)
+{
+    mClips = clips;
+    mRandom = random;
+
+    mCrawlers.anim.SetClipLibrary(clips);
+    mCoins.anim.SetClipLibrary(clips);
+    mMeteors.anim.SetClipLibrary(clips);
+    mExplosions.anim.SetClipLibrary(clips);
+    mMushrooms.anim.SetClipLibrary(clips);
+
+    mCrawlers.anim.SetClipClock(clock);
+    mCoins.anim.SetClipClock(clock);
+
+    mCrawlers.Reserve(capacity);
+    mCoins.Reserve(capacity);
+    mMeteors.Reserve(capacity);
+    mExplosions.Reserve(capacity);
+    mMushrooms.Reserve(capacity);
+}
+
+/*
+================================================================================
+
+EntityStore::GetCount
+
+    Returns the total number of entities, of all kinds.
+
+================================================================================
+*/
+int EntityStore::GetCount() const
+{
+    return mCrawlers.GetCount() + mCoins.GetCount() + mMeteors.GetCount()
+         + mExplosions.GetCount() + mMushrooms.GetCount();
+}
+
+void EntityStore::NoteCount(Kind kind, int count)
+{
+    if (count > mHighWater[kind]) {
+        mHighWater[kind] = count;
+    }
+}
+
+/*
+================================================================================
+
+EntityStore::SpawnCrawler
+
+    Adds a crawler standing at (x, y) (y is the bottom), facing in the
+    specified direction (-1 for left or 1 for right).  It starts out idle
+    or walking, at random.
+
+================================================================================
+*/
+void EntityStore::SpawnCrawler(float x, float y, bool strong, int direction, float time)
+{
+    CrawlerAI ai;
+    ai.speedScale = 1.0f;
+    ai.nextThinkTime = 0.0f;
+    ai.timeToDeath = mClips->GetClip(CLIP_CRAWLER_DIE)->duration;
+    ai.direction = (Sint8)(direction < 0 ? -1 : 1);
+    ai.state = CRAWLER_INIT;
+    ai.jumpedOn = strong ? 0 : 1;
+
+    mCrawlers.posX.push_back(x);
+    mCrawlers.posY.push_back(y);
+    mCrawlers.rect.push_back(GG::Rect());
+    mCrawlers.prevRect.push_back(GG::Rect());
+    mCrawlers.collisionRect.push_back(GG::Rect(0, 0, 0, 0));
+    mCrawlers.tileRect.push_back(GG::Rect(0, 0, 0, 0));
+    mCrawlers.anim.Add(CLIP_CRAWLER_IDLE);     // SetCrawlerState picks the real one
+    mCrawlers.ai.push_back(ai);
+    mCrawlers.grayscale.push_back(mGrayscale);
+
+    int i = mCrawlers.GetCount() - 1;
+    SetCrawlerState(i, mRandom->Unit() < 0.5f ? CRAWLER_IDLE : CRAWLER_WALK, time);
+    mCrawlers.prevRect[i] = mCrawlers.rect[i];
+
+    NoteCount(KIND_CRAWLER, mCrawlers.GetCount());
+}
+
+/*
+================================================================================
+
+EntityStore::SpawnCoin
+
+    Adds a coin with its bottom left corner at (x, y).
+
+================================================================================
+*/
+void EntityStore::SpawnCoin(float x, float y)
+{
+    const GG::AnimationClip* clip = mClips->GetClip(CLIP_COIN);
+
+    mCoins.rect.push_back(GG::Rect((int)x, (int)(y - clip->frameHeight), clip->frameWidth, clip->frameHeight));
+    mCoins.anim.Add(CLIP_COIN);
+    mCoins.anim[mCoins.GetCount() - 1].Sync();
+    mCoins.soundDelay.push_back(0);
+    mCoins.grayscale.push_back(mGrayscale);
+
+    NoteCount(KIND_COIN, mCoins.GetCount());
+}
+
+/*
+================================================================================
+
+EntityStore::SpawnMeteor
+
+    Adds a meteor centered at (x, y), spinning at the specified speed
+    (in degrees per second).
+
+================================================================================
+*/
+void EntityStore::SpawnMeteor(int x, int y, float rotSpeed)
+{
+    const GG::AnimationClip* clip = mClips->GetClip(CLIP_METEOR);
+
+    GG::Rect rect(x - clip->frameWidth / 2, y - clip->frameHeight / 2, clip->frameWidth, clip->frameHeight);
+
+    mMeteors.posY.push_back((float)rect.y);
+    mMeteors.rect.push_back(rect);
+    mMeteors.prevRect.push_back(rect);
+    mMeteors.anim.Add(CLIP_METEOR);
+    mMeteors.rotAngle.push_back(0.0);
+    mMeteors.rotSpeed.push_back(rotSpeed);
+    mMeteors.grayscale.push_back(mGrayscale);
+
+    NoteCount(KIND_METEOR, mMeteors.GetCount());
+}
+
+/*
+================================================================================
+
+EntityStore::SpawnExplosion
+
+    Adds an explosion centered at (x, y).  It lasts as long as its
+    animation.
+
+================================================================================
+*/
+void EntityStore::SpawnExplosion(int x, int y)
+{
+    const GG::AnimationClip* clip = mClips->GetClip(CLIP_EXPLOSION);
+
+    mExplosions.rect.push_back(GG::Rect(x - clip->frameWidth / 2, y - clip->frameHeight / 2, clip->frameWidth, clip->frameHeight));
+    mExplosions.anim.Add(CLIP_EXPLOSION);
+    mExplosions.timeToLive.push_back(clip->duration);
+    mExplosions.grayscale.push_back(mGrayscale);
+
+    NoteCount(KIND_EXPLOSION, mExplosions.GetCount());
+}
+
+/*
+================================================================================
+
+EntityStore::SpawnMushroom
+
+    Adds a mushroom with its top left corner at (x, y).
+
+================================================================================
+*/
+void EntityStore::SpawnMushroom(float x, float y, float w, float h)
+{
+    mMushrooms.rect.push_back(GG::Rect((int)x, (int)y, (int)w, (int)h));
+    mMushrooms.anim.Add(CLIP_MUSHROOM);
+    mMushrooms.grayscale.push_back(mGrayscale);
+
+    NoteCount(KIND_MUSHROOM, mMushrooms.GetCount());
+}
+
+/*
+================================================================================
+
+EntityStore::SetCrawlerAnimation
+
+    Starts one of the crawler animations from the beginning, and resizes
+    the crawler's rects to match.
+
+================================================================================
+*/
+void EntityStore::SetCrawlerAnimation(int i, GG::ClipId clip)
+{
+    GG::RenderableArray::Slot anim = mCrawlers.anim[i];
+    GG::Rect& rect = mCrawlers.rect[i];
+    GG::Rect& collisionRect = mCrawlers.collisionRect[i];
+
+    anim.Play(clip);
+
+    // make the size of the on-screen rectangle match the size of the animation
+    rect.w = anim.GetWidth();
+    rect.h = anim.GetHeight();
+
+    // set top-left corner of screen rect based on position coordinates
+    rect.x = (int)mCrawlers.posX[i];
+    rect.y = (int)(mCrawlers.posY[i] - rect.h);     // y-coord of position is at the bottom of screen rect
+
+    collisionRect.x = rect.x + rect.w / 5;
+    collisionRect.w = 2 * rect.w / 3;
+    collisionRect.y = rect.y + 3 * rect.h / 4;
+    collisionRect.h = rect.h / 4;
+}
+
+/*
+================================================================================
+
+EntityStore::SetCrawlerState
+
+    Switches a crawler to a new AI state, and decides how long it stays
+    in it.
+
+================================================================================
+*/
+void EntityStore::SetCrawlerState(int i, CrawlerState newState, float time)
+{
+    CrawlerAI& ai = mCrawlers.ai[i];
+
+    if (newState == ai.state) {
+        // we're already in this state already
+        return;
+    }
+
+    switch (newState) {
+    case CRAWLER_IDLE:
+    {
+        SetCrawlerAnimation(i, ai.jumpedOn ? CLIP_CRAWLER_IDLE : CLIP_CRAWLER_IDLE_PINK);
+
+        // idling crawlers go by the clip clock, a frame apart for every
+        // crawler's width between them, so a crowd ripples
+        const GG::Rect& rect = mCrawlers.rect[i];
+        mCrawlers.anim[i].Sync(rect.w > 0 ? rect.x / rect.w : 0);
+
+        int numCycles = mRandom->IntInclusive(2, 5);
+        ai.nextThinkTime = time + numCycles * mCrawlers.anim[i].GetDuration();
+        break;
+    }
+
+    case CRAWLER_WALK:
+    {
+        SetCrawlerAnimation(i, ai.jumpedOn ? CLIP_CRAWLER_WALK : CLIP_CRAWLER_WALK_PINK);
+
+        ai.speedScale = mRandom->Float(0.5f, 2.0f);
+
+        int numCycles = mRandom->IntInclusive(5, 10);
+        ai.nextThinkTime = time + numCycles * mCrawlers.anim[i].GetDuration();
+        break;
+    }
+
+    case CRAWLER_DYING:
+        SetCrawlerAnimation(i, CLIP_CRAWLER_DIE);
+        break;
+
+    case CRAWLER_DEAD:
+        break;
+
+    default:
+        // shouldn't happen
+        return;
+    }
+
+    ai.state = (Uint8)newState;
+}
+
+/*
+================================================================================
+
+EntityStore::RemoveDeadCrawlers
+
+    Gets rid of the crawlers whose dying animation is over.
+
+================================================================================
+*/
+void EntityStore::RemoveDeadCrawlers()
+{
+    int i = 0;
+    while (i < mCrawlers.GetCount()) {
+        if (mCrawlers.ai[i].state == CRAWLER_DEAD) {
+            mCrawlers.Remove(i);        // the last one moves in here, so don't advance
+        } else {
+            i++;
+        }
+    }
+}
+
+/*
+================================================================================
+
+EntityStore::SavePreviousRects
+
+    Remembers where the moving entities are, before a simulation step
+    moves them.
+
+================================================================================
+*/
+void EntityStore::SavePreviousRects()
+{
+    mCrawlers.prevRect = mCrawlers.rect;
+    mMeteors.prevRect = mMeteors.rect;
+}
+
+/*
+================================================================================
+
+EntityStore::UpdateCrawlers
+
+    Runs the AI of every crawler: they idle and walk around for random
+    amounts of time, and turn around at the edges of their platforms.
+    A strong crawler that got stomped for the first time loses its pink
+    and keeps walking, anything else that got stomped dies once its dying
+    animation is over.
+
+    The AI only sets how fast each animation plays this step; they all get
+    advanced together at the end (see GG::RenderableArray::Animate).  A
+    crawler that just switched animations starts the new one next step.
+
+================================================================================
+*/
+void EntityStore::UpdateCrawlers(float dt, float time, const Grid* grid)
+{
+    int tileWidth = grid->TileWidth();
+    int tileHeight = grid->TileHeight();
+
+    for (int i = 0; i < mCrawlers.GetCount(); i++) {
+        CrawlerAI& ai = mCrawlers.ai[i];
+        GG::Rect& rect = mCrawlers.rect[i];
+        GG::Rect& collisionRect = mCrawlers.collisionRect[i];
+        GG::Rect& tileRect = mCrawlers.tileRect[i];
+
+        // get the next tile that the crawler is going to walk on
+        int row = (collisionRect.y + collisionRect.h + 10) / tileHeight;
+        int column;
+        if (ai.direction == -1) {
+            column = (collisionRect.x + collisionRect.w / 8) / tileWidth;
+        } else {
+            column = (collisionRect.x + collisionRect.w / 2) / tileWidth;
+        }
+        const GG::Renderable* tileRenderable = grid->GetTile(row, column)->GetRenderable();
+        tileRect = GG::Rect(column * tileWidth, row * tileHeight, tileWidth, tileHeight);
+
+        float animRate = 0.0f;
+
+        switch (ai.state) {
+        case CRAWLER_WALK:
+            if (time >= ai.nextThinkTime) {
+                SetCrawlerState(i, CRAWLER_IDLE, time);
+            } else {
+                // advance animation (as fast as the crawler walks)
+                animRate = ai.speedScale;
+
+                // deal with edges of the crawler's platform
+                float step = dt * CRAWLER_SPEED * ai.speedScale * ai.direction;
+                if (!tileRenderable) {
+                    // revert to previous position
+                    mCrawlers.posX[i] -= step;
+                    ai.direction = -ai.direction;
+                } else {
+                    // move position
+                    mCrawlers.posX[i] += step;
+                }
+
+                // update the on-screen rect position (x is the only coordinate that changes)
+                rect.x = (int)mCrawlers.posX[i];
+                collisionRect.x = rect.x + rect.w / 5;
+            }
+            break;
+
+        case CRAWLER_IDLE:
+            if (time >= ai.nextThinkTime) {
+                SetCrawlerState(i, CRAWLER_WALK, time);
+            } else {
+                // just advance the animation (at regular speed)
+                animRate = 1.0f;
+            }
+            break;
+
+        case CRAWLER_DYING:
+            if (!ai.jumpedOn) {
+                // first stomp on a strong crawler, it only loses its color
+                ai.jumpedOn = 1;
+                SetCrawlerState(i, CRAWLER_WALK, time);
+            } else {
+                animRate = 1.0f;
+                ai.timeToDeath -= dt;
+                if (ai.timeToDeath <= 0) {
+                    SetCrawlerState(i, CRAWLER_DEAD, time);
+                }
+            }
+            break;
+
+        default:
+            // shouldn't happen
+            break;
+        }
+
+        mCrawlers.anim[i].SetRate(animRate);
+    }
+
+    mCrawlers.anim.Animate(dt);
+}
+
+/*
+================================================================================
+
+EntityStore::UpdateMeteors
+
+    Meteors fall and spin.  Hitting the ground or the robot is up to World.
+
+================================================================================
+*/
+void EntityStore::UpdateMeteors(float dt)
+{
+    for (int i = 0; i < mMeteors.GetCount(); i++) {
+        mMeteors.posY[i] += dt * METEOR_SPEED;
+        mMeteors.rect[i].y = (int)floor(mMeteors.posY[i]);
+        mMeteors.rotAngle[i] += dt * mMeteors.rotSpeed[i];
+    }
+}
+
+/*
+================================================================================
+
+EntityStore::UpdateExplosions
+
+    Animates the explosions, and removes the ones that are over.
+
+================================================================================
+*/
+void EntityStore::UpdateExplosions(float dt)
+{
+    int i = 0;
+    while (i < mExplosions.GetCount()) {
+        if (mExplosions.timeToLive[i] <= 0) {
+            mExplosions.Remove(i);      // the last one moves in here, so don't advance
+        } else {
+            mExplosions.timeToLive[i] -= dt;
+            i++;
+        }
+    }
+
+    mExplosions.anim.Animate(dt);
+}
+
+/*
+================================================================================
+
+EntityStore::SetGrayscale
+
+    Switches every entity (and the ones spawned from now on) to color or
+    grayscale.
+
+================================================================================
+*/
+void EntityStore::SetGrayscale(bool grayscale)
+{
+    mGrayscale = grayscale;
+
+    Uint8 value = grayscale ? 1 : 0;
+    mCrawlers.grayscale.assign(mCrawlers.grayscale.size(), value);
+    mCoins.grayscale.assign(mCoins.grayscale.size(), value);
+    mMeteors.grayscale.assign(mMeteors.grayscale.size(), value);
+    mExplosions.grayscale.assign(mExplosions.grayscale.size(), value);
+    mMushrooms.grayscale.assign(mMushrooms.grayscale.size(), value);
+}
+
+/*
+================================================================================
+
+EntityStore::InsertColliders
+
+    Inserts everything that can be run into (crawlers by their collision
+    rects, coins, meteors and mushrooms by their screen rects) into the
+    hash, with ids made by MakeId.  Explosions don't collide with anything.
+
+================================================================================
+*/
+void EntityStore::InsertColliders(GG::SpatialHash* hash) const
+{
+    for (int i = 0; i < mCrawlers.GetCount(); i++) {
+        hash->Insert(mCrawlers.collisionRect[i], MakeId(KIND_CRAWLER, i));
+    }
+    for (int i = 0; i < mCoins.GetCount(); i++) {
+        hash->Insert(mCoins.rect[i], MakeId(KIND_COIN, i));
+    }
+    for (int i = 0; i < mMeteors.GetCount(); i++) {
+        hash->Insert(mMeteors.rect[i], MakeId(KIND_METEOR, i));
+    }
+    for (int i = 0; i < mMushrooms.GetCount(); i++) {
+        hash->Insert(mMushrooms.rect[i], MakeId(KIND_MUSHROOM, i));
+    }
+}
+
+/*
+================================================================================
+
+EntityStore::Clear
+
+    Removes every entity.  The memory stays reserved for the next scene.
+
+================================================================================
+*/
+void EntityStore::Clear()
+{
+    mCrawlers.Clear();
+    mCoins.Clear();
+    mMeteors.Clear();
+    mExplosions.Clear();
+    mMushrooms.Clear();
+}
+
+/*
+================================================================================
+
+EntityStore::ReportUsage
+
+    Prints the most entities of each kind there ever were at once, which
+    is what the capacity passed to Initialize should be tuned by.
+
+================================================================================
+*/
+void EntityStore::ReportUsage() const
+{
+    std::cout << "*** Entity high-water marks: "
+              << mHighWater[KIND_CRAWLER] << " crawlers, "
+              << mHighWater[KIND_COIN] << " coins, "
+              << mHighWater[KIND_METEOR] << " meteors, "
+              << mHighWater[KIND_EXPLOSION] << " explosions, "
+              << mHighWater[KIND_MUSHROOM] << " mushrooms" << std::endl;
+}
@@ -0,0 +1,233 @@
+#ifndef ENTITY_STORE_H_
+#define ENTITY_STORE_H_
+
+#include "GG_Graphics.h"
+#include "GG_Renderable.h"
+#include "GG_Common.h"
+#include "GG_SpatialHash.h"
+#include "Grid.h"
+
+#include <vector>
+
+enum CrawlerState { CRAWLER_INIT, CRAWLER_IDLE, CRAWLER_WALK, CRAWLER_DYING, CRAWLER_DEAD };   // possible AI states
+
+/*
+================================================================================
+
+CrawlerAI struct
+
+    The AI state of one crawler.  These are all read and written together
+    when the crawler thinks, so they're kept together.
+
+    Weak crawlers start out jumped on, so one stomp kills them.  Strong
+    crawlers are pink until the first stomp, and the second one kills them.
+
+================================================================================
+*/
+struct CrawlerAI {
+    float                   speedScale;     // speed multiplier (1 is default, <1 is slower, >1 is faster)
+    float                   nextThinkTime;  // time to run next round of AI "thinking"
+    float                   timeToDeath;    // remaining time left for death animation (in seconds)
+    Sint8                   direction;      // -1 for left and 1 for right
+    Uint8                   state;          // a CrawlerState
+    Uint8                   jumpedOn;       // has it been stomped already?
+};
+
+/*
+================================================================================
+
+Entity tables
+
+    One table per kind of entity, with one array per component.  The i-th
+    element of every array in a table belongs to the i-th entity, and the
+    arrays never have holes: Remove moves the last entity into the removed
+    one's place.  So indices are only good until the next removal, which
+    is fine, because nothing holds on to an entity between frames.
+
+    The components:
+    - rect: where it is on the screen (the transform)
+    - prevRect: where it was one simulation step ago (only for the ones
+      that move), so that drawing can interpolate between the two
+    - collisionRect: the part that counts for collisions (crawlers only,
+      the others use their screen rect)
+    - anim: animation state (which clip it's playing, and where in it)
+    - grayscale: draw the grayscale textures?
+    plus whatever state that kind of entity needs (like the crawler AI).
+
+================================================================================
+*/
+struct CrawlerTable {
+    std::vector<float>          posX;           // left
+    std::vector<float>          posY;           // bottom
+    std::vector<GG::Rect>       rect;
+    std::vector<GG::Rect>       prevRect;       // rect as of the previous simulation step
+    std::vector<GG::Rect>       collisionRect;
+    std::vector<GG::Rect>       tileRect;       // the tile it's about to walk on
+    GG::RenderableArray         anim;
+    std::vector<CrawlerAI>      ai;
+    std::vector<Uint8>          grayscale;
+
+    int                         GetCount() const    { return (int)rect.size(); }
+    void                        Reserve(int n);
+    void                        Remove(int i);
+    void                        Clear();
+};
+
+struct CoinTable {
+    std::vector<GG::Rect>       rect;
+    GG::RenderableArray         anim;
+    std::vector<int>            soundDelay;     // steps since it got picked up (0 if it hasn't)
+    std::vector<Uint8>          grayscale;
+
+    int                         GetCount() const    { return (int)rect.size(); }
+    void                        Reserve(int n);
+    void                        Remove(int i);
+    void                        Clear();
+};
+
+struct MeteorTable {
+    std::vector<float>          posY;           // top
+    std::vector<GG::Rect>       rect;
+    std::vector<GG::Rect>       prevRect;       // rect as of the previous simulation step
+    GG::RenderableArray         anim;
+    std::vector<double>         rotAngle;       // in degrees
+    std::vector<float>          rotSpeed;       // degrees per second
+    std::vector<Uint8>          grayscale;
+
+    int                         GetCount() const    { return (int)rect.size(); }
+    void                        Reserve(int n);
+    void                        Remove(int i);
+    void                        Clear();
+};
+
+struct ExplosionTable {
+    std::vector<GG::Rect>       rect;
+    GG::RenderableArray         anim;
+    std::vector<float>          timeToLive;     // in seconds
+    std::vector<Uint8>          grayscale;
+
+    int                         GetCount() const    { return (int)rect.size(); }
+    void                        Reserve(int n);
+    void                        Remove(int i);
+    void                        Clear();
+};
+
+struct MushroomTable {
+    std::vector<GG::Rect>       rect;
+    GG::RenderableArray         anim;
+    std::vector<Uint8>          grayscale;
+
+    int                         GetCount() const    { return (int)rect.size(); }
+    void                        Reserve(int n);
+    void                        Remove(int i);
+    void                        Clear();
+};
+
+/*
+================================================================================
+
+EntityStore class
+
+    Holds all the crawlers, coins, meteors, explosions and mushrooms in the
+    scene, in the tables above.  Updating or drawing all entities of a kind
+    is a walk down a few arrays, with no pointer chasing and no virtual
+    calls, which keeps things fast even with tens of thousands of them.
+
+    The store also does the updates that only concern the entities
+    themselves (crawler AI, meteors falling, explosions burning out).
+    Anything involving the robot, the score or sounds is up to World, which
+    loops over the tables directly.
+
+    For collision queries, InsertColliders puts the entities that can be
+    touched into a spatial hash, tagged with ids that tell which table and
+    index they came from (see MakeId).  Like indices, ids are only good
+    until the next removal.
+
+    New entities start playing one of the built-in clips (see BuiltinClip),
+    so spawning one is just a clip id and a few push_backs.  Coins and idle
+    crawlers follow the world's clip clock (see GG::ClipClock) instead of
+    timing their animations themselves, so all the coins spin together and
+    animating them costs the same however many there are.  The arrays are
+    reserved up front and only ever grow, so once a scene has hit its peak,
+    spawning doesn't allocate.
+
+================================================================================
+*/
+class EntityStore {
+
+public:
+    enum Kind {
+        KIND_CRAWLER,
+        KIND_COIN,
+        KIND_METEOR,
+        KIND_EXPLOSION,
+        KIND_MUSHROOM,
+        NUM_KINDS
+    };
+
+private:
+    const GG::ClipLibrary*  mClips;
+
+    GG::Random*             mRandom;        // the world's, for the crawler AI
+
+    CrawlerTable            mCrawlers;
+    CoinTable               mCoins;
+    MeteorTable             mMeteors;
+    ExplosionTable          mExplosions;
+    MushroomTable           mMushrooms;
+
+    bool                    mGrayscale;     // for new entities
+
+    int                     mHighWater[NUM_KINDS];  // most entities of each kind at once
+
+    void                    SetCrawlerAnimation(int i, GG::ClipId clip);
+    void                    NoteCount(Kind kind, int count);
+
+public:
+                            EntityStore();
+
+    void                    Initialize(const GG::ClipLibrary* clips, const GG::ClipClock* clock, int capacity, GG::Random* random);
+
+    CrawlerTable&           GetCrawlers()       { return mCrawlers; }
+    CoinTable&              GetCoins()          { return mCoins; }
+    MeteorTable&            GetMeteors()        { return mMeteors; }
+    ExplosionTable&         GetExplosions()     { return mExplosions; }
+    MushroomTable&          GetMushrooms()      { return mMushrooms; }
+
+    const CrawlerTable&     GetCrawlers() const     { return mCrawlers; }
+    const CoinTable&        GetCoins() const        { return mCoins; }
+    const MeteorTable&      GetMeteors() const      { return mMeteors; }
+    const ExplosionTable&   GetExplosions() const   { return mExplosions; }
+    const MushroomTable&    GetMushrooms() const    { return mMushrooms; }
+
+    int                     GetCount() const;
+
+    void                    SpawnCrawler(float x, float y, bool strong, int direction, float time);
+    void                    SpawnCoin(float x, float y);
+    void                    SpawnMeteor(int x, int y, float rotSpeed);
+    void                    SpawnExplosion(int x, int y);
+    void                    SpawnMushroom(float x, float y, float w, float h);
+
+    void                    SetCrawlerState(int i, CrawlerState newState, float time);
+    void                    RemoveDeadCrawlers();
+
+    void                    SavePreviousRects();
+
+    void                    UpdateCrawlers(float dt, float time, const Grid* grid);
+    void                    UpdateMeteors(float dt);
+    void                    UpdateExplosions(float dt);
+
+    void                    SetGrayscale(bool grayscale);
+
+    void                    InsertColliders(GG::SpatialHash* hash) const;
+
+    static Uint32           MakeId(Kind kind, int index)    { return (Uint32)kind << 24 | (Uint32)index; }
+    static Kind             GetIdKind(Uint32 id)            { return (Kind)(id >> 24); }
+    static int              GetIdIndex(Uint32 id)           { return (int)(id & 0xffffff); }
+
+    void                    Clear();
+
+    void                    ReportUsage() const;
+};
+
+#endif
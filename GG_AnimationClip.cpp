@@ -0,0 +1,175 @@
+#include "GG_AnimationClip.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace GG {
+
+/*
+================================================================================
+
+ClipLibrary constructor
+
+    Creates an empty library.
+
+================================================================================
+*/
+ClipLibrary::ClipLibrary()
+{
+}
+
+/*
+================================================================================
+
+ClipLibrary::AddClip
+
+    Registers a clip that plays all the cells of tex in duration seconds,
+    or a still if the duration is 0.  Returns its id, or INVALID_CLIP_ID
+    if there already is a clip with that name.
+
+    The textures have to be loaded (or at least have their sizes) by now.
+
+================================================================================
+*/
+ClipId ClipLibrary::AddClip(const std::string& name, const Texture* tex, const Texture* grayscaleTex,
+                            float duration, bool loopable)
+{
+    if (mIds.find(name) != mIds.end()) {
+        std::cerr << "*** There already is an animation clip called '" << name << "'" << std::endl;
+        return INVALID_CLIP_ID;
+    }
+
+    AnimationClip clip;
+    clip.name = name;
+    clip.id = (ClipId)mClips.size();
+    clip.tex = tex;
+    clip.grayscaleTex = grayscaleTex;
+    clip.numFrames = tex ? tex->GetNumCells() : 1;
+    clip.frameWidth = tex ? tex->GetCellWidth() : 0;
+    clip.frameHeight = tex ? tex->GetCellHeight() : 0;
+    clip.duration = duration;
+    clip.loopable = loopable;
+    clip.rotOrigin.x = clip.frameWidth / 2;
+    clip.rotOrigin.y = clip.frameHeight / 2;
+
+    mClips.push_back(clip);
+    mIds[name] = clip.id;
+
+    mDurations.push_back(clip.duration);
+    mNumFrames.push_back(clip.numFrames);
+    mLoopable.push_back(clip.loopable ? 1 : 0);
+    mAnimated.push_back(clip.IsAnimated() ? 1 : 0);
+
+    return clip.id;
+}
+
+/*
+================================================================================
+
+ClipLibrary::FindClip
+
+    Returns the id of the clip with the specified name, or INVALID_CLIP_ID
+    if there's none.
+
+================================================================================
+*/
+ClipId ClipLibrary::FindClip(const std::string& name) const
+{
+    std::map<std::string, ClipId>::const_iterator it = mIds.find(name);
+    return it != mIds.end() ? it->second : INVALID_CLIP_ID;
+}
+
+/*
+================================================================================
+
+ClipClock constructor
+
+    Creates a clock with no clips.  Set the library before using it.
+
+================================================================================
+*/
+ClipClock::ClipClock()
+    : mClips(NULL)
+{
+}
+
+/*
+================================================================================
+
+ClipClock::SetClipLibrary
+
+    Starts all the clips in clips from the beginning.  The library has to
+    have all its clips by now.
+
+================================================================================
+*/
+void ClipClock::SetClipLibrary(const ClipLibrary* clips)
+{
+    mClips = clips;
+    mTimes.assign(clips->GetNumClips(), 0.0f);
+    mFrames.assign(clips->GetNumClips(), 0);
+}
+
+/*
+================================================================================
+
+ClipClock::Advance
+
+    Moves every looping clip dt seconds along, the same way
+    Renderable::Animate would.
+
+================================================================================
+*/
+void ClipClock::Advance(float dt)
+{
+    for (int i = 0; i < (int)mTimes.size(); i++) {
+        const AnimationClip* clip = mClips->GetClip(i);
+        if (!clip->IsAnimated() || !clip->loopable) {
+            continue;
+        }
+
+        float time = mTimes[i] + dt;
+        if (time >= clip->duration) {
+            time = std::fmod(time, clip->duration);
+        }
+
+        mTimes[i] = time;
+        mFrames[i] = (int)(clip->numFrames * (time / clip->duration));
+    }
+}
+
+/*
+================================================================================
+
+ClipClock::GetFrame
+
+    Returns the frame of clip that a subscriber phase frames ahead of the
+    clock is on.
+
+================================================================================
+*/
+int ClipClock::GetFrame(ClipId clip, int phase) const
+{
+    return (mFrames[clip] + phase) % mClips->GetClip(clip)->numFrames;
+}
+
+/*
+================================================================================
+
+ClipClock::GetTime
+
+    Returns how far into clip a subscriber phase frames ahead of the clock
+    is, in seconds.
+
+================================================================================
+*/
+float ClipClock::GetTime(ClipId clip, int phase) const
+{
+    const AnimationClip* c = mClips->GetClip(clip);
+    if (phase == 0 || !c->IsAnimated()) {
+        return mTimes[clip];
+    }
+    return std::fmod(mTimes[clip] + phase * c->duration / c->numFrames, c->duration);
+}
+
+} // end of namespace
@@ -0,0 +1,144 @@
+#ifndef GG_ANIMATION_CLIP_H_
+#define GG_ANIMATION_CLIP_H_
+
+#include "GG_Graphics.h"
+#include "GG_Common.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace GG {
+
+typedef int ClipId;
+
+enum {
+    INVALID_CLIP_ID = -1
+};
+
+/*
+================================================================================
+
+AnimationClip struct
+
+    Everything about an animation that's the same for every sprite playing
+    it: the sprite sheet (and its grayscale version), how many frames it
+    has and how big they are, how long it lasts and whether it loops.
+    Stills are clips too, with a duration of 0; their frames are the cells
+    of the sheet, and whoever shows one picks the cell (like the tiles).
+
+    Clips are registered once, in a ClipLibrary, and never change after
+    that.  Renderables and RenderableArray slots only say which clip they
+    show and where in it they are, so a thousand coins carry one copy of
+    the coin's textures, sizes and timing instead of a thousand.
+
+================================================================================
+*/
+struct AnimationClip {
+    std::string             name;
+    ClipId                  id;
+
+    const Texture*          tex;            // sprite sheet (the TextureManager owns it)
+    const Texture*          grayscaleTex;   // grayscale version
+
+    int                     numFrames;      // cells in the sprite sheet
+    int                     frameWidth;
+    int                     frameHeight;
+
+    float                   duration;       // in seconds, 0 for stills
+    bool                    loopable;       // restart when finished?
+
+    Point                   rotOrigin;      // the middle of a frame
+
+    bool                    IsAnimated() const      { return numFrames > 1 && duration > 0.0f; }
+};
+
+/*
+================================================================================
+
+ClipLibrary class
+
+    The clips, by id and by name.  Clips don't move once they're added, so
+    pointers to them stay good for as long as the library is around.
+
+    The library also keeps the fields that RenderableArray::Animate needs
+    in arrays of their own, indexed by clip id, for it to look up a whole
+    vector's worth of slots at once.
+
+    Registering clips isn't thread safe, but once that's done, any number
+    of threads can read the library at the same time.
+
+================================================================================
+*/
+class ClipLibrary {
+
+    std::deque<AnimationClip>   mClips;
+    std::map<std::string, ClipId> mIds;
+
+    std::vector<float>      mDurations;     // the fields of each clip the animation pass uses
+    std::vector<int>        mNumFrames;
+    std::vector<int>        mLoopable;      // 0 or 1
+    std::vector<int>        mAnimated;      // 0 or 1
+
+                            ClipLibrary(const ClipLibrary&);
+    ClipLibrary&            operator= (const ClipLibrary&);
+
+public:
+                            ClipLibrary();
+
+    ClipId                  AddClip(const std::string& name, const Texture* tex, const Texture* grayscaleTex,
+                                    float duration, bool loopable);
+
+    ClipId                  FindClip(const std::string& name) const;
+    const AnimationClip*    GetClip(ClipId id) const    { return &mClips[id]; }
+
+    int                     GetNumClips() const         { return (int)mClips.size(); }
+
+    const float*            GetDurations() const        { return &mDurations[0]; }
+    const int*              GetNumFrames() const        { return &mNumFrames[0]; }
+    const int*              GetLoopable() const         { return &mLoopable[0]; }
+    const int*              GetAnimated() const         { return &mAnimated[0]; }
+};
+
+/*
+================================================================================
+
+ClipClock class
+
+    One clock per looping clip, for sprites that all play a clip in step
+    with each other, like the coins.  Advance moves every clip's clock
+    along once, and the sprites that subscribe to it (see
+    RenderableArray::Sync) just read the frame it's on, so it doesn't
+    matter how many of them there are: the frame gets worked out once per
+    clip, not once per sprite.
+
+    A subscriber can be a number of frames ahead of the clock (its phase),
+    so that sprites standing next to each other don't have to move in
+    lockstep.  Clips that don't loop stay on their first frame; those are
+    played by each sprite on its own.
+
+================================================================================
+*/
+class ClipClock {
+
+    const ClipLibrary*      mClips;         // we don't own this
+    std::vector<float>      mTimes;         // by clip id
+    std::vector<int>        mFrames;
+
+public:
+                            ClipClock();
+
+    void                    SetClipLibrary(const ClipLibrary* clips);
+
+    void                    Advance(float dt);
+
+    float                   GetTime(ClipId clip) const      { return mTimes[clip]; }
+    int                     GetFrame(ClipId clip) const     { return mFrames[clip]; }
+    int                     GetFrame(ClipId clip, int phase) const;
+    float                   GetTime(ClipId clip, int phase) const;
+};
+
+} // end of namespace
+
+#endif
@@ -0,0 +1,291 @@
+#include "GG_AssetPack.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace GG {
+
+static const Uint32 PACK_PIXEL_FORMAT = SDL_PIXELFORMAT_ARGB8888;
+
+static size_t AlignUp(size_t n)
+{
+    return (n + PACK_ALIGNMENT - 1) & ~(size_t)(PACK_ALIGNMENT - 1);
+}
+
+static bool CopyName(char* dst, const std::string& src)
+{
+    if (src.length() >= PACK_NAME_LENGTH) {
+        std::cerr << "*** Asset pack name '" << src << "' is too long" << std::endl;
+        return false;
+    }
+    std::memset(dst, 0, PACK_NAME_LENGTH);
+    std::memcpy(dst, src.c_str(), src.length());
+    return true;
+}
+
+/*
+================================================================================
+
+AssetPack constructor
+
+    Creates an AssetPack with nothing open.
+
+================================================================================
+*/
+AssetPack::AssetPack()
+    : mHeader(NULL)
+    , mEntries(NULL)
+{
+}
+
+/*
+================================================================================
+
+AssetPack::Open
+
+    Maps the pack and validates it.  Fails without complaining if the file
+    isn't there, since running without a pack is perfectly normal, but
+    complains about files that are there and aren't valid packs.
+
+================================================================================
+*/
+bool AssetPack::Open(const std::string& path)
+{
+    Close();
+
+    if (!mFile.Open(path)) {
+        return false;
+    }
+
+    const Uint8* data = mFile.GetData();
+    size_t size = mFile.GetSize();
+
+    const PackHeader* header = (const PackHeader*)data;
+    if (size < sizeof(PackHeader) || header->magic != PACK_MAGIC) {
+        std::cerr << "*** '" << path << "' is not an asset pack" << std::endl;
+        mFile.Close();
+        return false;
+    }
+    if (header->version != PACK_VERSION || header->pixelFormat != PACK_PIXEL_FORMAT) {
+        std::cerr << "*** Asset pack '" << path << "' is out of date, rebuild it with --build-pack" << std::endl;
+        mFile.Close();
+        return false;
+    }
+
+    size_t tableEnd = sizeof(PackHeader) + (size_t)header->numEntries * sizeof(PackEntry);
+    if (header->numEntries > size / sizeof(PackEntry) || tableEnd > size) {
+        std::cerr << "*** Asset pack '" << path << "' is truncated" << std::endl;
+        mFile.Close();
+        return false;
+    }
+
+    const PackEntry* entries = (const PackEntry*)(data + sizeof(PackHeader));
+    for (Uint32 i = 0; i < header->numEntries; i++) {
+        const PackEntry& e = entries[i];
+
+        bool ok = e.offset >= tableEnd && e.offset <= size && e.size <= size - e.offset
+               && e.file[PACK_NAME_LENGTH - 1] == '\0'
+               && e.name[PACK_NAME_LENGTH - 1] == '\0'
+               && e.grayName[PACK_NAME_LENGTH - 1] == '\0';
+
+        if (ok && e.type == PACK_IMAGE) {
+            ok = e.offset % 4 == 0
+              && e.numCells > 0
+              && e.width <= e.pitch / 4
+              && (Uint64)e.pitch * e.height <= e.size;
+        }
+
+        if (!ok) {
+            std::cerr << "*** Asset pack '" << path << "' has a bad entry (" << i << ")" << std::endl;
+            mFile.Close();
+            return false;
+        }
+    }
+
+    mHeader = header;
+    mEntries = entries;
+
+    return true;
+}
+
+/*
+================================================================================
+
+AssetPack::Close
+
+    Unmaps the pack.  Pointers into it are invalid afterwards.
+
+================================================================================
+*/
+void AssetPack::Close()
+{
+    mFile.Close();
+    mHeader = NULL;
+    mEntries = NULL;
+}
+
+/*
+================================================================================
+
+AssetPack::Find
+
+    Looks up an entry by its source file name.  Returns NULL if the pack
+    doesn't have it.
+
+================================================================================
+*/
+const PackEntry* AssetPack::Find(const std::string& file) const
+{
+    for (int i = 0; i < GetNumEntries(); i++) {
+        if (file == mEntries[i].file) {
+            return &mEntries[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+================================================================================
+
+AssetPackWriter::AddEntry
+
+    Fills in the file name and data location of an entry, appends the data
+    and the entry.
+
+================================================================================
+*/
+bool AssetPackWriter::AddEntry(PackEntry& entry, const std::string& file, const void* data, size_t size)
+{
+    if (!CopyName(entry.file, file)) {
+        return false;
+    }
+
+    // offsets are relative to the end of the table for now, Write fixes them up
+    size_t offset = AlignUp(mData.size());
+    mData.resize(offset + size);
+    if (size > 0) {
+        std::memcpy(&mData[offset], data, size);
+    }
+
+    entry.offset = (Uint32)offset;
+    entry.size = (Uint32)size;
+
+    mEntries.push_back(entry);
+    return true;
+}
+
+/*
+================================================================================
+
+AssetPackWriter::AddImage
+
+    Adds an image, converted to the pack's pixel format and with its rows
+    packed tightly.
+
+================================================================================
+*/
+bool AssetPackWriter::AddImage(const std::string& file, const std::string& name, const std::string& grayName,
+                               int numCells, SDL_Surface* surf)
+{
+    PackEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+
+    if (!CopyName(entry.name, name) || !CopyName(entry.grayName, grayName)) {
+        return false;
+    }
+
+    SDL_Surface* conv = SDL_ConvertSurfaceFormat(surf, PACK_PIXEL_FORMAT, 0);
+    if (!conv) {
+        std::cerr << "*** Failed to convert '" << file << "': " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    entry.type = PACK_IMAGE;
+    entry.width = conv->w;
+    entry.height = conv->h;
+    entry.pitch = conv->w * 4;
+    entry.numCells = numCells;
+
+    std::vector<Uint8> pixels(entry.pitch * entry.height);
+    for (int y = 0; y < conv->h; y++) {
+        std::memcpy(&pixels[y * entry.pitch], (const Uint8*)conv->pixels + y * conv->pitch, entry.pitch);
+    }
+    SDL_FreeSurface(conv);
+
+    return AddEntry(entry, file, pixels.empty() ? NULL : &pixels[0], pixels.size());
+}
+
+/*
+================================================================================
+
+AssetPackWriter::AddText
+
+    Adds a text file, as is.
+
+================================================================================
+*/
+bool AssetPackWriter::AddText(const std::string& file, const void* data, size_t size)
+{
+    PackEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.type = PACK_TEXT;
+
+    return AddEntry(entry, file, data, size);
+}
+
+/*
+================================================================================
+
+AssetPackWriter::Write
+
+    Writes the pack to the specified path.
+
+================================================================================
+*/
+bool AssetPackWriter::Write(const std::string& path) const
+{
+    PackHeader header;
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.pixelFormat = PACK_PIXEL_FORMAT;
+    header.numEntries = (Uint32)mEntries.size();
+
+    size_t dataStart = AlignUp(sizeof(PackHeader) + mEntries.size() * sizeof(PackEntry));
+
+    std::vector<PackEntry> entries(mEntries);
+    for (unsigned i = 0; i < entries.size(); i++) {
+        entries[i].offset += (Uint32)dataStart;
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "*** Failed to open '" << path << "' for writing" << std::endl;
+        return false;
+    }
+
+    static const Uint8 zeros[PACK_ALIGNMENT] = { 0 };
+    size_t tableEnd = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+    if (ok && !entries.empty()) {
+        ok = std::fwrite(&entries[0], sizeof(PackEntry), entries.size(), f) == entries.size();
+    }
+    if (ok && dataStart > tableEnd) {
+        ok = std::fwrite(zeros, 1, dataStart - tableEnd, f) == dataStart - tableEnd;
+    }
+    if (ok && !mData.empty()) {
+        ok = std::fwrite(&mData[0], 1, mData.size(), f) == mData.size();
+    }
+
+    if (std::fclose(f) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        std::cerr << "*** Failed to write '" << path << "'" << std::endl;
+    }
+    return ok;
+}
+
+} // end namespace
@@ -0,0 +1,138 @@
+#ifndef GG_ASSET_PACK_H_
+#define GG_ASSET_PACK_H_
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+#include "GG_MappedFile.h"
+
+namespace GG {
+
+/*
+================================================================================
+
+Asset pack format
+
+    An asset pack puts a game's images and text files into a single file,
+    with the images already decoded, so that loading them is just a matter
+    of mapping the file and handing the pixels to the renderer.
+
+    The layout is:
+
+        PackHeader
+        PackEntry[numEntries]
+        data, each entry's chunk starting on a PACK_ALIGNMENT boundary
+
+    Images are stored as rows of 32-bit pixels in the header's pixel format
+    (ARGB8888, which is what the renderers create textures in and what
+    atlas pages are composed in), along with the texture names and cell
+    count to load them under.  Text files are stored as they are.
+
+    Everything is little-endian, and entry offsets are from the start of
+    the file.  Bump PACK_VERSION whenever the layout changes, so that stale
+    packs get rejected instead of misread.
+
+================================================================================
+*/
+enum {
+    PACK_MAGIC = 0x4B504747,    // "GGPK"
+    PACK_VERSION = 1,
+    PACK_ALIGNMENT = 16,
+    PACK_NAME_LENGTH = 32
+};
+
+enum PackEntryType {
+    PACK_IMAGE = 1,
+    PACK_TEXT = 2
+};
+
+struct PackHeader {
+    Uint32                  magic;
+    Uint32                  version;
+    Uint32                  pixelFormat;
+    Uint32                  numEntries;
+};
+
+struct PackEntry {
+    char                    file[PACK_NAME_LENGTH];     // source file, relative to the media directory
+    char                    name[PACK_NAME_LENGTH];     // texture name (images only)
+    char                    grayName[PACK_NAME_LENGTH]; // grayscale texture name, empty if none
+    Uint32                  type;                       // a PackEntryType
+    Uint32                  width;                      // images only
+    Uint32                  height;
+    Uint32                  pitch;
+    Uint32                  numCells;
+    Uint32                  offset;
+    Uint32                  size;
+    Uint32                  reserved;
+};
+
+/*
+================================================================================
+
+AssetPack class
+
+    Reads an asset pack.  Open maps the file and checks that the header and
+    the entry table make sense, so that the rest of the program can trust
+    them.  The entries point straight into the mapped file, which stays
+    mapped as long as the AssetPack is open.
+
+================================================================================
+*/
+class AssetPack {
+
+    MappedFile              mFile;
+
+    const PackHeader*       mHeader;
+    const PackEntry*        mEntries;
+
+public:
+                            AssetPack();
+
+    bool                    Open(const std::string& path);
+    void                    Close();
+
+    bool                    IsOpen() const              { return mHeader != NULL; }
+
+    Uint32                  GetPixelFormat() const      { return mHeader->pixelFormat; }
+
+    int                     GetNumEntries() const       { return mHeader ? (int)mHeader->numEntries : 0; }
+    const PackEntry&        GetEntry(int i) const       { return mEntries[i]; }
+
+    const PackEntry*        Find(const std::string& file) const;
+
+    const Uint8*            GetData(const PackEntry& entry) const   { return mFile.GetData() + entry.offset; }
+};
+
+/*
+================================================================================
+
+AssetPackWriter class
+
+    Builds an asset pack in memory and writes it out.  This is for offline
+    tools; the game itself only ever reads packs.
+
+    AddImage takes any surface and converts it to the pack's pixel format.
+    Names longer than PACK_NAME_LENGTH - 1 characters are rejected.
+
+================================================================================
+*/
+class AssetPackWriter {
+
+    std::vector<PackEntry>  mEntries;
+    std::vector<Uint8>      mData;          // everything after the entry table
+
+    bool                    AddEntry(PackEntry& entry, const std::string& file, const void* data, size_t size);
+
+public:
+    bool                    AddImage(const std::string& file, const std::string& name, const std::string& grayName,
+                                     int numCells, SDL_Surface* surf);
+    bool                    AddText(const std::string& file, const void* data, size_t size);
+
+    bool                    Write(const std::string& path) const;
+};
+
+} // end namespace
+
+#endif
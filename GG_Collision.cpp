@@ -0,0 +1,296 @@
+#include "GG_Collision.h"
+#include "GG_Cpu.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef GG_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+namespace GG {
+
+/*
+================================================================================
+
+RectArray methods
+
+================================================================================
+*/
+void RectArray::Clear()
+{
+    mMinX.clear();
+    mMinY.clear();
+    mMaxX.clear();
+    mMaxY.clear();
+}
+
+void RectArray::Reserve(int n)
+{
+    mMinX.reserve(n);
+    mMinY.reserve(n);
+    mMaxX.reserve(n);
+    mMaxY.reserve(n);
+}
+
+void RectArray::Resize(int n)
+{
+    mMinX.resize(n);
+    mMinY.resize(n);
+    mMaxX.resize(n);
+    mMaxY.resize(n);
+}
+
+void RectArray::Add(const Rect& rect)
+{
+    mMinX.push_back(rect.x);
+    mMinY.push_back(rect.y);
+    mMaxX.push_back(rect.x + rect.w);
+    mMaxY.push_back(rect.y + rect.h);
+}
+
+void RectArray::Set(int i, const Rect& rect)
+{
+    mMinX[i] = rect.x;
+    mMinY[i] = rect.y;
+    mMaxX[i] = rect.x + rect.w;
+    mMaxY[i] = rect.y + rect.h;
+}
+
+//
+// The row functions test the rect (x0, y0)-(x1, y1) against count rects
+// and OR a bit for each hit into mask, which the caller has cleared.  The
+// array pointers already point at the first rect to test.
+//
+
+typedef void (*RowFunc)(int x0, int y0, int x1, int y1,
+                        const int* minX, const int* minY, const int* maxX, const int* maxY,
+                        int count, Uint32* mask);
+
+static void OverlapRowScalarFrom(int x0, int y0, int x1, int y1,
+                                 const int* minX, const int* minY, const int* maxX, const int* maxY,
+                                 int begin, int count, Uint32* mask)
+{
+    for (int j = begin; j < count; j++) {
+        if (minX[j] < x1 && x0 < maxX[j] && minY[j] < y1 && y0 < maxY[j]) {
+            mask[j >> 5] |= 1u << (j & 31);
+        }
+    }
+}
+
+static void OverlapRowScalar(int x0, int y0, int x1, int y1,
+                             const int* minX, const int* minY, const int* maxX, const int* maxY,
+                             int count, Uint32* mask)
+{
+    OverlapRowScalarFrom(x0, y0, x1, y1, minX, minY, maxX, maxY, 0, count, mask);
+}
+
+#ifdef GG_X86
+
+//
+// The vector versions do the four comparisons on 4 (SSE2) or 8 (AVX2)
+// rects at a time, AND them together, and use movemask to squeeze the
+// lanes down into one bit each.  The blocks start at multiples of 4 or 8,
+// so a block's bits never straddle two mask words.
+//
+
+GG_TARGET_SSE2
+static void OverlapRowSSE2(int x0, int y0, int x1, int y1,
+                           const int* minX, const int* minY, const int* maxX, const int* maxY,
+                           int count, Uint32* mask)
+{
+    const __m128i ax0 = _mm_set1_epi32(x0);
+    const __m128i ay0 = _mm_set1_epi32(y0);
+    const __m128i ax1 = _mm_set1_epi32(x1);
+    const __m128i ay1 = _mm_set1_epi32(y1);
+
+    int j = 0;
+    for ( ; j + 4 <= count; j += 4) {
+        __m128i hitX = _mm_and_si128(_mm_cmplt_epi32(_mm_loadu_si128((const __m128i*)(minX + j)), ax1),
+                                     _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(maxX + j)), ax0));
+        __m128i hitY = _mm_and_si128(_mm_cmplt_epi32(_mm_loadu_si128((const __m128i*)(minY + j)), ay1),
+                                     _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(maxY + j)), ay0));
+
+        Uint32 bits = (Uint32)_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(hitX, hitY)));
+        mask[j >> 5] |= bits << (j & 31);
+    }
+
+    OverlapRowScalarFrom(x0, y0, x1, y1, minX, minY, maxX, maxY, j, count, mask);
+}
+
+GG_TARGET_AVX2
+static void OverlapRowAVX2(int x0, int y0, int x1, int y1,
+                           const int* minX, const int* minY, const int* maxX, const int* maxY,
+                           int count, Uint32* mask)
+{
+    const __m256i ax0 = _mm256_set1_epi32(x0);
+    const __m256i ay0 = _mm256_set1_epi32(y0);
+    const __m256i ax1 = _mm256_set1_epi32(x1);
+    const __m256i ay1 = _mm256_set1_epi32(y1);
+
+    int j = 0;
+    for ( ; j + 8 <= count; j += 8) {
+        // AVX2 only has a greater-than compare, so min < x1 becomes x1 > min
+        __m256i hitX = _mm256_and_si256(_mm256_cmpgt_epi32(ax1, _mm256_loadu_si256((const __m256i*)(minX + j))),
+                                        _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(maxX + j)), ax0));
+        __m256i hitY = _mm256_and_si256(_mm256_cmpgt_epi32(ay1, _mm256_loadu_si256((const __m256i*)(minY + j))),
+                                        _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(maxY + j)), ay0));
+
+        Uint32 bits = (Uint32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(hitX, hitY)));
+        mask[j >> 5] |= bits << (j & 31);
+    }
+
+    OverlapRowScalarFrom(x0, y0, x1, y1, minX, minY, maxX, maxY, j, count, mask);
+}
+
+#endif
+
+static RowFunc GetRowFunc(SimdLevel level)
+{
+#ifdef GG_X86
+    switch (level) {
+    case SIMD_AVX2: return OverlapRowAVX2;
+    case SIMD_SSE2: return OverlapRowSSE2;
+    default:        break;
+    }
+#endif
+    return OverlapRowScalar;
+}
+
+static inline int CountBits(Uint32 v)
+{
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return (int)((((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+static int CountMaskBits(const Uint32* mask, int numWords)
+{
+    int hits = 0;
+    for (int w = 0; w < numWords; w++) {
+        hits += CountBits(mask[w]);
+    }
+    return hits;
+}
+
+static int OverlapOneToMany(RowFunc row, const Rect& rect, const RectArray& rects, int first, int count, Uint32* mask)
+{
+    int numWords = GetMaskWords(count);
+    if (numWords == 0) {
+        return 0;
+    }
+    std::memset(mask, 0, numWords * sizeof(Uint32));
+
+    row(rect.x, rect.y, rect.x + rect.w, rect.y + rect.h,
+        rects.GetMinX() + first, rects.GetMinY() + first, rects.GetMaxX() + first, rects.GetMaxY() + first,
+        count, mask);
+
+    return CountMaskBits(mask, numWords);
+}
+
+static int OverlapManyToMany(RowFunc row, const RectArray& a, int firstA, int countA,
+                             const RectArray& b, int firstB, int countB, Uint32* masks)
+{
+    int numWords = GetMaskWords(countB);
+    if (numWords == 0 || countA <= 0) {
+        return 0;
+    }
+    std::memset(masks, 0, countA * numWords * sizeof(Uint32));
+
+    const int* minX = b.GetMinX() + firstB;
+    const int* minY = b.GetMinY() + firstB;
+    const int* maxX = b.GetMaxX() + firstB;
+    const int* maxY = b.GetMaxY() + firstB;
+
+    for (int i = 0; i < countA; i++) {
+        int k = firstA + i;
+        row(a.GetMinX()[k], a.GetMinY()[k], a.GetMaxX()[k], a.GetMaxY()[k],
+            minX, minY, maxX, maxY, countB, masks + i * numWords);
+    }
+
+    return CountMaskBits(masks, countA * numWords);
+}
+
+int OverlapOneToMany(const Rect& rect, const RectArray& rects, int first, int count, Uint32* mask)
+{
+    return OverlapOneToMany(GetRowFunc(GetSimdLevel()), rect, rects, first, count, mask);
+}
+
+int OverlapManyToMany(const RectArray& a, int firstA, int countA,
+                      const RectArray& b, int firstB, int countB, Uint32* masks)
+{
+    return OverlapManyToMany(GetRowFunc(GetSimdLevel()), a, firstA, countA, b, firstB, countB, masks);
+}
+
+/*
+================================================================================
+
+BenchmarkOverlap
+
+    The rects are scattered over a 4096x4096 area and are 8 to 64 pixels
+    on a side, which gives a handful of hits per query, a bit like a busy
+    scene.  They come from a fixed seed, so runs can be compared.
+
+================================================================================
+*/
+void BenchmarkOverlap(int numRects, int numRounds)
+{
+    if (numRects < 1) {
+        numRects = 1;
+    }
+    if (numRounds < 1) {
+        numRounds = 1;
+    }
+
+    Uint32 seed = 12345;
+    RectArray rects;
+    rects.Reserve(numRects);
+    for (int i = 0; i < numRects; i++) {
+        int coords[4];
+        for (int k = 0; k < 4; k++) {
+            seed = seed * 1664525u + 1013904223u;
+            coords[k] = (int)(seed >> 8);
+        }
+        rects.Add(Rect(coords[0] % 4096, coords[1] % 4096, 8 + coords[2] % 57, 8 + coords[3] % 57));
+    }
+
+    int numWords = GetMaskWords(numRects);
+    std::vector<Uint32> expected(numRects * numWords);
+    std::vector<Uint32> masks(numRects * numWords);
+
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    double scalarTime = 0;
+
+    SimdLevel levels[] = { SIMD_NONE, SIMD_SSE2, SIMD_AVX2 };
+    for (int l = 0; l < 3; l++) {
+        if (levels[l] > GetSimdLevel()) {
+            break;
+        }
+        RowFunc row = GetRowFunc(levels[l]);
+        std::vector<Uint32>& out = (l == 0) ? expected : masks;
+
+        // every round tests all the rects against all the rects
+        int hits = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int r = 0; r < numRounds; r++) {
+            hits = OverlapManyToMany(row, rects, 0, numRects, rects, 0, numRects, &out[0]);
+        }
+        double seconds = (double)(SDL_GetPerformanceCounter() - start) / freq;
+
+        if (l == 0) {
+            scalarTime = seconds;
+        }
+
+        bool agrees = (out == expected);
+        double tests = (double)numRects * numRects * numRounds;
+
+        std::cout << "*** " << GetSimdLevelName(levels[l]) << ": "
+                  << 1e9 * seconds / tests << " ns per test, "
+                  << scalarTime / seconds << "x scalar, "
+                  << hits << " hits"
+                  << (agrees ? "" : " (DOES NOT MATCH SCALAR)") << std::endl;
+    }
+}
+
+} // end namespace
@@ -0,0 +1,118 @@
+#ifndef GG_COLLISION_H_
+#define GG_COLLISION_H_
+
+#include <SDL.h>
+
+#include "GG_Common.h"
+
+#include <vector>
+
+namespace GG {
+
+/*
+================================================================================
+
+RectArray class
+
+    A list of rects stored as four separate arrays of min/max corners
+    (structure of arrays), which is the layout the batch overlap tests
+    below want: they load 4 or 8 rects' worth of each coordinate at once.
+
+    Adding a rect that's empty is allowed, it just never overlaps anything.
+
+================================================================================
+*/
+class RectArray {
+    std::vector<int>        mMinX;
+    std::vector<int>        mMinY;
+    std::vector<int>        mMaxX;          // x + w
+    std::vector<int>        mMaxY;          // y + h
+
+public:
+    void                    Clear();
+    void                    Reserve(int n);
+    void                    Resize(int n);
+
+    void                    Add(const Rect& rect);
+    void                    Set(int i, const Rect& rect);
+
+    int                     GetCount() const    { return (int)mMinX.size(); }
+    Rect                    Get(int i) const    { return Rect(mMinX[i], mMinY[i], mMaxX[i] - mMinX[i], mMaxY[i] - mMinY[i]); }
+
+    const int*              GetMinX() const     { return mMinX.empty() ? NULL : &mMinX[0]; }
+    const int*              GetMinY() const     { return mMinY.empty() ? NULL : &mMinY[0]; }
+    const int*              GetMaxX() const     { return mMaxX.empty() ? NULL : &mMaxX[0]; }
+    const int*              GetMaxY() const     { return mMaxY.empty() ? NULL : &mMaxY[0]; }
+};
+
+/*
+================================================================================
+
+GetMaskWords
+
+    The number of 32-bit words a hit mask for count rects takes up.
+
+================================================================================
+*/
+inline int GetMaskWords(int count)
+{
+    return (count + 31) / 32;
+}
+
+/*
+================================================================================
+
+OverlapOneToMany
+
+    Tests one rect against rects[first] to rects[first + count - 1] and
+    writes the results to mask as bits: bit (j % 32) of mask[j / 32] is
+    set if rects[first + j] overlaps.  Returns the number of hits.
+
+    mask must have room for GetMaskWords(count) words.  It gets
+    overwritten, so it doesn't need to be cleared beforehand.
+
+    Rects overlap if they share some area, so rects that merely touch
+    edges don't count, same as SDL_HasIntersection.
+
+    The work is done with AVX2 or SSE2 when the CPU has them (see
+    GetSimdLevel), falling back to plain C++ otherwise.  All paths produce
+    exactly the same result.
+
+================================================================================
+*/
+int OverlapOneToMany(const Rect& rect, const RectArray& rects, int first, int count, Uint32* mask);
+
+/*
+================================================================================
+
+OverlapManyToMany
+
+    Tests every rect in a[firstA .. firstA + countA - 1] against every rect
+    in b[firstB .. firstB + countB - 1].  The result is one mask row per
+    rect of a, laid out like OverlapOneToMany's mask, and each row is
+    GetMaskWords(countB) words long.  Returns the total number of hits.
+
+    a and b may be the same array.
+
+================================================================================
+*/
+int OverlapManyToMany(const RectArray& a, int firstA, int countA,
+                      const RectArray& b, int firstB, int countB, Uint32* masks);
+
+/*
+================================================================================
+
+BenchmarkOverlap
+
+    Times the scalar, SSE2 and AVX2 versions of the overlap tests (the
+    ones this CPU supports) on random rects, checks that they all agree,
+    and prints the results.  Run the game with --bench-collision to get
+    here.
+
+================================================================================
+*/
+void BenchmarkOverlap(int numRects, int numRounds);
+
+} // end namespace
+
+#endif
@@ -4,29 +4,61 @@
 
 namespace GG {
 
+// PCG32 (pcg-random.org): a 64-bit LCG with a permuted 32-bit output
+static const Uint64 PCG_MULTIPLIER = 6364136223846793005ULL;
+static const Uint64 PCG_INCREMENT = 1442695040888963407ULL;
+
+Uint32 Random::Bits()
+{
+    Uint64 old = mState;
+    mState = old * PCG_MULTIPLIER + PCG_INCREMENT;
+
+    Uint32 xorShifted = (Uint32)(((old >> 18) ^ old) >> 27);
+    Uint32 rot = (Uint32)(old >> 59);
+    return (xorShifted >> rot) | (xorShifted << ((32 - rot) & 31));
+}
+
+void Random::Seed(unsigned seed)
+{
+    mSeed = seed;
+
+    // the seed goes in between two steps, so that similar seeds still
+    // start far apart
+    mState = 0;
+    Bits();
+    mState += seed;
+    Bits();
+}
+
+// the global generator
+static Random sRandom;
+
+Uint32 RandomBits()
+{
+    return sRandom.Bits();
+}
+
+Uint64 GetRandomState()
+{
+    return sRandom.GetState();
+}
+
 void InitRandom()
 {
-    int i, n;
-
-    // seed the random number generator
-    std::srand((unsigned)std::time(NULL) ^ (unsigned)std::rand());
-
-    //
-    // On some plarforms, similar random number seeds produce random number
-    // sequences that are similar initially, but diverge eventually.
-    //
-    // To help circumvent this, pull a random number of random numbers
-    // from the start of the sequence.
-    //
-    n = 10 + rand() % 10;
-    for (i = 0; i < n; i++) {
-        rand();
-    }
+    // the time only changes once a second, the performance counter makes
+    // runs started in the same second differ
+    Uint64 counter = SDL_GetPerformanceCounter();
+    InitRandom((unsigned)std::time(NULL) ^ (unsigned)counter ^ (unsigned)(counter >> 32));
 }
 
 void InitRandom(unsigned seed)
 {
-    std::srand(seed);
+    sRandom.Seed(seed);
+}
+
+unsigned GetRandomSeed()
+{
+    return sRandom.GetSeed();
 }
 
 } // end namespace
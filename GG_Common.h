@@ -2,9 +2,18 @@
 #define GG_COMMON_H_
 
 #include <cstdlib>
+#include <cmath>
 
 #include <SDL.h>
 
+// thread_local isn't there yet in VS2012, but both compilers have had a
+// way to make a plain pointer or int thread local for a long time
+#if defined(_MSC_VER)
+#define GG_THREAD_LOCAL __declspec(thread)
+#else
+#define GG_THREAD_LOCAL __thread
+#endif
+
 namespace GG {
 
 /*
@@ -74,17 +83,95 @@ struct Point : public SDL_Point {
 /*
 ================================================================================
 
+InterpolateRect
+
+    Returns cur moved back towards prev: alpha 0 gives prev's position and
+    alpha 1 gives cur's.  The size is always cur's.  Used to draw things
+    in between two simulation steps.
+
+================================================================================
+*/
+inline Rect InterpolateRect(const Rect& prev, const Rect& cur, float alpha)
+{
+    return Rect(prev.x + (int)floor((cur.x - prev.x) * alpha + 0.5f),
+                prev.y + (int)floor((cur.y - prev.y) * alpha + 0.5f),
+                cur.w, cur.h);
+}
+
+/*
+================================================================================
+
+Random class
+
+    A random number generator of its own, for things that mustn't share
+    one: each World draws from its own, so that worlds stepping side by
+    side on different threads get exactly the numbers they'd get alone.
+    It's the same generator as the global one below (PCG32), and the
+    methods do what the functions with the matching names do.
+
+================================================================================
+*/
+class Random {
+    Uint64                  mState;
+    unsigned                mSeed;
+
+public:
+    explicit                Random(unsigned seed = 0)   { Seed(seed); }
+
+    void                    Seed(unsigned seed);
+    unsigned                GetSeed() const             { return mSeed; }
+    Uint64                  GetState() const            { return mState; }
+
+    Uint32                  Bits();
+
+    float                   Unit()                      { return (Bits() >> 8) * (1.0f / 16777216.0f); }
+    float                   UnitInclusive()             { return (Bits() >> 8) * (1.0f / 16777215.0f); }
+    int                     Int(int upper)              { return (int)(upper * Unit()); }
+    int                     Int(int lower, int upper)   { return lower + (int)((upper - lower) * Unit()); }
+    int                     IntInclusive(int lower, int upper)  { return lower + (int)((upper - lower + 1) * Unit()); }
+    float                   Float(float lower, float upper)     { return lower + (upper - lower) * Unit(); }
+    float                   FloatInclusive(float lower, float upper)    { return lower + (upper - lower) * UnitInclusive(); }
+    int                     Sign()                      { return Unit() < 0.5f ? 1 : -1; }
+};
+
+/*
+================================================================================
+
 InitRandom
 
     Functions to initialize the global random number generator.
     Should only be called once at the start of the application, unless
     there is a good reason otherwise.
 
+    The generator is our own (PCG32) rather than rand(), so the same seed
+    gives the same numbers on every platform and with every C library.
+    GetRandomSeed returns the seed it was last initialized with, which is
+    all it takes to reproduce everything random that happens afterwards
+    (see InputRecording).
+
 ================================================================================
 */
 void InitRandom();                  // initialize using a randomized seed
 void InitRandom(unsigned seed);     // initialize using the specified seed
 
+unsigned GetRandomSeed();
+
+/*
+================================================================================
+
+RandomBits
+
+    Return 32 random bits, and advance the generator.  All the functions
+    below are built on this one.
+
+    GetRandomState returns where the generator is, without advancing it,
+    for checking that two runs have drawn the same numbers.
+
+================================================================================
+*/
+Uint32 RandomBits();
+Uint64 GetRandomState();
+
 /*
 ================================================================================
 
@@ -96,7 +183,8 @@ UnitRandom
 */
 inline float UnitRandom()
 {
-    return rand() / (RAND_MAX + 1.0f);
+    // 24 bits is all a float can hold exactly
+    return (RandomBits() >> 8) * (1.0f / 16777216.0f);
 }
 
 /*
@@ -168,7 +256,7 @@ UnitRandomInclusive
 */
 inline float UnitRandomInclusive()
 {
-    return rand() / (float)RAND_MAX;
+    return (RandomBits() >> 8) * (1.0f / 16777215.0f);
 }
 
 /*
@@ -0,0 +1,33 @@
+#include "GG_Cpu.h"
+
+namespace GG {
+
+// set once by InitSimdLevel, before there are any other threads to read it
+static SimdLevel sSimdLevel = SIMD_NONE;
+
+void InitSimdLevel()
+{
+#ifdef GG_X86
+    if (SDL_HasAVX2()) {
+        sSimdLevel = SIMD_AVX2;
+    } else if (SDL_HasSSE2()) {
+        sSimdLevel = SIMD_SSE2;
+    }
+#endif
+}
+
+SimdLevel GetSimdLevel()
+{
+    return sSimdLevel;
+}
+
+const char* GetSimdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SIMD_AVX2: return "AVX2";
+    case SIMD_SSE2: return "SSE2";
+    default:        return "scalar";
+    }
+}
+
+} // end namespace
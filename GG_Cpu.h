@@ -0,0 +1,62 @@
+#ifndef GG_CPU_H_
+#define GG_CPU_H_
+
+#include <SDL.h>
+
+/*
+================================================================================
+
+SIMD support
+
+    GG_X86 is defined on x86 and x64 builds, which is where the SSE2 and
+    AVX2 code paths exist.  Everywhere else, only the scalar code is built.
+
+    GG_TARGET_SSE2 and GG_TARGET_AVX2 go in front of functions that use
+    those instruction sets.  MSVC lets any function use any intrinsic, but
+    GCC and Clang need to be told per function, so that the rest of the
+    program can still run on CPUs that lack them.  Functions marked this
+    way must only be called after checking GetSimdLevel.
+
+================================================================================
+*/
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define GG_X86 1
+#endif
+
+#if defined(GG_X86) && (defined(__GNUC__) || defined(__clang__))
+#define GG_TARGET_SSE2  __attribute__((target("sse2")))
+#define GG_TARGET_AVX2  __attribute__((target("avx2")))
+#else
+#define GG_TARGET_SSE2
+#define GG_TARGET_AVX2
+#endif
+
+namespace GG {
+
+enum SimdLevel {
+    SIMD_NONE,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+/*
+================================================================================
+
+InitSimdLevel, GetSimdLevel
+
+    GetSimdLevel returns the best instruction set that both the build and
+    the CPU we're running on support.  InitSimdLevel works that out, and
+    should be called once at the start of the application, before any
+    other threads are started; until then, GetSimdLevel says SIMD_NONE.
+    After that, any thread can call GetSimdLevel at any time.
+
+================================================================================
+*/
+void InitSimdLevel();
+SimdLevel GetSimdLevel();
+
+const char* GetSimdLevelName(SimdLevel level);
+
+} // end namespace
+
+#endif
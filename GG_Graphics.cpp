@@ -1,10 +1,17 @@
 #include "GG_Graphics.h"
 
+#include "GG_Pixels.h"
+#include "GG_Profiler.h"
+
 #include <SDL_image.h>
+#include <algorithm>
 #include <iostream>
 
 namespace GG {
 
+static const int MAX_ATLAS_PAGE_SIZE = 2048;   // upper bound on atlas page width and height
+static const int ATLAS_PADDING = 2;            // transparent gap between packed images
+
 /*
 ================================================================================
 
@@ -133,7 +140,10 @@ Texture constructor
 */
 Texture::Texture(const std::string& name, SDL_Texture* tex)
     : mName(name)
+    , mId(INVALID_TEXTURE_ID)
     , mTex(tex)
+    , mOwnsTex(true)
+    , mRegion()
     , mWidth(0)
     , mHeight(0)
     , mNumCells(0)
@@ -144,6 +154,9 @@ Texture::Texture(const std::string& name, SDL_Texture* tex)
     if (tex) {
         SDL_QueryTexture(tex, NULL, NULL, &mWidth, &mHeight);
 
+        mRegion.w = mWidth;
+        mRegion.h = mHeight;
+
         // this constructor assumes that there's only once cell (entire texture)
         mNumCells = 1;
 
@@ -165,7 +178,10 @@ Texture constructor
 */
 Texture::Texture(const std::string& name, SDL_Texture* tex, int numCells)
     : mName(name)
+    , mId(INVALID_TEXTURE_ID)
     , mTex(tex)
+    , mOwnsTex(true)
+    , mRegion()
     , mWidth(0)
     , mHeight(0)
     , mNumCells(0)
@@ -176,6 +192,9 @@ Texture::Texture(const std::string& name, SDL_Texture* tex, int numCells)
     if (tex) {
         SDL_QueryTexture(tex, NULL, NULL, &mWidth, &mHeight);
 
+        mRegion.w = mWidth;
+        mRegion.h = mHeight;
+
         mNumCells = numCells;
 
         mCellWidth = mWidth / numCells;
@@ -186,16 +205,43 @@ Texture::Texture(const std::string& name, SDL_Texture* tex, int numCells)
 /*
 ================================================================================
 
+Texture constructor
+
+    This constructor is used by the TextureManager for textures that will be
+    packed into an atlas page.  The size is known up front, but there's no
+    SDL_Texture to draw with until the TextureManager places the texture
+    on a page and fills in the page pointer and region.
+
+================================================================================
+*/
+Texture::Texture(const std::string& name, int width, int height, int numCells)
+    : mName(name)
+    , mId(INVALID_TEXTURE_ID)
+    , mTex(NULL)
+    , mOwnsTex(false)
+    , mRegion(0, 0, width, height)
+    , mWidth(width)
+    , mHeight(height)
+    , mNumCells(numCells)
+    , mCellWidth(width / numCells)
+    , mCellHeight(height)
+{
+}
+
+/*
+================================================================================
+
 Texture destructor
 
-    Deletes the owned texture, if any.
+    Deletes the owned texture, if any.  Atlas pages belong to the
+    TextureManager, so they are left alone.
 
 ================================================================================
 */
 Texture::~Texture()
 {
     // delete the SDL_Texture
-    if (mTex) {
+    if (mTex && mOwnsTex) {
         SDL_DestroyTexture(mTex);
     }
 }
@@ -214,7 +260,12 @@ TextureManager constructor
 TextureManager::TextureManager()
     : mRenderer(NULL)
     , mRootDir()
+    , mBuildingAtlas(false)
+    , mWorkers(NULL)
+    , mDecodeStart(0)
     , mDefaultTex(NULL)
+    , font(NULL)
+    , mGlyphAtlas(NULL)
 {
 }
 
@@ -234,6 +285,8 @@ TextureManager::~TextureManager()
 
     // delete the default texture
     delete mDefaultTex;
+
+    delete mGlyphAtlas;
 }
 
 /*
@@ -242,19 +295,21 @@ TextureManager::~TextureManager()
 TextureManager::Initialize
 
     Performs proper initialization, including setting up the texture root
-    directory path and creating the default texture.
+    directory path, building the glyph atlas, and creating the default texture.
 
     Typically, this method should be called only once, before calling any
     methods for loading or getting textures.
 
+    If renderer is NULL, the TextureManager keeps only the sizes and cell
+    layouts of the textures it loads, without creating anything that can be
+    drawn (see IsHeadless).  That's enough for the game logic, which only
+    cares about cell sizes, to run with no window at all.  There's no font
+    or glyph atlas either, so GetGlyphAtlas returns NULL.
+
 ================================================================================
 */
 bool TextureManager::Initialize(SDL_Renderer* renderer, const std::string& rootDir)
 {
-    if (!renderer) {
-        return false;
-    }
-
     mRenderer = renderer;
     mRootDir = rootDir;
 
@@ -266,6 +321,14 @@ bool TextureManager::Initialize(SDL_Renderer* renderer, const std::string& rootD
         }
     }
 
+    if (IsHeadless()) {
+        if (mDefaultTex) {
+            DeleteTexture(mDefaultTex);
+        }
+        mDefaultTex = CreateDefaultTexture();
+        return true;
+    }
+
 	// Load the font
 	font = TTF_OpenFont("fonts/FreeSerifBold.ttf", 20);
 	if (font == NULL)
@@ -274,6 +337,13 @@ bool TextureManager::Initialize(SDL_Renderer* renderer, const std::string& rootD
 		return NULL;
 	}
 
+    // pre-render the glyphs, so that drawing text doesn't need to rasterize anything
+    delete mGlyphAtlas;
+    mGlyphAtlas = new GlyphAtlas;
+    if (!mGlyphAtlas->Build(renderer, font)) {
+        return false;
+    }
+
     if (mDefaultTex) {
         DeleteTexture(mDefaultTex);
     }
@@ -318,6 +388,10 @@ Texture* TextureManager::CreateDefaultTexture()
     int height = 64;
     int checkerSize = 8;
 
+    if (IsHeadless()) {
+        return new Texture("_Default", width, height, 1);
+    }
+
     Image img;
     if (!img.Alloc(width, height, 3)) {
         return NULL;
@@ -377,21 +451,14 @@ TextureManager::LoadTexture
     already exists in the lookup table, requests to load another texture
     under the same name will fail.
 
-    This method loads the image from the specified path, then delegates the
-    actual Texture creation to the method that loads textures from Images.
+    While an atlas is being built with a ThreadPool, the file is decoded
+    on a worker thread and the Texture doesn't get its size until EndAtlas.
 
 ================================================================================
 */
 Texture* TextureManager::LoadTexture(const std::string& name, const std::string& filename, bool grayscale, int numCells)
 {
-    // determine full path
-    std::string path = mRootDir + filename;
-
-    // load the image
-    Image img(path);                      
-
-    // create texture from image
-    return LoadTexture(name, img, grayscale, numCells);
+    return LoadFile(name, "", filename, grayscale, numCells);
 }
 
 /*
@@ -410,12 +477,18 @@ Texture* TextureManager::LoadTexture(const std::string& name, const Image& img,
     if (img.IsLoaded()) {
 
         // first, check if the name already exists in our lookup table
-        if (mTextures.find(name) != mTextures.end()) {
+        if (Exists(name)) {
             std::cerr << "*** Texture with name '" << name << "' already exists" << std::endl;
             return NULL;
         }
 
-        SDL_Surface* surf = img.GetSurface();
+        // work on a 32-bit copy, so the image itself is left alone
+        SDL_Surface* surf = SDL_ConvertSurfaceFormat(img.GetSurface(), SDL_PIXELFORMAT_ARGB8888, 0);
+        if (!surf) {
+            std::cerr << "*** Failed to convert image for texture '" << name << "': " << SDL_GetError() << std::endl;
+            return NULL;
+        }
+
 		// If grayscale has been requested
 		if (grayscale)
 		{
@@ -425,24 +498,367 @@ Texture* TextureManager::LoadTexture(const std::string& name, const Image& img,
 			}
 		}
 
-        SDL_Texture* tex = SDL_CreateTextureFromSurface(mRenderer, surf);
-        if (!tex) {
-            std::cerr << "*** Failed to create texture '" << name << "': " << SDL_GetError() << std::endl;
+        return AddTexture(name, surf, numCells);
+
+    } else {
+        // invalid image, fail
+        return NULL;
+    }
+}
+
+/*
+================================================================================
+
+TextureManager::LoadTexturePair
+
+    Loads a color texture and a grayscale version of it from the same file.
+    The file only gets decoded once, and the grayscale pixels are computed
+    straight from the color ones, which is a lot cheaper than loading the
+    file twice.
+
+    Both names must be unique.  Returns the color texture; the grayscale
+    one can be retrieved using GetTexture(grayName).
+
+================================================================================
+*/
+Texture* TextureManager::LoadTexturePair(const std::string& name, const std::string& grayName, const std::string& filename, int numCells)
+{
+    return LoadFile(name, grayName, filename, false, numCells);
+}
+
+/*
+================================================================================
+
+TextureManager::LoadPackedTexture
+
+    Loads an image entry from an asset pack, under the texture names and
+    with the cell count stored in the pack.  If the entry has a grayscale
+    name, the grayscale version gets created too.
+
+    The color pixels aren't copied at all: the surface handed to the
+    renderer (or the atlas packer) points right into the mapped pack.
+
+================================================================================
+*/
+Texture* TextureManager::LoadPackedTexture(const AssetPack& pack, const PackEntry& entry)
+{
+    GG_PROFILE_SCOPE("Asset.LoadPacked");
+
+    if (entry.type != PACK_IMAGE) {
+        return NULL;
+    }
+
+    if (Exists(entry.name)) {
+        std::cerr << "*** Texture with name '" << entry.name << "' already exists" << std::endl;
+        return NULL;
+    }
+    if (entry.grayName[0] && Exists(entry.grayName)) {
+        std::cerr << "*** Texture with name '" << entry.grayName << "' already exists" << std::endl;
+        return NULL;
+    }
+
+    // no pixels needed, and no grayscale copy to make
+    if (IsHeadless()) {
+        Texture* texObj = new Texture(entry.name, entry.width, entry.height, entry.numCells);
+        Register(texObj);
+        if (entry.grayName[0]) {
+            Register(new Texture(entry.grayName, entry.width, entry.height, entry.numCells));
+        }
+        return texObj;
+    }
+
+    // the surface only reads from the pixels, so pointing it at read-only memory is fine
+    Uint8* pixels = (Uint8*)pack.GetData(entry);
+    SDL_Surface* surf = SDL_CreateRGBSurfaceWithFormatFrom(pixels, entry.width, entry.height, 32, entry.pitch, pack.GetPixelFormat());
+    if (!surf) {
+        std::cerr << "*** Failed to create surface for texture '" << entry.name << "': " << SDL_GetError() << std::endl;
+        return NULL;
+    }
+
+    SDL_Surface* gray = NULL;
+    if (entry.grayName[0]) {
+        gray = SDL_CreateRGBSurfaceWithFormat(0, entry.width, entry.height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!gray) {
+            std::cerr << "*** Failed to create surface for texture '" << entry.grayName << "': " << SDL_GetError() << std::endl;
+            SDL_FreeSurface(surf);
             return NULL;
         }
+        GrayscaleARGB8888(pixels, entry.pitch, (Uint8*)gray->pixels, gray->pitch, entry.width, entry.height);
+    }
+
+    Texture* texObj = AddTexture(entry.name, surf, entry.numCells);
+    if (gray) {
+        AddTexture(entry.grayName, gray, entry.numCells);
+    }
 
-        // create a new Texture object
-        Texture* texObj = new Texture(name, tex, numCells);
+    return texObj;
+}
 
-        // add it to our lookup table
-        mTextures[name] = texObj;
+/*
+================================================================================
 
-        return texObj;
+TextureManager::LoadFile
 
+    Does the work for the LoadTexture overloads that take a filename.  The
+    grayscale copy is only made if grayName isn't empty.
+
+    When a ThreadPool is decoding for the atlas, this creates placeholder
+    Textures and queues the decoding, otherwise the file gets decoded right
+    here.
+
+================================================================================
+*/
+Texture* TextureManager::LoadFile(const std::string& name, const std::string& grayName, const std::string& filename, bool grayscale, int numCells)
+{
+    GG_PROFILE_SCOPE("Asset.LoadFile");
+
+    if (Exists(name)) {
+        std::cerr << "*** Texture with name '" << name << "' already exists" << std::endl;
+        return NULL;
+    }
+    if (!grayName.empty() && Exists(grayName)) {
+        std::cerr << "*** Texture with name '" << grayName << "' already exists" << std::endl;
+        return NULL;
+    }
+
+    DecodeJob* job = new DecodeJob;
+    job->path = mRootDir + filename;
+    job->grayscale = grayscale;
+    job->makeGrayCopy = !grayName.empty();
+    job->tex = NULL;
+    job->grayTex = NULL;
+    job->surf = NULL;
+    job->graySurf = NULL;
+    job->ticks = 0;
+
+    if (mBuildingAtlas && mWorkers) {
+
+        // the size gets filled in once the pixels are in
+        job->tex = new Texture(name, 0, 0, numCells);
+        Register(job->tex);
+
+        if (job->makeGrayCopy) {
+            job->grayTex = new Texture(grayName, 0, 0, numCells);
+            Register(job->grayTex);
+        }
+
+        if (mDecodeJobs.empty()) {
+            mDecodeStart = SDL_GetPerformanceCounter();
+        }
+        mDecodeJobs.push_back(job);
+
+        mWorkers->Submit([job]() { RunDecodeJob(job); });
+
+        return job->tex;
+    }
+
+    RunDecodeJob(job);
+
+    Texture* texObj = NULL;
+    if (job->surf) {
+        texObj = AddTexture(name, job->surf, numCells);
+        if (job->graySurf) {
+            AddTexture(grayName, job->graySurf, numCells);
+        }
     } else {
-        // invalid image, fail
+        std::cerr << "*** " << job->error << std::endl;
+    }
+
+    delete job;
+    return texObj;
+}
+
+/*
+================================================================================
+
+TextureManager::RunDecodeJob
+
+    Loads the file and turns it into 32-bit surfaces, grayscale included.
+    This may run on a worker thread, so it doesn't touch anything but the
+    job (SDL keeps its error messages per thread, so those are fine).
+
+================================================================================
+*/
+void TextureManager::RunDecodeJob(DecodeJob* job)
+{
+    GG_PROFILE_SCOPE("Asset.Decode");
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    SDL_Surface* img = IMG_Load(job->path.c_str());
+    if (!img) {
+        job->error = "Failed to load image '" + job->path + "': " + IMG_GetError();
+        return;
+    }
+
+    job->surf = SDL_ConvertSurfaceFormat(img, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(img);
+
+    if (!job->surf) {
+        job->error = "Failed to convert image '" + job->path + "': " + SDL_GetError();
+        return;
+    }
+
+    SDL_Surface* surf = job->surf;
+
+    if (job->grayscale) {
+        GrayscaleARGB8888((const Uint8*)surf->pixels, surf->pitch, (Uint8*)surf->pixels, surf->pitch, surf->w, surf->h);
+    }
+
+    if (job->makeGrayCopy) {
+        job->graySurf = SDL_CreateRGBSurfaceWithFormat(0, surf->w, surf->h, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!job->graySurf) {
+            job->error = "Failed to create grayscale copy of '" + job->path + "': " + SDL_GetError();
+            SDL_FreeSurface(job->surf);
+            job->surf = NULL;
+            return;
+        }
+
+        // freshly created surfaces don't need locking
+        GrayscaleARGB8888((const Uint8*)surf->pixels, surf->pitch,
+                          (Uint8*)job->graySurf->pixels, job->graySurf->pitch,
+                          surf->w, surf->h);
+    }
+
+    job->ticks = SDL_GetPerformanceCounter() - start;
+}
+
+/*
+================================================================================
+
+TextureManager::FinishDecodeJobs
+
+    Waits for the queued decoding to finish, then hands the pixels to the
+    placeholder Textures and queues them for packing.  Files that failed to
+    load get their placeholders deleted, same as if they had been loaded
+    right away.
+
+================================================================================
+*/
+void TextureManager::FinishDecodeJobs()
+{
+    GG_PROFILE_SCOPE("Asset.FinishDecode");
+
+    if (mDecodeJobs.empty()) {
+        return;
+    }
+
+    mWorkers->Wait();
+
+    Uint64 wallTicks = SDL_GetPerformanceCounter() - mDecodeStart;
+    Uint64 workTicks = 0;
+
+    for (unsigned i = 0; i < mDecodeJobs.size(); i++) {
+        DecodeJob* job = mDecodeJobs[i];
+        workTicks += job->ticks;
+
+        if (job->surf) {
+            AddPending(job->tex, job->surf);
+            AddPending(job->grayTex, job->graySurf);
+        } else {
+            std::cerr << "*** " << job->error << std::endl;
+            if (job->tex) {
+                DeleteTexture(job->tex);
+            }
+            if (job->grayTex) {
+                DeleteTexture(job->grayTex);
+            }
+        }
+
+        delete job;
+    }
+
+    double freq = (double)SDL_GetPerformanceFrequency();
+    std::cout << "*** Decoded " << mDecodeJobs.size() << " images in " << 1000.0 * wallTicks / freq << " ms on "
+              << mWorkers->GetNumThreads() + 1 << " threads (" << 1000.0 * workTicks / freq << " ms of decoding)" << std::endl;
+
+    mDecodeJobs.clear();
+}
+
+/*
+================================================================================
+
+TextureManager::AddPending
+
+    Gives a placeholder Texture its size and queues its pixels for packing.
+    Takes ownership of the surface.  If the Texture was deleted in the
+    meantime, the surface just gets freed.
+
+================================================================================
+*/
+void TextureManager::AddPending(Texture* tex, SDL_Surface* surf)
+{
+    if (!surf) {
+        return;
+    }
+
+    if (!tex) {
+        SDL_FreeSurface(surf);
+        return;
+    }
+
+    tex->mWidth = surf->w;
+    tex->mHeight = surf->h;
+    tex->mRegion = Rect(0, 0, surf->w, surf->h);
+    tex->mCellWidth = surf->w / tex->mNumCells;
+    tex->mCellHeight = surf->h;
+
+    PendingImage pending;
+    pending.tex = tex;
+    pending.surf = surf;
+    mPending.push_back(pending);
+}
+
+/*
+================================================================================
+
+TextureManager::AddTexture
+
+    Creates a Texture from a 32-bit surface and adds it to the lookup table.
+    Takes ownership of the surface: while an atlas is being built, it's kept
+    around until EndAtlas packs it, otherwise it gets uploaded right away
+    and freed.  Without a renderer, only the size is kept.
+
+================================================================================
+*/
+Texture* TextureManager::AddTexture(const std::string& name, SDL_Surface* surf, int numCells)
+{
+    if (IsHeadless()) {
+        Texture* texObj = new Texture(name, surf->w, surf->h, numCells);
+        SDL_FreeSurface(surf);
+        Register(texObj);
+        return texObj;
+    }
+
+    if (mBuildingAtlas) {
+
+        Texture* texObj = new Texture(name, surf->w, surf->h, numCells);
+
+        PendingImage pending;
+        pending.tex = texObj;
+        pending.surf = surf;
+        mPending.push_back(pending);
+
+        Register(texObj);
+
+        return texObj;
+    }
+
+    SDL_Texture* tex = SDL_CreateTextureFromSurface(mRenderer, surf);
+    SDL_FreeSurface(surf);
+
+    if (!tex) {
+        std::cerr << "*** Failed to create texture '" << name << "': " << SDL_GetError() << std::endl;
         return NULL;
     }
+
+    // create a new Texture object
+    Texture* texObj = new Texture(name, tex, numCells);
+
+    // add it to our lookup table
+    Register(texObj);
+
+    return texObj;
 }
 
 /*
@@ -459,11 +875,18 @@ TextureManager::LoadTexture
 Texture* TextureManager::LoadTexture(const std::string& name, const char* text, SDL_Color text_color)
 {
 	// first, check if the name already exists in our lookup table
-    if (mTextures.find(name) != mTextures.end())
+    if (Exists(name))
 	{
         std::cerr << "*** Texture with name '" << name << "' already exists" << std::endl;
         return NULL;
     }
+
+	// no font without a renderer
+	if (!font)
+	{
+		std::cerr << "*** Can't create text texture '" << name << "' without a font" << std::endl;
+		return NULL;
+	}
 	
 	// Write the given text to a surface
 	SDL_Surface *textSurface;
@@ -488,7 +911,7 @@ Texture* TextureManager::LoadTexture(const std::string& name, const char* text,
     Texture* texObj = new Texture(name, tex, 1);
 
     // add it to our lookup table
-    mTextures[name] = texObj;
+    Register(texObj);
 
     return texObj;
 }
@@ -496,6 +919,230 @@ Texture* TextureManager::LoadTexture(const std::string& name, const char* text,
 /*
 ================================================================================
 
+TextureManager::BeginAtlas
+
+    Starts collecting textures for the atlas.  Until EndAtlas is called,
+    LoadTexture only decodes images and sets them aside, so the Textures it
+    returns can't be drawn yet.
+
+    If workers is not NULL, the decoding is done on its threads.
+
+================================================================================
+*/
+void TextureManager::BeginAtlas(ThreadPool* workers)
+{
+    mBuildingAtlas = true;
+    mWorkers = workers;
+}
+
+/*
+================================================================================
+
+TextureManager::EndAtlas
+
+    Packs every texture loaded since BeginAtlas into as few atlas pages as
+    possible and uploads the pages.  If the files are still being decoded,
+    this waits for that first.
+
+    The packing is a simple shelf packer.  Images are sorted tallest first,
+    and each one goes onto the first shelf with enough room left, where a
+    shelf is a horizontal strip of a page as tall as the first image put on
+    it.  When no shelf fits, a new shelf is opened below the last one, and
+    when a page runs out of room, a new page is started.  Images are
+    separated by a few transparent pixels so that filtering never picks up
+    a neighbour.
+
+    Pages are as wide as the renderer allows (up to MAX_ATLAS_PAGE_SIZE),
+    but only as tall as needed.
+
+================================================================================
+*/
+bool TextureManager::EndAtlas()
+{
+    GG_PROFILE_SCOPE("Asset.BuildAtlas");
+
+    FinishDecodeJobs();
+
+    mBuildingAtlas = false;
+    mWorkers = NULL;
+
+    if (mPending.empty()) {
+        return true;
+    }
+
+    // the Textures already know their sizes, and there's nothing to upload
+    if (IsHeadless()) {
+        std::cout << "*** Loaded the sizes of " << mPending.size() << " textures (no renderer)" << std::endl;
+        for (unsigned i = 0; i < mPending.size(); i++) {
+            SDL_FreeSurface(mPending[i].surf);
+        }
+        mPending.clear();
+        return true;
+    }
+
+    int pageWidth = MAX_ATLAS_PAGE_SIZE;
+    int pageHeight = MAX_ATLAS_PAGE_SIZE;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(mRenderer, &info) == 0) {
+        if (info.max_texture_width > 0) {
+            pageWidth = std::min(pageWidth, info.max_texture_width);
+        }
+        if (info.max_texture_height > 0) {
+            pageHeight = std::min(pageHeight, info.max_texture_height);
+        }
+    }
+
+    // pack the tallest images first, it keeps the shelves nice and full
+    std::vector<PendingImage> sorted(mPending);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const PendingImage& a, const PendingImage& b) { return a.surf->h > b.surf->h; });
+
+    struct Shelf {
+        int                 page;
+        int                 y;
+        int                 height;
+        int                 x;              // where the next image goes
+    };
+
+    std::vector<Shelf> shelves;
+    std::vector<int> pageUsed;              // height used so far on each page
+    std::vector<int> placedPage(sorted.size(), -1);
+    std::vector<Rect> placedRect(sorted.size());
+
+    bool ok = true;
+
+    for (unsigned i = 0; i < sorted.size(); i++) {
+        SDL_Surface* surf = sorted[i].surf;
+        int w = surf->w + ATLAS_PADDING;
+        int h = surf->h + ATLAS_PADDING;
+
+        if (w > pageWidth || h > pageHeight) {
+            // too big for a page, so it gets a texture of its own
+            if (!UploadStandalone(sorted[i].tex, surf)) {
+                ok = false;
+            }
+            continue;
+        }
+
+        // find the shelf that wastes the least height
+        int best = -1;
+        for (unsigned j = 0; j < shelves.size(); j++) {
+            if (shelves[j].height >= h && shelves[j].x + w <= pageWidth) {
+                if (best < 0 || shelves[j].height < shelves[best].height) {
+                    best = (int)j;
+                }
+            }
+        }
+
+        if (best < 0) {
+            // open a new shelf, on a new page if need be
+            int page = -1;
+            for (unsigned p = 0; p < pageUsed.size(); p++) {
+                if (pageUsed[p] + h <= pageHeight) {
+                    page = (int)p;
+                    break;
+                }
+            }
+            if (page < 0) {
+                page = (int)pageUsed.size();
+                pageUsed.push_back(0);
+            }
+
+            Shelf shelf;
+            shelf.page = page;
+            shelf.y = pageUsed[page];
+            shelf.height = h;
+            shelf.x = 0;
+            shelves.push_back(shelf);
+
+            pageUsed[page] += h;
+            best = (int)shelves.size() - 1;
+        }
+
+        Shelf& shelf = shelves[best];
+        placedPage[i] = shelf.page;
+        placedRect[i] = Rect(shelf.x, shelf.y, surf->w, surf->h);
+        shelf.x += w;
+    }
+
+    // compose and upload each page
+    for (unsigned p = 0; p < pageUsed.size(); p++) {
+        SDL_Surface* pageSurf = SDL_CreateRGBSurfaceWithFormat(0, pageWidth, pageUsed[p], 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!pageSurf) {
+            std::cerr << "*** Failed to allocate atlas page: " << SDL_GetError() << std::endl;
+            ok = false;
+            continue;
+        }
+
+        for (unsigned i = 0; i < sorted.size(); i++) {
+            if (placedPage[i] == (int)p) {
+                // copy the pixels as they are, alpha included
+                SDL_SetSurfaceBlendMode(sorted[i].surf, SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(sorted[i].surf, NULL, pageSurf, &placedRect[i]);
+            }
+        }
+
+        SDL_Texture* page = SDL_CreateTextureFromSurface(mRenderer, pageSurf);
+        SDL_FreeSurface(pageSurf);
+
+        if (!page) {
+            std::cerr << "*** Failed to create atlas page: " << SDL_GetError() << std::endl;
+            ok = false;
+            continue;
+        }
+
+        SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+        mAtlasPages.push_back(page);
+
+        for (unsigned i = 0; i < sorted.size(); i++) {
+            if (placedPage[i] == (int)p) {
+                sorted[i].tex->mTex = page;
+                sorted[i].tex->mOwnsTex = false;
+                sorted[i].tex->mRegion = placedRect[i];
+            }
+        }
+    }
+
+    std::cout << "*** Packed " << sorted.size() << " textures into " << mAtlasPages.size() << " atlas pages" << std::endl;
+
+    // the pixels live on the GPU now
+    for (unsigned i = 0; i < mPending.size(); i++) {
+        SDL_FreeSurface(mPending[i].surf);
+    }
+    mPending.clear();
+
+    return ok;
+}
+
+/*
+================================================================================
+
+TextureManager::UploadStandalone
+
+    Gives a pending texture an SDL_Texture of its own, for images that
+    don't fit on an atlas page.
+
+================================================================================
+*/
+bool TextureManager::UploadStandalone(Texture* tex, SDL_Surface* surf)
+{
+    SDL_Texture* sdlTex = SDL_CreateTextureFromSurface(mRenderer, surf);
+    if (!sdlTex) {
+        std::cerr << "*** Failed to create texture '" << tex->GetName() << "': " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    tex->mTex = sdlTex;
+    tex->mOwnsTex = true;
+    tex->mRegion = Rect(0, 0, surf->w, surf->h);
+
+    return true;
+}
+
+/*
+================================================================================
+
 TextureManager::GetTexture
 
     Returns a pointer to the Texture with the specified name.
@@ -507,9 +1154,9 @@ TextureManager::GetTexture
 */
 Texture* TextureManager::GetTexture(const std::string& name) const
 {
-    std::map<std::string, Texture*>::const_iterator it = mTextures.find(name);
-    if (it != mTextures.end()) {
-        return it->second;
+    std::map<std::string, TextureId>::const_iterator it = mIds.find(name);
+    if (it != mIds.end() && mTextures[it->second]) {
+        return mTextures[it->second];
     } else {
         std::cerr << "*** Oops, texture '" << name << "' not found" << std::endl;
         return mDefaultTex; // return the default texture instead of a NULL pointer :)
@@ -519,6 +1166,63 @@ Texture* TextureManager::GetTexture(const std::string& name) const
 /*
 ================================================================================
 
+TextureManager::InternTexture
+
+    Returns the id for the specified name, assigning the next free one if
+    the name hasn't been seen before.  The texture doesn't have to be loaded
+    yet (or ever); GetTexture returns the default texture for ids with
+    nothing loaded under them.
+
+================================================================================
+*/
+TextureId TextureManager::InternTexture(const std::string& name)
+{
+    std::map<std::string, TextureId>::iterator it = mIds.find(name);
+    if (it != mIds.end()) {
+        return it->second;
+    }
+
+    TextureId id = (TextureId)mTextures.size();
+    mIds[name] = id;
+    mTextures.push_back(NULL);
+
+    return id;
+}
+
+/*
+================================================================================
+
+TextureManager::Exists
+
+    Returns true if a texture is loaded under the specified name.
+
+================================================================================
+*/
+bool TextureManager::Exists(const std::string& name) const
+{
+    std::map<std::string, TextureId>::const_iterator it = mIds.find(name);
+    return it != mIds.end() && mTextures[it->second] != NULL;
+}
+
+/*
+================================================================================
+
+TextureManager::Register
+
+    Adds a new Texture to the lookup table, under its name's id.
+
+================================================================================
+*/
+void TextureManager::Register(Texture* tex)
+{
+    TextureId id = InternTexture(tex->GetName());
+    tex->mId = id;
+    mTextures[id] = tex;
+}
+
+/*
+================================================================================
+
 TextureManager::DeleteTexture
 
     Deletes the Texture with the specified name.
@@ -533,16 +1237,36 @@ TextureManager::DeleteTexture
 */
 void TextureManager::DeleteTexture(const std::string& name)
 {
-    std::map<std::string, Texture*>::iterator it = mTextures.find(name);
+    std::map<std::string, TextureId>::iterator it = mIds.find(name);
 
-    if (it != mTextures.end()) {
+    if (it != mIds.end() && mTextures[it->second]) {
 
         // delete the texture object
-        Texture* tex = it->second;
+        Texture* tex = mTextures[it->second];
+
+        // forget about it if it's still being decoded...
+        for (unsigned i = 0; i < mDecodeJobs.size(); i++) {
+            if (mDecodeJobs[i]->tex == tex) {
+                mDecodeJobs[i]->tex = NULL;
+            }
+            if (mDecodeJobs[i]->grayTex == tex) {
+                mDecodeJobs[i]->grayTex = NULL;
+            }
+        }
+
+        // ...or waiting to be packed
+        for (unsigned i = 0; i < mPending.size(); i++) {
+            if (mPending[i].tex == tex) {
+                SDL_FreeSurface(mPending[i].surf);
+                mPending.erase(mPending.begin() + i);
+                break;
+            }
+        }
+
         delete tex;
 
-        // remove the entry from the lookup table
-        mTextures.erase(it);
+        // remove the entry from the lookup table (the id stays reserved for the name)
+        mTextures[it->second] = NULL;
 
     } else {
         std::cerr << "*** Warning: Can't delete texture '" << name << "': texture not in lookup table" << std::endl;
@@ -583,21 +1307,41 @@ TextureManager::DeleteAll
     to a gameplay state).
 
     Note that this method doesn't delete the default texture, which the 
-    TextureManager keeps around until it gets shut down.
+    TextureManager keeps around until it gets shut down.  It does delete
+    the atlas pages, since every atlased texture is gone.
 
 ================================================================================
 */
 void TextureManager::DeleteAll()
 {
-    // delete each texture object in the lookup table
-    std::map<std::string, Texture*>::iterator it = mTextures.begin();
-    for ( ; it != mTextures.end(); ++it) {
-        Texture* tex = it->second;
-        delete tex;
+    // let the workers finish before pulling anything out from under them
+    if (!mDecodeJobs.empty()) {
+        mWorkers->Wait();
+        for (unsigned i = 0; i < mDecodeJobs.size(); i++) {
+            SDL_FreeSurface(mDecodeJobs[i]->surf);
+            SDL_FreeSurface(mDecodeJobs[i]->graySurf);
+            delete mDecodeJobs[i];
+        }
+        mDecodeJobs.clear();
     }
 
-    // clear the lookup table
-    mTextures.clear();
+    // delete each texture object in the lookup table (the names keep their ids)
+    for (unsigned i = 0; i < mTextures.size(); i++) {
+        delete mTextures[i];
+        mTextures[i] = NULL;
+    }
+
+    // drop anything that never made it into the atlas
+    for (unsigned i = 0; i < mPending.size(); i++) {
+        SDL_FreeSurface(mPending[i].surf);
+    }
+    mPending.clear();
+
+    // the atlas pages go last, since the textures were pointing into them
+    for (unsigned i = 0; i < mAtlasPages.size(); i++) {
+        SDL_DestroyTexture(mAtlasPages[i]);
+    }
+    mAtlasPages.clear();
 }
 
 /*
@@ -605,47 +1349,31 @@ void TextureManager::DeleteAll()
 
 TextureManager::Grayscale
 
-    This method will iterate through each of the pixels in the image surface and 
-	set all of its color components (r, g, b) to the average value of these
-	components.  This should effectively convert the image into grayscale.  Note,
-	howerver, that this algorithm only works for 24-bit and 32-bit surfaces.
+    Converts a 32-bit ARGB surface to grayscale in place, keeping its alpha.
+    The actual work is done by GrayscaleARGB8888, which uses SIMD when it
+    can.  Returns nonzero if the surface is in some other format.
 
 ================================================================================
 */
 int TextureManager::Grayscale(SDL_Surface *image)
 {
-	Uint8 colorDepth = image->format->BytesPerPixel;
-	// Not enought color information
-	if (colorDepth < 3)
+	if (image->format->format != SDL_PIXELFORMAT_ARGB8888)
 	{
 		return 1;
 	}
-	//If the surface must be locked
-    if( SDL_MUSTLOCK( image ) )
-    {
-		//Lock the surface
-        SDL_LockSurface( image );
-    }
-	unsigned bytes = image->w * image->h * colorDepth;
-    Uint8 *pixels = (Uint8 *)image->pixels;
-	Uint8 r, g, b;
-	for (int i = 0; i < bytes; i += colorDepth)
-	{
-		r = pixels[i];
-		g = pixels[i+1];
-		b = pixels[i+2];
-		pixels[i] = (r + g + b) / 3;
-		pixels[i+1] = (r + g + b) / 3;
-		pixels[i+2] = (r + g + b) / 3;
-	}
 
-    if( SDL_MUSTLOCK( image ) )
-    {
-		//Unlock surface
-        SDL_UnlockSurface( image );
+    if (SDL_MUSTLOCK(image)) {
+        SDL_LockSurface(image);
+    }
+
+    Uint8* pixels = (Uint8*)image->pixels;
+    GrayscaleARGB8888(pixels, image->pitch, pixels, image->pitch, image->w, image->h);
+
+    if (SDL_MUSTLOCK(image)) {
+        SDL_UnlockSurface(image);
     }
 
     return 0;
 }
 
-} // end namespace
\ No newline at end of file
+} // end namespace
@@ -4,13 +4,35 @@
 #include <SDL.h>
 #include <string>
 #include <map>
+#include <vector>
 #include <SDL_ttf.h>
 
+#include "GG_AssetPack.h"
+#include "GG_Common.h"
+#include "GG_Text.h"
+#include "GG_ThreadPool.h"
+
 namespace GG {
 
 /*
 ================================================================================
 
+TextureId
+
+    A dense integer handle for a texture name, handed out by the
+    TextureManager.  Looking a texture up by id is just an array index.
+
+================================================================================
+*/
+typedef int TextureId;
+
+enum {
+    INVALID_TEXTURE_ID = -1
+};
+
+/*
+================================================================================
+
 Image class
 
     This class is used to store raw image data in memory.  Internally, it
@@ -98,13 +120,25 @@ Texture class
     object becomes responsible for deleting the SDL_Texture, which happens
     in the destructor.
 
+    Textures that were packed into an atlas page by the TextureManager are
+    the exception.  They only occupy a region of a shared SDL_Texture that
+    the TextureManager owns, so they don't delete anything.  The region is
+    where the texture's pixels live inside the SDL_Texture returned by
+    GetPtr.  For stand-alone textures, the region covers the whole thing.
+
 ================================================================================
 */
 class Texture {
 
+    friend class TextureManager;
+
     std::string             mName;          // unique string identifier
+    TextureId               mId;            // the name's handle, assigned when the TextureManager registers it
 
     SDL_Texture*            mTex;           // pointer to texture implementation
+    bool                    mOwnsTex;       // false if mTex is a shared atlas page
+
+    Rect                    mRegion;        // where the texture lives within mTex
 
     int                     mWidth;
     int                     mHeight;
@@ -117,12 +151,17 @@ class Texture {
 public:
                             Texture(const std::string& name, SDL_Texture* tex);  // create a single-cell texture
                             Texture(const std::string& name, SDL_Texture* tex, int numCells);  // create a multi-cell texture
+                            Texture(const std::string& name, int width, int height, int numCells);  // create a texture awaiting atlas placement
                             ~Texture();
 
     const std::string&      GetName() const         { return mName; }
+    TextureId               GetId() const           { return mId; }
 
     SDL_Texture*            GetPtr() const          { return mTex; }
 
+    const Rect&             GetRegion() const       { return mRegion; }
+    bool                    IsAtlased() const       { return mTex && !mOwnsTex; }
+
     int                     GetWidth() const        { return mWidth; }
     int                     GetHeight() const       { return mHeight; }
 
@@ -157,6 +196,14 @@ TextureManager
     game logic layers from the itty-gritty details of where the textures come
     from and how they are loaded.
 
+    Each name is also interned as a TextureId, the first time it's seen
+    (by InternTexture, or when a texture gets loaded under it).  Getting a
+    texture by id is much cheaper than by name, so anything that looks up
+    textures often should hold on to ids.  Ids stay valid when textures are
+    deleted, and a texture loaded again under the same name gets the same
+    id.  Interning a set of names up front, in a fixed order, gives them
+    ids that are known at compile time.
+
     If a client requests a non-existing texture, the texture manager will
     return a pointer to a default texture, which it generates procedurally
     during initialization.  This is better than just returning NULL pointers,
@@ -169,17 +216,73 @@ TextureManager
     and is solely responsible for deleting them.  In other words, no one else
     should be deleting the Texture objects that the TextureManager returns.
 
+    Textures loaded between BeginAtlas and EndAtlas are packed into a few
+    large atlas pages instead of getting an SDL_Texture each, so that a
+    frame can be drawn without switching textures all the time.  The
+    Texture objects are handed out right away, but they can't be drawn
+    until EndAtlas has packed and uploaded the pages.  Images too large
+    to fit on a page get a texture of their own.
+
+    If BeginAtlas is given a ThreadPool, the files are decoded on its
+    threads, and LoadTexture only queues the work.  The Textures it returns
+    don't even know their size until EndAtlas, which waits for the decoding
+    to finish before packing.  Only the uploads happen on the calling
+    thread, since the renderer can't be used from anywhere else.
+
+    Most textures come in a color and a grayscale version.  LoadTexturePair
+    creates both from a single decode of the file.
+
+    LoadPackedTexture loads an image from an asset pack.  The pixels are
+    already decoded, so they go to the renderer (or the atlas) straight
+    from the mapped file.  The pack must stay open until EndAtlas.
+
+    The TextureManager also builds a GlyphAtlas from its font during
+    initialization.  Drawing text with it is much cheaper than creating a
+    texture for each string with the text overload of LoadTexture.
+
+    A TextureManager initialized without a renderer is headless: images
+    still get loaded (or read from the pack) to find out their sizes, but
+    the Textures it hands out only have sizes and cells, and GetPtr
+    returns NULL for all of them.
+
 ================================================================================
 */
 class TextureManager {
 
+    struct PendingImage {
+        Texture*            tex;
+        SDL_Surface*        surf;           // converted copy, owned until packed
+    };
+
+    struct DecodeJob {
+        std::string         path;
+        bool                grayscale;      // convert the image itself to grayscale
+        bool                makeGrayCopy;   // also produce a grayscale copy
+        Texture*            tex;            // placeholders waiting for the pixels
+        Texture*            grayTex;
+        SDL_Surface*        surf;           // results, filled in by a worker
+        SDL_Surface*        graySurf;
+        std::string         error;
+        Uint64              ticks;          // time spent decoding
+    };
+
     SDL_Renderer*           mRenderer;
     std::string             mRootDir;
 
-    std::map<std::string, Texture*> mTextures;
+    std::map<std::string, TextureId> mIds;  // interned names
+    std::vector<Texture*>   mTextures;      // indexed by id, NULL if not loaded
+
+    bool                    mBuildingAtlas;
+    std::vector<PendingImage>   mPending;
+    std::vector<SDL_Texture*>   mAtlasPages;
+
+    ThreadPool*             mWorkers;       // decodes files while building an atlas, if not NULL
+    std::vector<DecodeJob*> mDecodeJobs;
+    Uint64                  mDecodeStart;
 
     Texture*                mDefaultTex;
 	TTF_Font*				font;
+    GlyphAtlas*             mGlyphAtlas;    // the font's glyphs, pre-rendered for drawing text
 
     Texture*                CreateDefaultTexture();
 
@@ -189,14 +292,28 @@ public:
 
     bool                    Initialize(SDL_Renderer* renderer, const std::string& rootDir);
 
+    bool                    IsHeadless() const              { return mRenderer == NULL; }
+
     Texture*                LoadTexture(const std::string& name, const std::string& filename, bool grayscale, int numCells = 1);
     Texture*                LoadTexture(const std::string& name, const Image& img, bool grayscale, int numCells = 1);
+    Texture*                LoadTexturePair(const std::string& name, const std::string& grayName, const std::string& filename, int numCells = 1);
 	Texture*				LoadTexture(const std::string& name, const char* text, SDL_Color text_color);
+    Texture*                LoadPackedTexture(const AssetPack& pack, const PackEntry& entry);
+
+    TextureId               InternTexture(const std::string& name);
 
     Texture*                GetTexture(const std::string& name) const;
+    Texture*                GetTexture(TextureId id) const;
 
     Texture*                GetDefaultTexture() const       { return mDefaultTex; }
 
+    const GlyphAtlas*       GetGlyphAtlas() const           { return mGlyphAtlas; }
+
+    void                    BeginAtlas(ThreadPool* workers = NULL);
+    bool                    EndAtlas();
+
+    int                     GetNumAtlasPages() const        { return (int)mAtlasPages.size(); }
+
     void                    DeleteTexture(const std::string& name);
     void                    DeleteTexture(Texture* tex);
 
@@ -204,8 +321,25 @@ public:
 
 private:
 	int						Grayscale(SDL_Surface *image);
+    bool                    UploadStandalone(Texture* tex, SDL_Surface* surf);
+    Texture*                AddTexture(const std::string& name, SDL_Surface* surf, int numCells);
+    bool                    Exists(const std::string& name) const;
+    void                    Register(Texture* tex);
+
+    Texture*                LoadFile(const std::string& name, const std::string& grayName, const std::string& filename, bool grayscale, int numCells);
+    static void             RunDecodeJob(DecodeJob* job);
+    void                    FinishDecodeJobs();
+    void                    AddPending(Texture* tex, SDL_Surface* surf);
 };
 
+inline Texture* TextureManager::GetTexture(TextureId id) const
+{
+    if ((unsigned)id < mTextures.size() && mTextures[id]) {
+        return mTextures[id];
+    }
+    return mDefaultTex;     // not loaded (or failed to load), which was already reported
+}
+
 } // end namespace
 
 #endif
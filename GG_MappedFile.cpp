@@ -0,0 +1,148 @@
+#include "GG_MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GG {
+
+/*
+================================================================================
+
+MappedFile constructor
+
+    Creates a MappedFile with nothing mapped.
+
+================================================================================
+*/
+MappedFile::MappedFile()
+    : mData(NULL)
+    , mSize(0)
+    , mFileHandle(NULL)
+    , mMapHandle(NULL)
+{
+}
+
+/*
+================================================================================
+
+MappedFile destructor
+
+    Unmaps the file, if there is one.
+
+================================================================================
+*/
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+/*
+================================================================================
+
+MappedFile::Open
+
+    Maps the file at the specified path, replacing whatever was mapped
+    before.  Empty files can't be mapped, so they count as failures.
+
+================================================================================
+*/
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMapHandle = mapping;
+    mData = (const Uint8*)data;
+    mSize = (size_t)size.QuadPart;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // the mapping keeps the file alive
+
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    mData = (const Uint8*)data;
+    mSize = (size_t)st.st_size;
+#endif
+
+    return true;
+}
+
+/*
+================================================================================
+
+MappedFile::Close
+
+    Unmaps the file.  Any pointers into the data are invalid afterwards.
+
+================================================================================
+*/
+void MappedFile::Close()
+{
+    if (!mData) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+    CloseHandle((HANDLE)mMapHandle);
+    CloseHandle((HANDLE)mFileHandle);
+#else
+    munmap((void*)mData, mSize);
+#endif
+
+    mData = NULL;
+    mSize = 0;
+    mFileHandle = NULL;
+    mMapHandle = NULL;
+}
+
+} // end namespace
@@ -0,0 +1,50 @@
+#ifndef GG_MAPPED_FILE_H_
+#define GG_MAPPED_FILE_H_
+
+#include <SDL.h>
+#include <string>
+
+namespace GG {
+
+/*
+================================================================================
+
+MappedFile class
+
+    Maps a whole file into memory, read only.  The operating system pages
+    the contents in as they get touched, so opening even a big file is
+    cheap, and if it was read recently, the pages are already in the file
+    cache and nothing has to come off the disk at all.
+
+    The data stays valid until Close is called or the MappedFile is
+    destroyed.
+
+================================================================================
+*/
+class MappedFile {
+
+    const Uint8*            mData;
+    size_t                  mSize;
+
+    void*                   mFileHandle;    // Windows only
+    void*                   mMapHandle;
+
+                            MappedFile(const MappedFile&);
+    MappedFile&             operator= (const MappedFile&);
+
+public:
+                            MappedFile();
+                            ~MappedFile();
+
+    bool                    Open(const std::string& path);
+    void                    Close();
+
+    bool                    IsOpen() const      { return mData != NULL; }
+
+    const Uint8*            GetData() const     { return mData; }
+    size_t                  GetSize() const     { return mSize; }
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,83 @@
+#include "GG_Memory.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<Uint64> sNumAllocations(0);
+
+namespace GG {
+
+Uint64 GetNumAllocations()
+{
+    return sNumAllocations.load(std::memory_order_relaxed);
+}
+
+} // end namespace
+
+//
+// The replacements.  Every form of operator new and delete forwards to the
+// first two, so all allocations get counted the same way, whichever form
+// the compiler picks (like the sized deletes of C++14, or the nothrow
+// versions).
+//
+
+void* operator new(size_t size)
+{
+    sNumAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* p) throw()
+{
+    operator delete(p);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw()
+{
+    try {
+        return operator new(size);
+    } catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw()
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw()
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) throw()
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) throw()
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) throw()
+{
+    operator delete(p);
+}
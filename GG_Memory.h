@@ -0,0 +1,29 @@
+#ifndef GG_MEMORY_H_
+#define GG_MEMORY_H_
+
+#include <SDL.h>
+
+namespace GG {
+
+/*
+================================================================================
+
+Allocation counting
+
+    GG_Memory.cpp replaces the global operator new and delete with versions
+    that count calls on their way to malloc and free.  GetNumAllocations
+    returns how many times operator new has been called since the program
+    started (on any thread), so the difference between two calls says how
+    many allocations happened in between.  Counting costs one atomic
+    increment per allocation.
+
+    Only allocations that go through new are counted (which includes the
+    standard containers), not the ones SDL makes with malloc.
+
+================================================================================
+*/
+Uint64 GetNumAllocations();
+
+} // end namespace
+
+#endif
@@ -0,0 +1,111 @@
+#include "GG_Pixels.h"
+#include "GG_Cpu.h"
+
+#ifdef GG_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+namespace GG {
+
+// luminance weights in 8.8 fixed point (they add up to 256)
+static const int WEIGHT_R = 77;
+static const int WEIGHT_G = 150;
+static const int WEIGHT_B = 29;
+
+static inline Uint32 GrayPixel(Uint32 p)
+{
+    Uint32 b = p & 0xFF;
+    Uint32 g = (p >> 8) & 0xFF;
+    Uint32 r = (p >> 16) & 0xFF;
+    Uint32 y = (WEIGHT_R * r + WEIGHT_G * g + WEIGHT_B * b + 128) >> 8;
+    return (p & 0xFF000000) | (y * 0x010101);
+}
+
+static void GrayscaleRowScalar(const Uint32* src, Uint32* dst, int width)
+{
+    for (int x = 0; x < width; x++) {
+        dst[x] = GrayPixel(src[x]);
+    }
+}
+
+#ifdef GG_X86
+
+//
+// The vector versions do the same math on 4 (SSE2) or 8 (AVX2) pixels at
+// a time.  Masking out G and A leaves B and R in the low and high 16 bits
+// of each pixel, so a single multiply-add weighs both of them.  G gets
+// shifted down and weighed with a second multiply-add.
+//
+
+GG_TARGET_SSE2
+static void GrayscaleRowSSE2(const Uint32* src, Uint32* dst, int width)
+{
+    const __m128i maskRB = _mm_set1_epi32(0x00FF00FF);
+    const __m128i maskG = _mm_set1_epi32(0x000000FF);
+    const __m128i maskA = _mm_set1_epi32((int)0xFF000000);
+    const __m128i weightsRB = _mm_set1_epi32((WEIGHT_R << 16) | WEIGHT_B);
+    const __m128i weightG = _mm_set1_epi32(WEIGHT_G);
+    const __m128i half = _mm_set1_epi32(128);
+
+    int x = 0;
+    for ( ; x + 4 <= width; x += 4) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(src + x));
+
+        __m128i rb = _mm_madd_epi16(_mm_and_si128(p, maskRB), weightsRB);
+        __m128i g = _mm_madd_epi16(_mm_and_si128(_mm_srli_epi32(p, 8), maskG), weightG);
+        __m128i y = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(rb, g), half), 8);
+
+        __m128i gray = _mm_or_si128(_mm_or_si128(y, _mm_slli_epi32(y, 8)), _mm_slli_epi32(y, 16));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_or_si128(gray, _mm_and_si128(p, maskA)));
+    }
+
+    GrayscaleRowScalar(src + x, dst + x, width - x);
+}
+
+GG_TARGET_AVX2
+static void GrayscaleRowAVX2(const Uint32* src, Uint32* dst, int width)
+{
+    const __m256i maskRB = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i maskG = _mm256_set1_epi32(0x000000FF);
+    const __m256i maskA = _mm256_set1_epi32((int)0xFF000000);
+    const __m256i weightsRB = _mm256_set1_epi32((WEIGHT_R << 16) | WEIGHT_B);
+    const __m256i weightG = _mm256_set1_epi32(WEIGHT_G);
+    const __m256i half = _mm256_set1_epi32(128);
+
+    int x = 0;
+    for ( ; x + 8 <= width; x += 8) {
+        __m256i p = _mm256_loadu_si256((const __m256i*)(src + x));
+
+        __m256i rb = _mm256_madd_epi16(_mm256_and_si256(p, maskRB), weightsRB);
+        __m256i g = _mm256_madd_epi16(_mm256_and_si256(_mm256_srli_epi32(p, 8), maskG), weightG);
+        __m256i y = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(rb, g), half), 8);
+
+        __m256i gray = _mm256_or_si256(_mm256_or_si256(y, _mm256_slli_epi32(y, 8)), _mm256_slli_epi32(y, 16));
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_or_si256(gray, _mm256_and_si256(p, maskA)));
+    }
+
+    GrayscaleRowScalar(src + x, dst + x, width - x);
+}
+
+#endif
+
+void GrayscaleARGB8888(const Uint8* src, int srcPitch, Uint8* dst, int dstPitch, int width, int height)
+{
+    typedef void (*RowFunc)(const Uint32*, Uint32*, int);
+
+    RowFunc row = GrayscaleRowScalar;
+#ifdef GG_X86
+    switch (GetSimdLevel()) {
+    case SIMD_AVX2: row = GrayscaleRowAVX2; break;
+    case SIMD_SSE2: row = GrayscaleRowSSE2; break;
+    default:        break;
+    }
+#endif
+
+    for (int y = 0; y < height; y++) {
+        row((const Uint32*)(src + y * srcPitch), (Uint32*)(dst + y * dstPitch), width);
+    }
+}
+
+} // end namespace
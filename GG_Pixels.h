@@ -0,0 +1,30 @@
+#ifndef GG_PIXELS_H_
+#define GG_PIXELS_H_
+
+#include <SDL.h>
+
+namespace GG {
+
+/*
+================================================================================
+
+GrayscaleARGB8888
+
+    Converts ARGB8888 pixels to grayscale, using the usual luminance
+    weights (0.299 R + 0.587 G + 0.114 B, in 8.8 fixed point).  Alpha is
+    left as it is.
+
+    The source and destination each have their own pitch (bytes per row),
+    and they may be the same buffer to convert in place.
+
+    The work is done with AVX2 or SSE2 when the CPU has them (see
+    GetSimdLevel), falling back to plain C++ otherwise.  All paths produce
+    exactly the same result.
+
+================================================================================
+*/
+void GrayscaleARGB8888(const Uint8* src, int srcPitch, Uint8* dst, int dstPitch, int width, int height);
+
+} // end namespace
+
+#endif
@@ -0,0 +1,233 @@
+#include "GG_Profiler.h"
+#include "GG_Common.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+namespace GG {
+
+std::atomic<bool> Profiler::sEnabled(false);
+
+static GG_THREAD_LOCAL ProfileThread* sThisThread = NULL;
+static GG_THREAD_LOCAL const char* sThisThreadName = NULL;
+
+// every thread that ever recorded anything
+static std::mutex sThreadsMutex;
+static std::vector<ProfileThread*> sThreads;
+
+/*
+================================================================================
+
+ProfileThread constructor
+
+================================================================================
+*/
+ProfileThread::ProfileThread(Uint32 threadId)
+    : mWritePos(0)
+    , mReadPos(0)
+    , mThreadId(threadId)
+    , mDepth(0)
+    , mNumDropped(0)
+    , mName(NULL)
+{ }
+
+/*
+================================================================================
+
+Profiler::GetThread
+
+    Returns the calling thread's buffer, making one the first time.  Only
+    that first call takes a lock.
+
+================================================================================
+*/
+ProfileThread* Profiler::GetThread()
+{
+    if (!sThisThread) {
+        std::lock_guard<std::mutex> lock(sThreadsMutex);
+        sThisThread = new ProfileThread((Uint32)sThreads.size());
+        sThisThread->mName = sThisThreadName;
+        sThreads.push_back(sThisThread);
+    }
+    return sThisThread;
+}
+
+/*
+================================================================================
+
+Profiler::SetThreadName
+
+    The name must live forever, like zone names.
+
+================================================================================
+*/
+void Profiler::SetThreadName(const char* name)
+{
+    sThisThreadName = name;
+
+    if (sThisThread) {
+        std::lock_guard<std::mutex> lock(sThreadsMutex);
+        sThisThread->mName = name;
+    }
+}
+
+/*
+================================================================================
+
+Profiler::GetThreadNames
+
+    Replaces the contents of names with the name of every thread that has
+    recorded anything, indexed by thread id.  Unnamed threads get NULL.
+
+================================================================================
+*/
+void Profiler::GetThreadNames(std::vector<const char*>* names)
+{
+    std::lock_guard<std::mutex> lock(sThreadsMutex);
+
+    names->resize(sThreads.size());
+    for (size_t t = 0; t < sThreads.size(); t++) {
+        (*names)[t] = sThreads[t]->mName;
+    }
+}
+
+/*
+================================================================================
+
+Profiler::Collect
+
+================================================================================
+*/
+void Profiler::Collect(std::vector<ProfileEvent>* events)
+{
+    std::lock_guard<std::mutex> lock(sThreadsMutex);
+
+    for (size_t t = 0; t < sThreads.size(); t++) {
+        ProfileThread* thread = sThreads[t];
+
+        Uint32 begin = thread->mReadPos.load(std::memory_order_relaxed);
+        Uint32 end = thread->mWritePos.load(std::memory_order_acquire);
+        for (Uint32 pos = begin; pos != end; pos++) {
+            events->push_back(thread->mEvents[pos & (ProfileThread::CAPACITY - 1)]);
+        }
+
+        // hand the slots back to the writer
+        thread->mReadPos.store(end, std::memory_order_release);
+    }
+}
+
+/*
+================================================================================
+
+Profiler::GetNumDropped
+
+    Returns how many events have been dropped so far, on all threads,
+    because Collect wasn't called often enough.
+
+================================================================================
+*/
+Uint32 Profiler::GetNumDropped()
+{
+    std::lock_guard<std::mutex> lock(sThreadsMutex);
+
+    Uint32 numDropped = 0;
+    for (size_t t = 0; t < sThreads.size(); t++) {
+        numDropped += sThreads[t]->mNumDropped.load(std::memory_order_relaxed);
+    }
+    return numDropped;
+}
+
+/*
+================================================================================
+
+ProfileSummary::Add
+
+================================================================================
+*/
+void ProfileSummary::Add(const std::vector<ProfileEvent>& events)
+{
+    for (size_t i = 0; i < events.size(); i++) {
+        const ProfileEvent& e = events[i];
+        Uint64 ticks = e.end - e.start;
+
+        Zone* zone = const_cast<Zone*>(FindZone(e.name));
+        if (!zone) {
+            Zone newZone;
+            newZone.name = e.name;
+            newZone.totalTicks = 0;
+            newZone.maxTicks = 0;
+            newZone.count = 0;
+            mZones.push_back(newZone);
+            zone = &mZones.back();
+        }
+
+        zone->totalTicks += ticks;
+        zone->maxTicks = ticks > zone->maxTicks ? ticks : zone->maxTicks;
+        zone->count++;
+    }
+}
+
+/*
+================================================================================
+
+ProfileSummary::FindZone
+
+    Returns NULL if no events with that name were added.
+
+================================================================================
+*/
+const ProfileSummary::Zone* ProfileSummary::FindZone(const char* name) const
+{
+    for (size_t z = 0; z < mZones.size(); z++) {
+        if (mZones[z].name == name || std::strcmp(mZones[z].name, name) == 0) {
+            return &mZones[z];
+        }
+    }
+    return NULL;
+}
+
+/*
+================================================================================
+
+ProfileSummary::Print
+
+    Prints each zone's average time per frame, the average and worst time
+    per call, and how many calls there were.
+
+================================================================================
+*/
+void ProfileSummary::Print(int numFrames) const
+{
+    if (numFrames < 1) {
+        numFrames = 1;
+    }
+
+    std::cout << "*** Profile over " << numFrames << " frames (ms)" << std::endl;
+    std::cout << "*** " << std::left << std::setw(24) << "zone"
+              << std::right << std::setw(10) << "per frame"
+              << std::setw(10) << "per call"
+              << std::setw(10) << "worst"
+              << std::setw(10) << "calls" << std::endl;
+
+    for (size_t z = 0; z < mZones.size(); z++) {
+        const Zone& zone = mZones[z];
+        double totalMs = TicksToNs(zone.totalTicks) * 1e-6;
+
+        std::cout << "*** " << std::left << std::setw(24) << zone.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << totalMs / numFrames
+                  << std::setw(10) << totalMs / zone.count
+                  << std::setw(10) << TicksToNs(zone.maxTicks) * 1e-6
+                  << std::setw(10) << zone.count << std::endl;
+    }
+
+    std::cout.unsetf(std::ios::fixed);
+
+    Uint32 numDropped = Profiler::GetNumDropped();
+    if (numDropped > 0) {
+        std::cout << "*** (" << numDropped << " events were dropped)" << std::endl;
+    }
+}
+
+} // end namespace
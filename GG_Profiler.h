@@ -0,0 +1,246 @@
+#ifndef GG_PROFILER_H_
+#define GG_PROFILER_H_
+
+#include <SDL.h>
+
+#include "GG_Timer.h"
+
+#include <atomic>
+#include <vector>
+
+/*
+================================================================================
+
+Profiling zones
+
+    GG_PROFILE_SCOPE("Update.Crawlers") times everything from that line to
+    the end of the enclosing block, and records it as one event:
+
+        void Game::UpdateCrawlers(float dt)
+        {
+            GG_PROFILE_SCOPE("Update.Crawlers");
+            ...
+        }
+
+    The name must be a string literal (or anything else that lives
+    forever), since only the pointer gets stored.  Zones can nest, and each
+    event remembers how deep it was.
+
+    Nothing gets recorded unless Profiler::SetEnabled(true) was called.
+    When it's off, a zone costs a check of one flag.  When it's on, it
+    costs two counter reads and a store into the thread's own buffer, with
+    no locks.  Building with GG_ENABLE_PROFILER set to 0 compiles the zones
+    out entirely.
+
+================================================================================
+*/
+#ifndef GG_ENABLE_PROFILER
+#define GG_ENABLE_PROFILER 1
+#endif
+
+#define GG_PROFILE_CONCAT2(a, b)    a ## b
+#define GG_PROFILE_CONCAT(a, b)     GG_PROFILE_CONCAT2(a, b)
+
+#if GG_ENABLE_PROFILER
+#define GG_PROFILE_SCOPE(name)      GG::ProfileScope GG_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define GG_PROFILE_SCOPE(name)
+#endif
+
+namespace GG {
+
+/*
+================================================================================
+
+ProfileEvent struct
+
+    One finished zone.  The times are performance counter ticks (see
+    GetTicks), which only mean something relative to each other.
+
+================================================================================
+*/
+struct ProfileEvent {
+    const char*             name;
+    Uint64                  start;
+    Uint64                  end;
+    Uint32                  threadId;       // 0 for the first thread that recorded anything, and so on
+    Uint32                  depth;          // 0 for outermost zones
+};
+
+/*
+================================================================================
+
+ProfileThread class
+
+    Each thread that records zones gets one of these, the first time it
+    does.  It holds a ring buffer of events, with one writer (the thread
+    itself) and one reader (whoever calls Profiler::Collect), so the two
+    only need a pair of atomic counters to stay out of each other's way.
+
+    If the reader falls behind and the buffer fills up, new events get
+    dropped (and counted) rather than overwriting ones that haven't been
+    read yet.
+
+================================================================================
+*/
+class ProfileThread {
+
+public:
+    static const Uint32     CAPACITY = 8192;        // a power of two
+
+private:
+    ProfileEvent            mEvents[CAPACITY];
+    std::atomic<Uint32>     mWritePos;      // only the owning thread changes this
+    std::atomic<Uint32>     mReadPos;       // only the reader changes this
+    Uint32                  mThreadId;
+    Uint32                  mDepth;
+    std::atomic<Uint32>     mNumDropped;
+    const char*             mName;          // NULL until SetThreadName
+
+    friend class Profiler;
+
+public:
+    explicit                ProfileThread(Uint32 threadId);
+
+    Uint32                  GetThreadId() const     { return mThreadId; }
+
+    Uint32                  EnterScope()            { return mDepth++; }
+
+    void                    LeaveScope(const char* name, Uint64 start, Uint64 end)
+    {
+        mDepth--;
+
+        Uint32 pos = mWritePos.load(std::memory_order_relaxed);
+        if (pos - mReadPos.load(std::memory_order_acquire) >= CAPACITY) {
+            mNumDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        ProfileEvent& e = mEvents[pos & (CAPACITY - 1)];
+        e.name = name;
+        e.start = start;
+        e.end = end;
+        e.threadId = mThreadId;
+        e.depth = mDepth;
+
+        // publish it only once it's all written
+        mWritePos.store(pos + 1, std::memory_order_release);
+    }
+};
+
+/*
+================================================================================
+
+Profiler class
+
+    Turns recording on and off, and gathers up what all the threads have
+    recorded.  Everything is static; there's only one profiler.
+
+    Collect appends the events recorded since the last Collect, from every
+    thread, and is meant to be called from one thread only (normally the
+    main thread, once a frame).  Events from each thread come out in the
+    order they finished, so inner zones come before the zones around them.
+
+    Threads never unregister, so their buffers (about 256 KB each) stay
+    around until the program exits.  That's fine for a fixed set of
+    long-lived threads like the main thread and the thread pool workers.
+
+    SetThreadName gives the calling thread a name for tools like the trace
+    export to show.  It doesn't create a buffer, so threads can name
+    themselves up front without costing anything if they never record.
+
+================================================================================
+*/
+class Profiler {
+    static std::atomic<bool>    sEnabled;
+
+public:
+    static void             SetEnabled(bool enabled)    { sEnabled.store(enabled, std::memory_order_relaxed); }
+    static bool             IsEnabled()                 { return sEnabled.load(std::memory_order_relaxed); }
+
+    static ProfileThread*   GetThread();
+
+    static void             SetThreadName(const char* name);
+    static void             GetThreadNames(std::vector<const char*>* names);
+
+    static void             Collect(std::vector<ProfileEvent>* events);
+
+    static Uint32           GetNumDropped();
+};
+
+/*
+================================================================================
+
+ProfileScope class
+
+    What GG_PROFILE_SCOPE makes: it notes the time when it's created, and
+    records the event when it goes out of scope.
+
+================================================================================
+*/
+class ProfileScope {
+    const char*             mName;
+    ProfileThread*          mThread;        // NULL if the profiler was off
+    Uint64                  mStart;
+
+                            ProfileScope(const ProfileScope&);
+    ProfileScope&           operator= (const ProfileScope&);
+
+public:
+    explicit ProfileScope(const char* name)
+        : mName(name)
+        , mThread(NULL)
+        , mStart(0)
+    {
+        if (Profiler::IsEnabled()) {
+            mThread = Profiler::GetThread();
+            mThread->EnterScope();
+            mStart = GetTicks();
+        }
+    }
+
+    ~ProfileScope()
+    {
+        if (mThread) {
+            mThread->LeaveScope(mName, mStart, GetTicks());
+        }
+    }
+};
+
+/*
+================================================================================
+
+ProfileSummary class
+
+    Adds up the time spent in each zone over many events, and prints a
+    table of them.  Zones with the same name count as the same zone, even
+    if they're recorded in different places or on different threads.
+
+================================================================================
+*/
+class ProfileSummary {
+
+public:
+    struct Zone {
+        const char*         name;
+        Uint64              totalTicks;
+        Uint64              maxTicks;
+        Uint32              count;
+    };
+
+private:
+    std::vector<Zone>       mZones;         // in order of first appearance
+
+public:
+    void                    Add(const std::vector<ProfileEvent>& events);
+    void                    Clear()                 { mZones.clear(); }
+
+    const std::vector<Zone>& GetZones() const       { return mZones; }
+    const Zone*             FindZone(const char* name) const;
+
+    void                    Print(int numFrames) const;
+};
+
+} // end namespace
+
+#endif
@@ -1,109 +1,91 @@
 #include "GG_Renderable.h"
+#include "GG_Cpu.h"
 
 #include <cmath>
 
+#ifdef GG_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
 namespace GG {
 
 /*
 ================================================================================
 
-Renderable constructor (non-animated)
+Renderable constructor (empty)
 
-    This constructor creates a static (non-animated) renderable using the
-    entire specified texture.
+    This constructor creates a renderable with no clip, to be assigned
+    a real one later.
 
 ================================================================================
 */
-Renderable::Renderable(const Texture* tex, const Texture* grayTex)
-    : mTex(tex)
-	, mGrayscaleTex(grayTex)
-	, mGrayscale(false)
-    , mNumFrames(1)
-    , mDuration(0.0f)
-    , mLoopable(false)
+Renderable::Renderable()
+    : mClip(NULL)
     , mTime(0.0f)
-    , mFrameRect()
-	, mRotAngle(0.0)
-	, mRotOrigin()
+    , mFrame(0)
+	, mGrayscale(false)
 {
-    // set the frame rect to cover the entire texture
-    if (tex) {
-        mFrameRect.x = 0;
-        mFrameRect.y = 0;
-        mFrameRect.w = tex->GetWidth();
-        mFrameRect.h = tex->GetHeight();
-		// set rotation origin to rect centroid by default
-        mRotOrigin.x = mFrameRect.w / 2;
-        mRotOrigin.y = mFrameRect.h / 2;
-    }
 }
 
 /*
 ================================================================================
 
-Renderable constructor (non-animated)
+Renderable constructor
 
-    This constructor creates a static (non-animated) renderable using the
-    specified cell index in the texture.
+    This constructor creates a renderable showing the specified clip,
+    from the beginning for animated clips, or on the specified frame (the
+    cell in the sprite sheet) for stills.
 
 ================================================================================
 */
-Renderable::Renderable(const Texture* tex, const Texture* grayscaleTex, int cellNo)
-    : mTex(tex)
-	, mGrayscaleTex(grayscaleTex)
-	, mGrayscale(false)
-    , mNumFrames(1)
-    , mDuration(0.0f)
-    , mLoopable(false)
+Renderable::Renderable(const AnimationClip* clip, int frame)
+    : mClip(clip)
     , mTime(0.0f)
-    , mFrameRect()
-	, mRotAngle(0.0)
-    , mRotOrigin()
+    , mFrame((Uint16)frame)
+	, mGrayscale(false)
 {
-    // set the frame rect to the specified cell
-    if (tex) {
-        mFrameRect.x = cellNo * tex->GetCellWidth();
-        mFrameRect.y = 0;
-        mFrameRect.w = tex->GetCellWidth();
-        mFrameRect.h = tex->GetCellHeight();
-		// set rotation origin to rect centroid by default
-        mRotOrigin.x = mFrameRect.w / 2;
-        mRotOrigin.y = mFrameRect.h / 2;
+}
+
+/*
+================================================================================
+
+Renderable::GetFrameRect
+
+    Returns the current frame rect (the cell in the sprite sheet).
+
+================================================================================
+*/
+Rect Renderable::GetFrameRect() const
+{
+    if (!mClip) {
+        return Rect();
     }
+    return Rect(mFrame * mClip->frameWidth, 0, mClip->frameWidth, mClip->frameHeight);
 }
 
 /*
 ================================================================================
 
-Renderable constructor (animated)
+Renderable::GetSourceRect
 
-    This constructor creates an animated renderable using all the cells in the
-    specified texture.
+    Returns the current frame rect offset by the texture's region, i.e. the
+    rect to copy from the SDL_Texture.  Color and grayscale textures are
+    packed in different spots, so the caller says which one it wants.
 
 ================================================================================
 */
-Renderable::Renderable(const Texture* tex, const Texture* grayscaleTex, float duration, bool loopable)
-    : mTex(tex)
-	, mGrayscaleTex(grayscaleTex)
-	, mGrayscale(false)
-    , mNumFrames(tex->GetNumCells())
-    , mDuration(duration)
-    , mLoopable(loopable)
-    , mTime(0.0f)
-    , mFrameRect()
-	, mRotAngle(0.0)
-    , mRotOrigin()
+Rect Renderable::GetSourceRect(bool grayscale) const
 {
-    // set the frame rect to be the first cell in the texture
+    Rect src = GetFrameRect();
+
+    const Texture* tex = GetTexture(grayscale);
     if (tex) {
-        mFrameRect.x = 0;
-        mFrameRect.y = 0;
-        mFrameRect.w = tex->GetCellWidth();
-        mFrameRect.h = tex->GetCellHeight();
-		// set rotation origin to rect centroid by default
-        mRotOrigin.x = mFrameRect.w / 2;
-        mRotOrigin.y = mFrameRect.h / 2;
+        src.x += tex->GetRegion().x;
+        src.y += tex->GetRegion().y;
     }
+
+    return src;
 }
 
 /*
@@ -114,8 +96,8 @@ Renderable::Animate
     This method can be used to advance the time position of animated renderables
     by the specified time interval (in seconds).
 
-    The method also takes care of animation looping logic and updating the
-    frame rect to correspond with the current cell in the sprite sheet texture.
+    The method also takes care of animation looping logic and picking the
+    frame that goes with the new time position.
 
 ================================================================================
 */
@@ -125,34 +107,465 @@ void Renderable::Animate(float dt)
         return;
     }
 
+    float duration = mClip->duration;
+    int numFrames = mClip->numFrames;
+
     // update time position
     mTime += dt;
 
     // see if we've reached or passed the end
-    if (mTime >= mDuration) {
-        if (mLoopable) {
+    if (mTime >= duration) {
+        if (mClip->loopable) {
             // wrap around
-            mTime = std::fmod(mTime, mDuration);
+            mTime = std::fmod(mTime, duration);
         } else {
             // cap
-            mTime = mDuration;
+            mTime = duration;
         }
     }
 
     // figure out which frame we're on
-    int frameNo;
-
-    if (mTime < mDuration) {
+    if (mTime < duration) {
         // select a frame based on time position
-        float progress = mTime / mDuration;         // 0.0 <= progress < 1.0
-        frameNo = (int)(mNumFrames * progress);     // 0 <= frameNo < mNumFrames
+        float progress = mTime / duration;                  // 0.0 <= progress < 1.0
+        mFrame = (Uint16)(int)(numFrames * progress);       // 0 <= frame < numFrames
     } else {
         // use last frame
-        frameNo = mNumFrames - 1;
+        mFrame = (Uint16)(numFrames - 1);
+    }
+}
+
+/*
+================================================================================
+
+RenderableArray constructor
+
+    Creates an empty array.  Set the clip library before adding slots.
+
+================================================================================
+*/
+RenderableArray::RenderableArray()
+    : mClips(NULL)
+    , mClock(NULL)
+    , mNumSynced(0)
+{
+}
+
+/*
+================================================================================
+
+RenderableArray::ConstSlot::GetFrame
+
+    Returns the frame the slot is on, which synced slots get from the
+    clock.
+
+================================================================================
+*/
+int RenderableArray::ConstSlot::GetFrame() const
+{
+    int phase = mArray->mPhase[mIndex];
+    if (phase == NOT_SYNCED) {
+        return mArray->mFrame[mIndex];
+    }
+    return mArray->mClock->GetFrame(mArray->mClip[mIndex], phase);
+}
+
+/*
+================================================================================
+
+RenderableArray::ConstSlot::GetTime
+
+    Returns how far into its clip the slot is, in seconds.
+
+================================================================================
+*/
+float RenderableArray::ConstSlot::GetTime() const
+{
+    int phase = mArray->mPhase[mIndex];
+    if (phase == NOT_SYNCED) {
+        return mArray->mTime[mIndex];
+    }
+    return mArray->mClock->GetTime(mArray->mClip[mIndex], phase);
+}
+
+/*
+================================================================================
+
+RenderableArray::ConstSlot::GetFrameRect
+
+    Returns the current frame rect (the cell in the sprite sheet).
+
+================================================================================
+*/
+Rect RenderableArray::ConstSlot::GetFrameRect() const
+{
+    const AnimationClip& clip = Clip();
+    return Rect(GetFrame() * clip.frameWidth, 0, clip.frameWidth, clip.frameHeight);
+}
+
+/*
+================================================================================
+
+RenderableArray::ConstSlot::GetSourceRect
+
+    Same as Renderable::GetSourceRect.
+
+================================================================================
+*/
+Rect RenderableArray::ConstSlot::GetSourceRect(bool grayscale) const
+{
+    Rect src = GetFrameRect();
+
+    const Texture* tex = GetTexture(grayscale);
+    if (tex) {
+        src.x += tex->GetRegion().x;
+        src.y += tex->GetRegion().y;
+    }
+
+    return src;
+}
+
+/*
+================================================================================
+
+RenderableArray::Reserve
+
+================================================================================
+*/
+void RenderableArray::Reserve(int n)
+{
+    mClip.reserve(n);
+    mTime.reserve(n);
+    mRate.reserve(n);
+    mFrame.reserve(n);
+    mPhase.reserve(n);
+}
+
+/*
+================================================================================
+
+RenderableArray::Add
+
+    Adds a slot at the end that plays clip from the beginning, at the
+    normal rate.
+
+================================================================================
+*/
+void RenderableArray::Add(ClipId clip)
+{
+    mClip.push_back(clip);
+    mTime.push_back(0.0f);
+    mRate.push_back(1.0f);
+    mFrame.push_back(0);
+    mPhase.push_back(NOT_SYNCED);
+}
+
+/*
+================================================================================
+
+RenderableArray::Set
+
+    Starts clip from the beginning in slot i.  The slot keeps its rate,
+    but not its spot on the clock (if it was synced).
+
+================================================================================
+*/
+void RenderableArray::Set(int i, ClipId clip)
+{
+    if (mPhase[i] != NOT_SYNCED) {
+        mPhase[i] = NOT_SYNCED;
+        mNumSynced--;
     }
 
-    // compute the offset of the current frame rect in the texture
-    mFrameRect.x = frameNo * mFrameRect.w;
+    mClip[i] = clip;
+    mTime[i] = 0.0f;
+    mFrame[i] = 0;
+}
+
+/*
+================================================================================
+
+RenderableArray::Remove
+
+    Removes slot i by moving the last slot into its place.
+
+================================================================================
+*/
+template <class T>
+static void RemoveAt(std::vector<T>& v, int i)
+{
+    v[i] = v.back();
+    v.pop_back();
+}
+
+void RenderableArray::Remove(int i)
+{
+    if (mPhase[i] != NOT_SYNCED) {
+        mNumSynced--;
+    }
+
+    RemoveAt(mClip, i);
+    RemoveAt(mTime, i);
+    RemoveAt(mRate, i);
+    RemoveAt(mFrame, i);
+    RemoveAt(mPhase, i);
+}
+
+/*
+================================================================================
+
+RenderableArray::Clear
+
+================================================================================
+*/
+void RenderableArray::Clear()
+{
+    mClip.clear();
+    mTime.clear();
+    mRate.clear();
+    mFrame.clear();
+    mPhase.clear();
+    mNumSynced = 0;
+}
+
+/*
+================================================================================
+
+RenderableArray::Sync
+
+    Makes slot i follow the clock, phase frames ahead of it, from now on.
+    The clip should be one that loops (see ClipClock).
+
+================================================================================
+*/
+void RenderableArray::Sync(int i, int phase)
+{
+    if (mPhase[i] == NOT_SYNCED) {
+        mNumSynced++;
+    }
+    mPhase[i] = phase < 0 ? 0 : phase;
+}
+
+/*
+================================================================================
+
+RenderableArray::Unsync
+
+    Lets slot i play on its own again, from the frame the clock had it on.
+
+================================================================================
+*/
+void RenderableArray::Unsync(int i)
+{
+    if (mPhase[i] == NOT_SYNCED) {
+        return;
+    }
+
+    ConstSlot slot(this, i);
+    mTime[i] = slot.GetTime();
+    mFrame[i] = slot.GetFrame();
+
+    mPhase[i] = NOT_SYNCED;
+    mNumSynced--;
+}
+
+//
+// The animation pass
+//
+
+// the arrays that Animate reads and writes: the slots' own, indexed by
+// slot, and the clip library's, indexed by clip id
+struct AnimationLanes {
+    const int*              clip;
+    float*                  time;
+    const float*            rate;
+    int*                    frame;
+    const int*              phase;
+
+    const float*            duration;
+    const int*              numFrames;
+    const int*              loopable;
+    const int*              animated;
+};
+
+// Advances slot i, doing exactly what Renderable::Animate(dt * rate) does
+static void AnimateScalar(const AnimationLanes& a, int i, float dt)
+{
+    int clip = a.clip[i];
+    if (!a.animated[clip] || a.phase[i] != RenderableArray::NOT_SYNCED) {
+        return;
+    }
+
+    float duration = a.duration[clip];
+    int numFrames = a.numFrames[clip];
+    float time = a.time[i] + dt * a.rate[i];
+
+    if (time >= duration) {
+        time = a.loopable[clip] ? std::fmod(time, duration) : duration;
+    }
+
+    int frameNo;
+    if (time < duration) {
+        float progress = time / duration;
+        frameNo = (int)(numFrames * progress);
+    } else {
+        frameNo = numFrames - 1;
+    }
+
+    a.time[i] = time;
+    a.frame[i] = frameNo;
+}
+
+#ifdef GG_X86
+
+// The vector versions do the same math on 4 (SSE2) or 8 (AVX2) slots at
+// once, after looking up each slot's clip (AVX2 has gather instructions
+// for that, SSE2 does it one lane at a time).  A looping animation that
+// ends is wrapped with one subtraction, which is what fmod comes to
+// (exactly) as long as the time is less than two durations; a group with a
+// slot that went further than that is rare enough to just go through
+// AnimateScalar.  Slots that aren't animated, or are synced to the clock,
+// get their old time and frame written back.  They return the number of
+// slots they did, the rest are up to AnimateScalar.
+
+GG_TARGET_SSE2
+static inline __m128 SelectSSE2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+GG_TARGET_SSE2
+static int AnimateSSE2(const AnimationLanes& a, int count, float dt)
+{
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i notSynced = _mm_set1_epi32(RenderableArray::NOT_SYNCED);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const int* c = a.clip + i;
+
+        __m128i numFrames = _mm_setr_epi32(a.numFrames[c[0]], a.numFrames[c[1]], a.numFrames[c[2]], a.numFrames[c[3]]);
+        __m128 animatable = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_setr_epi32(a.animated[c[0]], a.animated[c[1]], a.animated[c[2]], a.animated[c[3]]), one));
+        animatable = _mm_and_ps(animatable, _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(a.phase + i)), notSynced)));
+        __m128 looping = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_setr_epi32(a.loopable[c[0]], a.loopable[c[1]], a.loopable[c[2]], a.loopable[c[3]]), one));
+
+        __m128 duration = _mm_setr_ps(a.duration[c[0]], a.duration[c[1]], a.duration[c[2]], a.duration[c[3]]);
+        __m128 oldTime = _mm_loadu_ps(a.time + i);
+        __m128 time = _mm_add_ps(oldTime, _mm_mul_ps(step, _mm_loadu_ps(a.rate + i)));
+
+        __m128 ended = _mm_cmpge_ps(time, duration);
+        __m128 wrapped = _mm_sub_ps(time, duration);
+        __m128 farEnded = _mm_and_ps(_mm_and_ps(animatable, looping), _mm_and_ps(ended, _mm_cmpge_ps(wrapped, duration)));
+        if (_mm_movemask_ps(farEnded)) {
+            for (int j = i; j < i + 4; j++) {
+                AnimateScalar(a, j, dt);
+            }
+            continue;
+        }
+        time = SelectSSE2(ended, SelectSSE2(looping, wrapped, duration), time);
+
+        // the frame the time is on, or the last one at the very end
+        __m128 progress = _mm_div_ps(time, duration);
+        __m128i frameNo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(numFrames), progress));
+        __m128i lastFrame = _mm_sub_epi32(numFrames, one);
+        frameNo = _mm_castps_si128(SelectSSE2(_mm_cmplt_ps(time, duration), _mm_castsi128_ps(frameNo), _mm_castsi128_ps(lastFrame)));
+
+        __m128i oldFrame = _mm_loadu_si128((const __m128i*)(a.frame + i));
+
+        _mm_storeu_ps(a.time + i, SelectSSE2(animatable, time, oldTime));
+        _mm_storeu_si128((__m128i*)(a.frame + i), _mm_castps_si128(SelectSSE2(animatable, _mm_castsi128_ps(frameNo), _mm_castsi128_ps(oldFrame))));
+    }
+    return i;
+}
+
+GG_TARGET_AVX2
+static int AnimateAVX2(const AnimationLanes& a, int count, float dt)
+{
+    const __m256 step = _mm256_set1_ps(dt);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i notSynced = _mm256_set1_epi32(RenderableArray::NOT_SYNCED);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i clip = _mm256_loadu_si256((const __m256i*)(a.clip + i));
+
+        __m256i numFrames = _mm256_i32gather_epi32(a.numFrames, clip, 4);
+        __m256 animatable = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_i32gather_epi32(a.animated, clip, 4), one));
+        animatable = _mm256_and_ps(animatable, _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(a.phase + i)), notSynced)));
+        __m256 looping = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_i32gather_epi32(a.loopable, clip, 4), one));
+
+        __m256 duration = _mm256_i32gather_ps(a.duration, clip, 4);
+        __m256 oldTime = _mm256_loadu_ps(a.time + i);
+        __m256 time = _mm256_add_ps(oldTime, _mm256_mul_ps(step, _mm256_loadu_ps(a.rate + i)));
+
+        __m256 ended = _mm256_cmp_ps(time, duration, _CMP_GE_OQ);
+        __m256 wrapped = _mm256_sub_ps(time, duration);
+        __m256 farEnded = _mm256_and_ps(_mm256_and_ps(animatable, looping), _mm256_and_ps(ended, _mm256_cmp_ps(wrapped, duration, _CMP_GE_OQ)));
+        if (_mm256_movemask_ps(farEnded)) {
+            for (int j = i; j < i + 8; j++) {
+                AnimateScalar(a, j, dt);
+            }
+            continue;
+        }
+        time = _mm256_blendv_ps(time, _mm256_blendv_ps(duration, wrapped, looping), ended);
+
+        __m256 progress = _mm256_div_ps(time, duration);
+        __m256i frameNo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(numFrames), progress));
+        __m256i lastFrame = _mm256_sub_epi32(numFrames, one);
+        frameNo = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(lastFrame), _mm256_castsi256_ps(frameNo), _mm256_cmp_ps(time, duration, _CMP_LT_OQ)));
+
+        __m256i oldFrame = _mm256_loadu_si256((const __m256i*)(a.frame + i));
+
+        _mm256_storeu_ps(a.time + i, _mm256_blendv_ps(oldTime, time, animatable));
+        _mm256_storeu_si256((__m256i*)(a.frame + i), _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(oldFrame), _mm256_castsi256_ps(frameNo), animatable)));
+    }
+    return i;
+}
+
+#endif
+
+/*
+================================================================================
+
+RenderableArray::Animate
+
+    Advances every animated slot by dt times its rate, and moves it to the
+    frame it's on, like Renderable::Animate.  Synced slots are up to the
+    clock, so an array of nothing else is done right away.
+
+================================================================================
+*/
+void RenderableArray::Animate(float dt)
+{
+    int count = GetCount();
+    if (count == mNumSynced) {
+        return;
+    }
+
+    AnimationLanes a;
+    a.clip = &mClip[0];
+    a.time = &mTime[0];
+    a.rate = &mRate[0];
+    a.frame = &mFrame[0];
+    a.phase = &mPhase[0];
+    a.duration = mClips->GetDurations();
+    a.numFrames = mClips->GetNumFrames();
+    a.loopable = mClips->GetLoopable();
+    a.animated = mClips->GetAnimated();
+
+    int i = 0;
+#ifdef GG_X86
+    switch (GetSimdLevel()) {
+    case SIMD_AVX2: i = AnimateAVX2(a, count, dt); break;
+    case SIMD_SSE2: i = AnimateSSE2(a, count, dt); break;
+    default:        break;
+    }
+#endif
+
+    for (; i < count; i++) {
+        AnimateScalar(a, i, dt);
+    }
 }
 
 } // end of namespace
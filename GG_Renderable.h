@@ -1,9 +1,12 @@
 #ifndef GG_RENDERABLE_H_
 #define GG_RENDERABLE_H_
 
+#include "GG_AnimationClip.h"
 #include "GG_Graphics.h"
 #include "GG_Common.h"
 
+#include <vector>
+
 namespace GG {
 
 /*
@@ -13,71 +16,195 @@ Renderable class
 
     A Renderable is something that can be drawn, a.k.a. rendered.
 
-    In this case, a Renderable holds a pointer to a texture, a pointer to 
-	a grayscale version of that texture, and the 
-    sub-rectangle in these textures where its image resides.
+    In this case, a Renderable is an instance of an AnimationClip: it says
+    which clip it shows, which frame of it (the cell in the clip's sprite
+    sheet), and how far into the clip it is, and whether to use the
+    grayscale texture.  Everything else (the textures, the frame size, the
+    duration) lives in the clip, which any number of Renderables share,
+    so a Renderable is only a few bytes.
 
-    The Renderable doesn't own the Texture, since multiple renderables can
-    share the same Texture object at the same time.  You can think of a
-    Renderable as an instance of some graphical resource.  Renderables 
+    The Renderable doesn't own the clip (a ClipLibrary does).  You can think
+    of a Renderable as an instance of some graphical resource.  Renderables
     serve as the visual appearance of game objects.
 
-    This class supports both animated and static (non-animated) Renderables,
-    and provides different constructors for both (see comments in code).
+    Animated clips get played with Animate.  Stills stay on the frame they
+    were created with, which is how the tiles pick their cell.  Renderables
+    are plain values, so game objects can hold them as members and assign
+    a new one over an old one.
 
-    It might help to study the Texture class before the Renderable class,
-    since the Renderable class relies heavily on the ideas encapsulated in
-    the Texture class (like texture cells, etc.)
+    The frame rect is relative to the texture.  When drawing, use
+    GetSourceRect, which also accounts for where the texture was packed
+    in its atlas page.
 
 ================================================================================
 */
 class Renderable {
 
-    const Texture*          mTex;           // sprite sheet (we don't own this)
-	const Texture*			mGrayscaleTex;  // grayscale version
-	bool					mGrayscale;
+    const AnimationClip*    mClip;          // what it shows (we don't own this)
+    float                   mTime;          // current time position (animated clips only)
+    Uint16                  mFrame;         // current frame (cell in the sprite sheet)
+    bool                    mGrayscale;
+
+public:
+                            Renderable();
+    explicit                Renderable(const AnimationClip* clip, int frame = 0);
+
+    const AnimationClip*    GetClip() const         { return mClip; }
+
+    const Texture*          GetTexture() const      { return GetTexture(mGrayscale); }
+    const Texture*          GetTexture(bool grayscale) const    { return mClip ? (grayscale ? mClip->grayscaleTex : mClip->tex) : NULL; }
+    Rect                    GetFrameRect() const;
+    Rect                    GetSourceRect() const   { return GetSourceRect(mGrayscale); }
+    Rect                    GetSourceRect(bool grayscale) const;  // frame rect within the texture's SDL_Texture (atlas page)
+
+    int                     GetWidth() const        { return mClip ? mClip->frameWidth : 0; }
+    int                     GetHeight() const       { return mClip ? mClip->frameHeight : 0; }
+
+    bool                    IsAnimatable() const    { return mClip && mClip->IsAnimated(); }
+
+    int                     GetFrame() const        { return mFrame; }
+    int                     GetNumFrames() const    { return mClip ? mClip->numFrames : 1; }
+    float                   GetDuration() const     { return mClip ? mClip->duration : 0.0f; }
+    bool                    IsLoopable() const      { return mClip && mClip->loopable; }
+
+    float                   GetTime() const         { return mTime; }
+    bool                    IsAnimating() const     { return mTime < GetDuration(); }
+
+    void                    Rewind()                { mTime = 0.0f; }
+
+    void                    Animate(float dt);
 
-    int                     mNumFrames;     // number of animation frames or 1 if not animatable
+    const Point*            GetRotationOrigin() const       { return mClip ? &mClip->rotOrigin : NULL; }
+
+	void					SetGrayscale(bool grayscale)	{ mGrayscale = grayscale; }
+};
 
-    float                   mDuration;      // total duration in seconds (animated renderable only)
-    bool                    mLoopable;      // restart when finished? (animated renderables only)
-    float                   mTime;          // current time position (animated renderables only)
+/*
+================================================================================
 
-    Rect                    mFrameRect;     // current frame rect (cell in sprite sheet)
+RenderableArray class
+
+    Lots of renderables of one kind (like all the coins), stored a field at
+    a time instead of a renderable at a time: all the clip ids in one
+    array, all the times in another, and so on.  That way Animate can
+    advance every animation in the array in a single pass, four or eight
+    at a time with SSE2 or AVX2 (see GetSimdLevel), and write the new
+    frames straight into place.
+
+    A slot is just a clip id, a time, a rate and a frame.  The pass looks
+    up the clips' durations and frame counts in the library (see
+    ClipLibrary::GetDurations), and the rects get worked out from the frame
+    when something asks for them.
+
+    Each slot plays at its own rate (0 pauses it), so entities that move
+    at different speeds, or stop animating for a while, still share the
+    one pass.  The pass comes out the same, bit for bit, as calling
+    Renderable::Animate(dt * rate) on every slot.
+
+    Slots that play a looping clip in step with everybody else can Sync to
+    the array's ClipClock instead, optionally a few frames ahead of it.
+    Those take their frame straight from the clock, and the pass skips
+    them, so an array of nothing but synced slots costs nothing to animate
+    no matter how big it is.  Unsync gives a slot its own time back,
+    starting from where the clock had it.
+
+    Slots start at the beginning of a clip (Add and Set), and get removed
+    like the rows of the entity tables, by moving the last one into their
+    place.  operator[] returns a view onto a slot, with the same getters as
+    a Renderable, for the code that looks at one of them at a time.
 
-	double                  mRotAngle;      // rotation angle in degrees
-	Point                   mRotOrigin;     // rotation origin
+================================================================================
+*/
+class RenderableArray {
+
+    const ClipLibrary*      mClips;         // where the clip ids point (we don't own this)
+    const ClipClock*        mClock;         // what synced slots follow (we don't own this either)
+
+    std::vector<ClipId>     mClip;
+    std::vector<float>      mTime;
+    std::vector<float>      mRate;          // playback speed, 1 for normal, 0 to pause
+    std::vector<int>        mFrame;
+    std::vector<int>        mPhase;         // frames ahead of the clock, or NOT_SYNCED
+
+    int                     mNumSynced;
 
 public:
-                            Renderable(const Texture* tex, const Texture* grayscaleTex);
-                            Renderable(const Texture* tex, const Texture* grayscaleTex, int cellNo);
-                            Renderable(const Texture* tex, const Texture* grayscaleTex, float duration, bool loopable);
+    enum {
+        NOT_SYNCED = -1
+    };
 
-    const Texture*          GetTexture() const      { return mGrayscale ? mGrayscaleTex : mTex; }
-    const Rect*             GetRect() const         { return &mFrameRect; }
+    class ConstSlot {
+    protected:
+        const RenderableArray*  mArray;
+        int                     mIndex;
 
-    int                     GetWidth() const        { return mFrameRect.w; }
-    int                     GetHeight() const       { return mFrameRect.h; }
+        const AnimationClip&    Clip() const            { return *mArray->mClips->GetClip(mArray->mClip[mIndex]); }
 
-    bool                    IsAnimatable() const    { return mNumFrames > 1; }
+    public:
+                                ConstSlot(const RenderableArray* array, int index) : mArray(array), mIndex(index) {}
 
-    int                     GetNumFrames() const    { return mNumFrames; }
-    float                   GetDuration() const     { return mDuration; }
-    bool                    IsLoopable() const      { return mLoopable; }
+        ClipId                  GetClipId() const       { return mArray->mClip[mIndex]; }
+        const AnimationClip*    GetClip() const         { return &Clip(); }
 
-    bool                    IsAnimating() const     { return mTime < mDuration; }
+        const Texture*          GetTexture(bool grayscale) const    { return grayscale ? Clip().grayscaleTex : Clip().tex; }
+        Rect                    GetFrameRect() const;
+        Rect                    GetSourceRect(bool grayscale) const;
 
-    void                    Rewind()                { mTime = 0.0f; }
+        int                     GetWidth() const        { return Clip().frameWidth; }
+        int                     GetHeight() const       { return Clip().frameHeight; }
 
-    void                    Animate(float dt);
+        bool                    IsAnimatable() const    { return Clip().IsAnimated(); }
 
-	double                  GetRotationAngle() const        { return mRotAngle; }
-    void                    SetRotationAngle(double angle)  { mRotAngle = angle; }
+        int                     GetFrame() const;
+        int                     GetNumFrames() const    { return Clip().numFrames; }
+        float                   GetDuration() const     { return Clip().duration; }
+        bool                    IsLoopable() const      { return Clip().loopable; }
 
-	const Point&            GetRotationOrigin() const               { return mRotOrigin; }
-    void                    SetRotationOrigin(const Point& origin)  { mRotOrigin = origin; }
+        float                   GetTime() const;
+        float                   GetRate() const         { return mArray->mRate[mIndex]; }
+        bool                    IsAnimating() const     { return GetTime() < Clip().duration; }
 
-	void					SetGrayscale(bool grayscale)	{ mGrayscale = grayscale; }
+        bool                    IsSynced() const        { return mArray->mPhase[mIndex] != NOT_SYNCED; }
+        int                     GetPhase() const        { return mArray->mPhase[mIndex]; }
+
+        const Point&            GetRotationOrigin() const   { return Clip().rotOrigin; }
+    };
+
+    class Slot : public ConstSlot {
+        RenderableArray*        GetArray() const        { return const_cast<RenderableArray*>(mArray); }
+
+    public:
+                                Slot(RenderableArray* array, int index) : ConstSlot(array, index) {}
+
+        void                    Play(ClipId clip)       { GetArray()->Set(mIndex, clip); }
+        void                    Rewind()                { GetArray()->mTime[mIndex] = 0.0f; }
+        void                    SetRate(float rate)     { GetArray()->mRate[mIndex] = rate; }
+
+        void                    Sync(int phase = 0)     { GetArray()->Sync(mIndex, phase); }
+        void                    Unsync()                { GetArray()->Unsync(mIndex); }
+    };
+
+                            RenderableArray();
+
+    void                    SetClipLibrary(const ClipLibrary* clips)    { mClips = clips; }
+    const ClipLibrary*      GetClipLibrary() const                      { return mClips; }
+    void                    SetClipClock(const ClipClock* clock)        { mClock = clock; }
+
+    int                     GetCount() const        { return (int)mTime.size(); }
+
+    void                    Reserve(int n);
+    void                    Add(ClipId clip);
+    void                    Set(int i, ClipId clip);
+    void                    Remove(int i);
+    void                    Clear();
+
+    void                    Sync(int i, int phase);
+    void                    Unsync(int i);
+
+    void                    Animate(float dt);
+
+    ConstSlot               operator[] (int i) const    { return ConstSlot(this, i); }
+    Slot                    operator[] (int i)          { return Slot(this, i); }
 };
 
 } // end of namespace
@@ -0,0 +1,227 @@
+#include "GG_SpatialHash.h"
+
+#include <algorithm>
+
+namespace GG {
+
+/*
+================================================================================
+
+SpatialHash constructor
+
+    Creates a hash with 64x64 cells and 1024 buckets.  Call Initialize to
+    pick something better.
+
+================================================================================
+*/
+SpatialHash::SpatialHash()
+    : mCellWidth(64)
+    , mCellHeight(64)
+    , mNumBuckets(1024)
+    , mSorted(true)
+    , mQueryCount(0)
+{ }
+
+/*
+================================================================================
+
+SpatialHash::Initialize
+
+    Sets the cell size and the number of buckets (rounded up to a power of
+    two), and empties the hash.  Cells about the size of the things being
+    inserted work best, and a few times more buckets than the number of
+    occupied cells keeps the buckets from getting shared much.
+
+================================================================================
+*/
+void SpatialHash::Initialize(int cellWidth, int cellHeight, int numBuckets)
+{
+    mCellWidth = cellWidth > 0 ? cellWidth : 1;
+    mCellHeight = cellHeight > 0 ? cellHeight : 1;
+
+    int n = 1;
+    while (n < numBuckets) {
+        n *= 2;
+    }
+    mNumBuckets = n;
+
+    Clear();
+}
+
+/*
+================================================================================
+
+SpatialHash::Clear
+
+    Removes everything, but keeps the memory for the next round.
+
+================================================================================
+*/
+void SpatialHash::Clear()
+{
+    mEntries.clear();
+
+    mItemRects.Clear();
+    mIds.clear();
+    mStamps.clear();
+
+    mSorted = false;
+}
+
+// cell coordinates round towards negative infinity, so that things
+// above or left of the origin (like meteors coming in) get their own cells
+inline int SpatialHash::CellX(int x) const
+{
+    return x >= 0 ? x / mCellWidth : -((-x - 1) / mCellWidth) - 1;
+}
+
+inline int SpatialHash::CellY(int y) const
+{
+    return y >= 0 ? y / mCellHeight : -((-y - 1) / mCellHeight) - 1;
+}
+
+inline int SpatialHash::Bucket(int cellX, int cellY) const
+{
+    Uint32 h = (Uint32)cellX * 73856093u ^ (Uint32)cellY * 19349663u;
+    return (int)(h & (Uint32)(mNumBuckets - 1));
+}
+
+/*
+================================================================================
+
+SpatialHash::Insert
+
+    Adds a rect to every cell it touches.  Empty rects can't overlap
+    anything, so they're skipped.
+
+================================================================================
+*/
+void SpatialHash::Insert(const Rect& rect, Uint32 id)
+{
+    if (rect.w <= 0 || rect.h <= 0) {
+        return;
+    }
+
+    int item = (int)mIds.size();
+
+    mItemRects.Add(rect);
+    mIds.push_back(id);
+    mStamps.push_back(0);
+
+    int x0 = CellX(rect.x);
+    int y0 = CellY(rect.y);
+    int x1 = CellX(rect.x + rect.w - 1);
+    int y1 = CellY(rect.y + rect.h - 1);
+
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            Entry entry;
+            entry.item = item;
+            entry.bucket = Bucket(cx, cy);
+            mEntries.push_back(entry);
+        }
+    }
+
+    mSorted = false;
+}
+
+/*
+================================================================================
+
+SpatialHash::Sort
+
+    Counting sort of the entries by bucket, copying each entry's rect along
+    with it, so that a bucket's rects can be batch tested straight out of
+    mSortedRects.
+
+================================================================================
+*/
+void SpatialHash::Sort() const
+{
+    mBucketStart.assign(mNumBuckets + 1, 0);
+    for (size_t e = 0; e < mEntries.size(); e++) {
+        mBucketStart[mEntries[e].bucket + 1]++;
+    }
+    for (int b = 0; b < mNumBuckets; b++) {
+        mBucketStart[b + 1] += mBucketStart[b];
+    }
+
+    int numEntries = (int)mEntries.size();
+    mSortedEntries.resize(numEntries);
+    mSortedRects.Resize(numEntries);
+
+    // mMask doubles as the fill cursor for each bucket here
+    mMask.assign(mBucketStart.begin(), mBucketStart.end() - 1);
+    for (int e = 0; e < numEntries; e++) {
+        const Entry& entry = mEntries[e];
+        int slot = (int)mMask[entry.bucket]++;
+        mSortedEntries[slot] = entry;
+        mSortedRects.Set(slot, mItemRects.Get(entry.item));
+    }
+
+    mSorted = true;
+}
+
+/*
+================================================================================
+
+SpatialHash::Query
+
+    Appends the ids of all the rects that overlap the specified rect.
+
+================================================================================
+*/
+void SpatialHash::Query(const Rect& rect, std::vector<Uint32>* ids) const
+{
+    if (rect.w <= 0 || rect.h <= 0 || mIds.empty()) {
+        return;
+    }
+
+    // a new stamp, so that items spanning several cells get reported once
+    if (++mQueryCount == 0) {
+        std::fill(mStamps.begin(), mStamps.end(), 0);
+        mQueryCount = 1;
+    }
+
+    if (!mSorted) {
+        Sort();
+    }
+
+    int x0 = CellX(rect.x);
+    int y0 = CellY(rect.y);
+    int x1 = CellX(rect.x + rect.w - 1);
+    int y1 = CellY(rect.y + rect.h - 1);
+
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            int bucket = Bucket(cx, cy);
+            int first = mBucketStart[bucket];
+            int count = mBucketStart[bucket + 1] - first;
+            if (count == 0) {
+                continue;
+            }
+
+            // entries from other cells that share the bucket get tested
+            // too, but the test is exact, so any hits among them are real
+            mMask.resize(GetMaskWords(count));
+            if (OverlapOneToMany(rect, mSortedRects, first, count, &mMask[0]) == 0) {
+                continue;
+            }
+
+            for (int w = 0; w < (int)mMask.size(); w++) {
+                for (Uint32 bits = mMask[w], j = w * 32; bits != 0; bits >>= 1, j++) {
+                    if ((bits & 1) == 0) {
+                        continue;
+                    }
+                    int item = mSortedEntries[first + j].item;
+                    if (mStamps[item] != mQueryCount) {
+                        mStamps[item] = mQueryCount;
+                        ids->push_back(mIds[item]);
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // end namespace
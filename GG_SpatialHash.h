@@ -0,0 +1,103 @@
+#ifndef GG_SPATIAL_HASH_H_
+#define GG_SPATIAL_HASH_H_
+
+#include <SDL.h>
+
+#include "GG_Common.h"
+#include "GG_Collision.h"
+
+#include <vector>
+
+namespace GG {
+
+/*
+================================================================================
+
+SpatialHash class
+
+    A broadphase for collision checks: it finds which rects overlap without
+    testing every rect against every other one.
+
+    Space is cut up into a uniform grid of cells (the game uses its tile
+    size), and each rect gets listed in every cell it touches.  The cells
+    are hashed into a fixed number of buckets, so the world doesn't need to
+    be bounded.  A query only looks at the cells its rect touches, so its
+    cost depends on how crowded that area is, not on how many rects there
+    are in total.
+
+    Things move every frame, so the usual way to use it is to Clear it and
+    Insert everything at their current positions once per frame, then
+    query as much as needed.  Each rect comes with a 32-bit id chosen by the
+    caller, which is what the queries return.
+
+    Query returns the ids of the rects that overlap a given rect (each one
+    once).  It does the exact rect test, so the results are real overlaps,
+    not just neighbors.  Rects that merely touch edges don't count, same as
+    SDL_HasIntersection.
+
+    The exact tests run in batches: the first query after an Insert sorts
+    the entries by bucket, with a copy of each entry's rect in a RectArray,
+    so that everything a cell can hold sits in one contiguous run that
+    OverlapOneToMany tests in one go with SSE2 or AVX2.
+
+    Once the internal arrays have grown to fit a frame's worth of rects,
+    clearing and refilling doesn't allocate.
+
+    Query is const, since it doesn't change what's in the hash, but it
+    does the sorting and keeps its scratch arrays in mutable members.  So
+    it isn't thread safe: only one thread at a time may use a hash, even
+    just for queries.  That's fine with one hash per World.
+
+================================================================================
+*/
+class SpatialHash {
+
+    struct Entry {
+        int                 item;           // index into the item arrays
+        int                 bucket;
+    };
+
+    int                     mCellWidth;
+    int                     mCellHeight;
+    int                     mNumBuckets;    // a power of two
+
+    std::vector<Entry>      mEntries;       // in the order they were inserted
+
+    // the inserted rects and their ids
+    RectArray               mItemRects;
+    std::vector<Uint32>     mIds;
+
+    // the entries sorted by bucket, worked out again after every Insert
+    mutable bool                mSorted;
+    mutable std::vector<int>    mBucketStart;   // where each bucket's entries start (one extra at the end)
+    mutable std::vector<Entry>  mSortedEntries;
+    mutable RectArray           mSortedRects;   // the rect of each sorted entry
+
+    mutable std::vector<Uint32> mMask;      // hit bits from the batch tests
+    mutable std::vector<Uint32> mStamps;    // last query that saw each item (to report it once)
+    mutable Uint32          mQueryCount;
+
+    int                     CellX(int x) const;
+    int                     CellY(int y) const;
+    int                     Bucket(int cellX, int cellY) const;
+
+    void                    Sort() const;
+
+public:
+                            SpatialHash();
+
+    void                    Initialize(int cellWidth, int cellHeight, int numBuckets);
+
+    void                    Clear();
+
+    void                    Insert(const Rect& rect, Uint32 id);
+
+    void                    Query(const Rect& rect, std::vector<Uint32>* ids) const;
+
+    int                     GetNumItems() const     { return (int)mIds.size(); }
+    int                     GetNumEntries() const   { return (int)mEntries.size(); }
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,257 @@
+#include "GG_SpriteBatch.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace GG {
+
+static const double DEG_TO_RAD = 3.14159265358979323846 / 180.0;
+
+/*
+================================================================================
+
+SpriteBatch constructor
+
+    Creates an empty batch.  Call Initialize before drawing anything.
+
+================================================================================
+*/
+SpriteBatch::SpriteBatch()
+    : mRenderer(NULL)
+    , mTex(NULL)
+    , mInvTexWidth(0.0f)
+    , mInvTexHeight(0.0f)
+    , mNumSprites(0)
+    , mNumDrawCalls(0)
+{
+}
+
+/*
+================================================================================
+
+SpriteBatch::Initialize
+
+    Sets the renderer to submit to.  Also reserves room for a good number of
+    quads up front, so that the vertex arrays don't grow during the first
+    few frames.
+
+================================================================================
+*/
+void SpriteBatch::Initialize(SDL_Renderer* renderer)
+{
+    mRenderer = renderer;
+
+    mVertices.reserve(4 * 1024);
+    mIndices.reserve(6 * 1024);
+}
+
+/*
+================================================================================
+
+SpriteBatch::Begin
+
+    Starts a new frame's worth of drawing and resets the statistics.
+
+================================================================================
+*/
+void SpriteBatch::Begin()
+{
+    mVertices.clear();
+    mIndices.clear();
+    mTex = NULL;
+
+    mNumSprites = 0;
+    mNumDrawCalls = 0;
+}
+
+/*
+================================================================================
+
+SpriteBatch::End
+
+    Submits whatever is still pending.
+
+================================================================================
+*/
+void SpriteBatch::End()
+{
+    Flush();
+}
+
+/*
+================================================================================
+
+SpriteBatch::Draw
+
+    Queues a quad with no color modulation.
+
+================================================================================
+*/
+void SpriteBatch::Draw(SDL_Texture* tex, const Rect& srcRect, const Rect& dstRect,
+                       double angle, const Point* origin, SDL_RendererFlip flip)
+{
+    SDL_Color white = { 255, 255, 255, 255 };
+    Draw(tex, srcRect, dstRect, angle, origin, flip, white);
+}
+
+/*
+================================================================================
+
+SpriteBatch::Draw
+
+    Queues a quad.  The arguments mean the same thing as they do for
+    SDL_RenderCopyEx: the rotation angle is in degrees (clockwise), the
+    origin is relative to the destination rect (NULL means its center),
+    and flipping is applied before rotating.
+
+================================================================================
+*/
+void SpriteBatch::Draw(SDL_Texture* tex, const Rect& srcRect, const Rect& dstRect,
+                       double angle, const Point* origin, SDL_RendererFlip flip, SDL_Color color)
+{
+    if (!tex) {
+        return;
+    }
+
+    // a new texture means a new batch
+    if (tex != mTex) {
+        Flush();
+
+        int w = 0, h = 0;
+        SDL_QueryTexture(tex, NULL, NULL, &w, &h);
+
+        mTex = tex;
+        mInvTexWidth = w > 0 ? 1.0f / w : 0.0f;
+        mInvTexHeight = h > 0 ? 1.0f / h : 0.0f;
+    }
+
+    // texture coordinates, swapped around for flipping
+    float u0 = srcRect.x * mInvTexWidth;
+    float v0 = srcRect.y * mInvTexHeight;
+    float u1 = (srcRect.x + srcRect.w) * mInvTexWidth;
+    float v1 = (srcRect.y + srcRect.h) * mInvTexHeight;
+
+    if (flip & SDL_FLIP_HORIZONTAL) {
+        float t = u0; u0 = u1; u1 = t;
+    }
+    if (flip & SDL_FLIP_VERTICAL) {
+        float t = v0; v0 = v1; v1 = t;
+    }
+
+    // corners in clockwise order, starting top left
+    float x0 = (float)dstRect.x;
+    float y0 = (float)dstRect.y;
+    float x1 = (float)(dstRect.x + dstRect.w);
+    float y1 = (float)(dstRect.y + dstRect.h);
+
+    SDL_FPoint corners[4] = {
+        { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 }
+    };
+
+    if (angle != 0.0) {
+        float cx = origin ? x0 + origin->x : x0 + 0.5f * dstRect.w;
+        float cy = origin ? y0 + origin->y : y0 + 0.5f * dstRect.h;
+
+        double rad = angle * DEG_TO_RAD;
+        float c = (float)std::cos(rad);
+        float s = (float)std::sin(rad);
+
+        for (int i = 0; i < 4; i++) {
+            float dx = corners[i].x - cx;
+            float dy = corners[i].y - cy;
+            corners[i].x = cx + dx * c - dy * s;
+            corners[i].y = cy + dx * s + dy * c;
+        }
+    }
+
+    AddQuad(corners, u0, v0, u1, v1, color);
+}
+
+/*
+================================================================================
+
+SpriteBatch::FillRect
+
+    Queues a quad filled with a solid color.
+
+================================================================================
+*/
+void SpriteBatch::FillRect(const Rect& dstRect, SDL_Color color)
+{
+    if (mTex) {
+        Flush();
+        mTex = NULL;
+    }
+
+    float x0 = (float)dstRect.x;
+    float y0 = (float)dstRect.y;
+    float x1 = (float)(dstRect.x + dstRect.w);
+    float y1 = (float)(dstRect.y + dstRect.h);
+
+    SDL_FPoint corners[4] = {
+        { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 }
+    };
+
+    AddQuad(corners, 0.0f, 0.0f, 0.0f, 0.0f, color);
+}
+
+/*
+================================================================================
+
+SpriteBatch::AddQuad
+
+    Appends the vertices and indices for one quad to the pending batch.
+    The corners go clockwise from the top left.
+
+================================================================================
+*/
+void SpriteBatch::AddQuad(const SDL_FPoint* corners, float u0, float v0, float u1, float v1, SDL_Color color)
+{
+    int base = (int)mVertices.size();
+
+    SDL_Vertex v;
+    v.color = color;
+
+    v.position = corners[0];  v.tex_coord.x = u0;  v.tex_coord.y = v0;  mVertices.push_back(v);
+    v.position = corners[1];  v.tex_coord.x = u1;  v.tex_coord.y = v0;  mVertices.push_back(v);
+    v.position = corners[2];  v.tex_coord.x = u1;  v.tex_coord.y = v1;  mVertices.push_back(v);
+    v.position = corners[3];  v.tex_coord.x = u0;  v.tex_coord.y = v1;  mVertices.push_back(v);
+
+    mIndices.push_back(base + 0);
+    mIndices.push_back(base + 1);
+    mIndices.push_back(base + 2);
+    mIndices.push_back(base + 0);
+    mIndices.push_back(base + 2);
+    mIndices.push_back(base + 3);
+
+    mNumSprites++;
+}
+
+/*
+================================================================================
+
+SpriteBatch::Flush
+
+    Submits the pending batch, if there is one, in a single draw call.
+
+================================================================================
+*/
+void SpriteBatch::Flush()
+{
+    if (mIndices.empty()) {
+        return;
+    }
+
+    if (SDL_RenderGeometry(mRenderer, mTex,
+                           &mVertices[0], (int)mVertices.size(),
+                           &mIndices[0], (int)mIndices.size()) < 0) {
+        std::cerr << "*** SDL_RenderGeometry failed: " << SDL_GetError() << std::endl;
+    }
+
+    mNumDrawCalls++;
+
+    mVertices.clear();
+    mIndices.clear();
+}
+
+} // end namespace
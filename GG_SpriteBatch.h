@@ -0,0 +1,82 @@
+#ifndef GG_SPRITE_BATCH_H_
+#define GG_SPRITE_BATCH_H_
+
+#include <SDL.h>
+#include <vector>
+
+#include "GG_Common.h"
+
+namespace GG {
+
+/*
+================================================================================
+
+SpriteBatch class
+
+    Collects textured quads over the course of a frame and submits them to
+    the renderer with as few SDL_RenderGeometry calls as possible.
+
+    Each Draw call appends a quad (source rect, destination rect, rotation,
+    flip, and color modulation) to the current batch.  Quads that use the
+    same SDL_Texture as the quad before them go into the same batch, so a
+    whole run of sprites costs one draw call.  When the texture changes,
+    the pending batch is submitted first.  Quads are never reordered, so
+    overlapping sprites still come out in the order they were drawn.  This
+    works best when most sprites live on a few atlas pages (see the
+    TextureManager), because then the runs are long.
+
+    FillRect queues a solid colored quad.  Those go into batches of their
+    own (with no texture), and they're blended with the renderer's draw
+    blend mode, so set that to SDL_BLENDMODE_BLEND for see-through colors.
+
+    Anything that draws with the renderer directly (like SDL_RenderFillRect)
+    must call Flush first, otherwise it will end up underneath quads that
+    were drawn before it.
+
+    Begin resets the statistics, and End flushes whatever is left.  The
+    statistics count the quads drawn and the draw calls issued between
+    the two, which is handy for seeing how well the batching works.
+
+================================================================================
+*/
+class SpriteBatch {
+
+    SDL_Renderer*           mRenderer;
+
+    std::vector<SDL_Vertex> mVertices;
+    std::vector<int>        mIndices;
+
+    SDL_Texture*            mTex;           // texture of the pending batch (NULL for solid quads)
+    float                   mInvTexWidth;   // for turning pixels into texture coordinates
+    float                   mInvTexHeight;
+
+    int                     mNumSprites;    // quads drawn since Begin
+    int                     mNumDrawCalls;  // draw calls issued since Begin
+
+    void                    AddQuad(const SDL_FPoint* corners, float u0, float v0, float u1, float v1, SDL_Color color);
+
+public:
+                            SpriteBatch();
+
+    void                    Initialize(SDL_Renderer* renderer);
+
+    void                    Begin();
+    void                    End();
+
+    void                    Draw(SDL_Texture* tex, const Rect& srcRect, const Rect& dstRect,
+                                 double angle, const Point* origin, SDL_RendererFlip flip);
+    void                    Draw(SDL_Texture* tex, const Rect& srcRect, const Rect& dstRect,
+                                 double angle, const Point* origin, SDL_RendererFlip flip, SDL_Color color);
+
+    void                    FillRect(const Rect& dstRect, SDL_Color color);
+
+    void                    Flush();
+
+    int                     GetNumSprites() const       { return mNumSprites; }
+    int                     GetNumDrawCalls() const     { return mNumDrawCalls; }
+    int                     GetNumDrawCallsSaved() const    { return mNumSprites - mNumDrawCalls; }
+};
+
+} // end namespace
+
+#endif
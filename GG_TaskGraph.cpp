@@ -0,0 +1,155 @@
+#include "GG_TaskGraph.h"
+#include "GG_Profiler.h"
+
+#include <iostream>
+
+namespace GG {
+
+/*
+================================================================================
+
+TaskGraph constructor
+
+    Creates an empty graph.
+
+================================================================================
+*/
+TaskGraph::TaskGraph()
+    : mNumWaitingSize(0)
+    , mPool(NULL)
+{
+}
+
+/*
+================================================================================
+
+TaskGraph::AddTask
+
+    Adds a task that runs work, and returns its index for AddEdge.
+
+================================================================================
+*/
+int TaskGraph::AddTask(const char* name, const std::function<void()>& work)
+{
+    int index = (int)mTasks.size();
+
+    Task task;
+    task.name = name;
+    task.work = work;
+    task.run = [this, index]() { RunTask(index); };
+    task.numPredecessors = 0;
+    mTasks.push_back(task);
+
+    return index;
+}
+
+/*
+================================================================================
+
+TaskGraph::AddEdge
+
+    Makes the task after wait for the task before to finish.  The task
+    before has to be the one that was added first.
+
+================================================================================
+*/
+void TaskGraph::AddEdge(int before, int after)
+{
+    if (before < 0 || before >= after || after >= (int)mTasks.size()) {
+        std::cerr << "*** Task graph edge from " << before << " to " << after
+                  << " doesn't go to a later task, ignoring it" << std::endl;
+        return;
+    }
+
+    mTasks[before].successors.push_back(after);
+    mTasks[after].numPredecessors++;
+}
+
+/*
+================================================================================
+
+TaskGraph::Clear
+
+    Removes all the tasks and edges.
+
+================================================================================
+*/
+void TaskGraph::Clear()
+{
+    mTasks.clear();
+}
+
+/*
+================================================================================
+
+TaskGraph::Run
+
+    Runs every task once, each one after all the tasks it waits for, and
+    returns when they've all finished.  With a pool, the tasks run on its
+    threads (and on this one, see ThreadPool::Wait), so Run must not be
+    called from one of the pool's tasks.  Without one, they run on this
+    thread, in the order they were added.
+
+================================================================================
+*/
+void TaskGraph::Run(ThreadPool* pool)
+{
+    int numTasks = (int)mTasks.size();
+
+    if (!pool) {
+        for (int i = 0; i < numTasks; i++) {
+            GG_PROFILE_SCOPE(mTasks[i].name);
+            mTasks[i].work();
+        }
+        return;
+    }
+
+    if (mNumWaitingSize < numTasks) {
+        mNumWaiting.reset(new std::atomic<int>[numTasks]);
+        mNumWaitingSize = numTasks;
+    }
+    for (int i = 0; i < numTasks; i++) {
+        mNumWaiting[i] = mTasks[i].numPredecessors;
+    }
+
+    mPool = pool;
+    for (int i = 0; i < numTasks; i++) {
+        if (mTasks[i].numPredecessors == 0) {
+            pool->Submit(&mTasks[i].run);
+        }
+    }
+
+    // the tasks submit the rest themselves, and Wait waits for those too
+    pool->Wait();
+    mPool = NULL;
+}
+
+/*
+================================================================================
+
+TaskGraph::RunTask
+
+    Runs one task from a pool thread (it's what the task's run function
+    calls), and then submits the tasks that were only still waiting for
+    this one.
+
+================================================================================
+*/
+void TaskGraph::RunTask(int task)
+{
+    const Task& t = mTasks[task];
+
+    {
+        GG_PROFILE_SCOPE(t.name);
+        t.work();
+    }
+
+    for (size_t i = 0; i < t.successors.size(); i++) {
+        int successor = t.successors[i];
+        if (--mNumWaiting[successor] == 0) {
+            mPool->Submit(&mTasks[successor].run);
+        }
+    }
+}
+
+} // end namespace
@@ -0,0 +1,77 @@
+#ifndef GG_TASK_GRAPH_H_
+#define GG_TASK_GRAPH_H_
+
+#include "GG_ThreadPool.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace GG {
+
+/*
+================================================================================
+
+TaskGraph class
+
+    A fixed set of tasks and the order some of them have to run in, for
+    running the independent parts of a job (like the stages of a World
+    step) at the same time.  AddEdge(a, b) says that b can't start before
+    a has finished; tasks without an edge between them (or a path of
+    edges) can run at the same time, on different threads.
+
+    The graph gets built once and then run as often as needed.  Run hands
+    the tasks that don't wait for anything to the pool, and every task
+    that finishes hands over the ones that were only still waiting for it,
+    so each task starts as soon as it can, on whichever thread is free.
+    Without a pool, Run just runs the tasks one after the other, in the
+    order they were added.  Edges always go from a task to one that was
+    added after it, which keeps the graph free of cycles and makes that
+    order one that works.
+
+    Every task gets submitted as the same std::function each time, made
+    once in AddTask, so running the graph doesn't allocate anything.
+
+    Each task runs inside a profiling zone with its name (so the names
+    should be string literals), which shows how long every task took and
+    on which thread.
+
+================================================================================
+*/
+class TaskGraph {
+
+    struct Task {
+        const char*             name;
+        std::function<void()>   work;
+        std::function<void()>   run;            // what gets submitted: RunTask for this task
+        std::vector<int>        successors;     // tasks that wait for this one
+        int                     numPredecessors;
+    };
+
+    std::vector<Task>                       mTasks;
+    std::unique_ptr<std::atomic<int>[]>     mNumWaiting;    // predecessors of each task that haven't finished yet during Run
+    int                                     mNumWaitingSize;
+    ThreadPool*                             mPool;          // the one Run was given
+
+    void                    RunTask(int task);
+
+                            TaskGraph(const TaskGraph&);
+    TaskGraph&              operator= (const TaskGraph&);
+
+public:
+                            TaskGraph();
+
+    int                     AddTask(const char* name, const std::function<void()>& work);
+    void                    AddEdge(int before, int after);
+    void                    Clear();
+
+    void                    Run(ThreadPool* pool);
+
+    int                     GetNumTasks() const             { return (int)mTasks.size(); }
+    const char*             GetTaskName(int task) const     { return mTasks[task].name; }
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,246 @@
+#include "GG_Text.h"
+
+#include <iostream>
+
+namespace GG {
+
+static const int GLYPH_ATLAS_WIDTH = 512;  // plenty for printable ASCII at HUD sizes
+static const int GLYPH_PADDING = 1;
+
+/*
+================================================================================
+
+GlyphAtlas constructor
+
+    Creates an empty atlas.  Call Build before drawing anything.
+
+================================================================================
+*/
+GlyphAtlas::GlyphAtlas()
+    : mTex(NULL)
+    , mHeight(0)
+{
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        mGlyphs[i].offsetX = 0;
+        mGlyphs[i].advance = 0;
+        for (int j = 0; j < NUM_GLYPHS; j++) {
+            mKerning[i][j] = 0;
+        }
+    }
+}
+
+/*
+================================================================================
+
+GlyphAtlas destructor
+
+    Deletes the atlas texture.
+
+================================================================================
+*/
+GlyphAtlas::~GlyphAtlas()
+{
+    if (mTex) {
+        SDL_DestroyTexture(mTex);
+    }
+}
+
+/*
+================================================================================
+
+GlyphAtlas::Build
+
+    Renders each printable character of the font on its own, packs the
+    results in rows into one texture, and records the metrics and kerning
+    pairs needed for layout.
+
+    Each character is rendered the same way TTF_RenderText_Blended would
+    render a one-character string, so that the pieces line up with what
+    rendering the whole string at once would produce.
+
+================================================================================
+*/
+bool GlyphAtlas::Build(SDL_Renderer* renderer, TTF_Font* font)
+{
+    if (!renderer || !font) {
+        return false;
+    }
+
+    if (mTex) {
+        SDL_DestroyTexture(mTex);
+        mTex = NULL;
+    }
+
+    mHeight = TTF_FontHeight(font);
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* surfaces[NUM_GLYPHS];
+
+    int x = 0;
+    int y = 0;
+    int rowHeight = 0;
+
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        Uint16 ch = (Uint16)(FIRST_CHAR + i);
+        Glyph& glyph = mGlyphs[i];
+
+        glyph.src = Rect();
+        glyph.offsetX = 0;
+        glyph.advance = 0;
+        surfaces[i] = NULL;
+
+        int minX, maxX, minY, maxY, advance;
+        if (TTF_GlyphMetrics(font, ch, &minX, &maxX, &minY, &maxY, &advance) != 0) {
+            continue;   // font doesn't have it
+        }
+
+        glyph.advance = advance;
+        glyph.offsetX = minX < 0 ? minX : 0;    // the rendered glyph starts left of the pen
+
+        if (ch == ' ') {
+            continue;   // nothing to see here
+        }
+
+        char str[2] = { (char)ch, '\0' };
+        surfaces[i] = TTF_RenderText_Blended(font, str, white);
+        if (!surfaces[i]) {
+            continue;
+        }
+
+        // find a spot, starting a new row when this one is full
+        int w = surfaces[i]->w;
+        int h = surfaces[i]->h;
+        if (x + w > GLYPH_ATLAS_WIDTH) {
+            x = 0;
+            y += rowHeight + GLYPH_PADDING;
+            rowHeight = 0;
+        }
+
+        glyph.src = Rect(x, y, w, h);
+
+        x += w + GLYPH_PADDING;
+        if (h > rowHeight) {
+            rowHeight = h;
+        }
+    }
+
+    // kerning pairs, so that laying out text doesn't need the font
+    for (int prev = 0; prev < NUM_GLYPHS; prev++) {
+        for (int cur = 0; cur < NUM_GLYPHS; cur++) {
+            int k = TTF_GetFontKerningSizeGlyphs(font, (Uint16)(FIRST_CHAR + prev), (Uint16)(FIRST_CHAR + cur));
+            mKerning[prev][cur] = (signed char)(k < -128 ? -128 : (k > 127 ? 127 : k));
+        }
+    }
+
+    // put all the glyphs together
+    bool ok = false;
+
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, GLYPH_ATLAS_WIDTH, y + rowHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (atlas) {
+        for (int i = 0; i < NUM_GLYPHS; i++) {
+            if (surfaces[i]) {
+                SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(surfaces[i], NULL, atlas, &mGlyphs[i].src);
+            }
+        }
+
+        mTex = SDL_CreateTextureFromSurface(renderer, atlas);
+        if (mTex) {
+            SDL_SetTextureBlendMode(mTex, SDL_BLENDMODE_BLEND);
+            ok = true;
+        }
+
+        SDL_FreeSurface(atlas);
+    }
+
+    if (!ok) {
+        std::cerr << "*** Failed to create glyph atlas: " << SDL_GetError() << std::endl;
+    }
+
+    for (int i = 0; i < NUM_GLYPHS; i++) {
+        if (surfaces[i]) {
+            SDL_FreeSurface(surfaces[i]);
+        }
+    }
+
+    return ok;
+}
+
+/*
+================================================================================
+
+GlyphAtlas::MeasureText
+
+    Returns the width of the text in pixels, as Layout would lay it out.
+
+================================================================================
+*/
+int GlyphAtlas::MeasureText(const char* text) const
+{
+    int pen = 0;
+    int prev = -1;
+
+    for (const char* p = text; *p; p++) {
+        int c = (unsigned char)*p;
+        if (c < FIRST_CHAR || c > LAST_CHAR) {
+            prev = -1;
+            continue;
+        }
+
+        int i = c - FIRST_CHAR;
+        if (prev >= 0) {
+            pen += mKerning[prev][i];
+        }
+        pen += mGlyphs[i].advance;
+        prev = i;
+    }
+
+    return pen;
+}
+
+/*
+================================================================================
+
+GlyphAtlas::Layout
+
+    Lays out the text with its top left corner at (x, y), replacing the
+    contents of quads with one quad per visible character.  Returns the
+    width of the text, same as MeasureText.
+
+================================================================================
+*/
+int GlyphAtlas::Layout(const char* text, int x, int y, std::vector<GlyphQuad>* quads) const
+{
+    quads->clear();
+
+    int pen = x;
+    int prev = -1;
+
+    for (const char* p = text; *p; p++) {
+        int c = (unsigned char)*p;
+        if (c < FIRST_CHAR || c > LAST_CHAR) {
+            prev = -1;
+            continue;
+        }
+
+        int i = c - FIRST_CHAR;
+        if (prev >= 0) {
+            pen += mKerning[prev][i];
+        }
+
+        const Glyph& glyph = mGlyphs[i];
+        if (glyph.src.w > 0) {
+            GlyphQuad quad;
+            quad.src = glyph.src;
+            quad.dst = Rect(pen + glyph.offsetX, y, glyph.src.w, glyph.src.h);
+            quads->push_back(quad);
+        }
+
+        pen += glyph.advance;
+        prev = i;
+    }
+
+    return pen - x;
+}
+
+} // end namespace
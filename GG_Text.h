@@ -0,0 +1,91 @@
+#ifndef GG_TEXT_H_
+#define GG_TEXT_H_
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+
+#include "GG_Common.h"
+
+#include <vector>
+
+namespace GG {
+
+/*
+================================================================================
+
+GlyphQuad struct
+
+    One laid out character: where it lives in the glyph atlas texture and
+    where it goes on the screen.
+
+================================================================================
+*/
+struct GlyphQuad {
+    Rect                    src;
+    Rect                    dst;
+};
+
+/*
+================================================================================
+
+GlyphAtlas class
+
+    Holds every printable ASCII character of a font, pre-rendered into a
+    single texture, along with what's needed to lay out strings of them
+    (advances and kerning).
+
+    The atlas gets built once, and from then on text is drawn as a bunch
+    of quads through a SpriteBatch, so drawing text costs no rasterization
+    and no texture creation, no matter how often the text changes.  Layout
+    turns a string into those quads.  Since the layout only depends on the
+    text, clients can keep the quads around until the text changes.
+
+    The glyphs are rendered in white, so the text color should be applied
+    as color modulation when drawing the quads.  That way a single atlas
+    covers every text color.
+
+    Characters outside the printable ASCII range are skipped.
+
+================================================================================
+*/
+class GlyphAtlas {
+
+    enum {
+        FIRST_CHAR = 32,
+        LAST_CHAR = 126,
+        NUM_GLYPHS = LAST_CHAR - FIRST_CHAR + 1
+    };
+
+    struct Glyph {
+        Rect                src;            // where the glyph lives in the texture
+        int                 offsetX;        // where to draw it relative to the pen position
+        int                 advance;        // how far to move the pen afterwards
+    };
+
+    SDL_Texture*            mTex;
+
+    Glyph                   mGlyphs[NUM_GLYPHS];
+    signed char             mKerning[NUM_GLYPHS][NUM_GLYPHS];     // [previous][current]
+
+    int                     mHeight;        // line height in pixels
+
+public:
+                            GlyphAtlas();
+                            ~GlyphAtlas();
+
+    bool                    Build(SDL_Renderer* renderer, TTF_Font* font);
+
+    bool                    IsBuilt() const     { return mTex != NULL; }
+
+    SDL_Texture*            GetTexture() const  { return mTex; }
+
+    int                     GetHeight() const   { return mHeight; }
+
+    int                     MeasureText(const char* text) const;
+
+    int                     Layout(const char* text, int x, int y, std::vector<GlyphQuad>* quads) const;
+};
+
+} // end namespace
+
+#endif
@@ -0,0 +1,309 @@
+#include "GG_ThreadPool.h"
+#include "GG_Common.h"
+#include "GG_Profiler.h"
+
+namespace GG {
+
+// which pool's worker this thread is, and which queue is its own (the
+// threads that aren't workers have NULL here and use the shared queue)
+static GG_THREAD_LOCAL const ThreadPool* sWorkerPool = NULL;
+static GG_THREAD_LOCAL int sWorkerQueue = 0;
+
+/*
+================================================================================
+
+ThreadPool constructor
+
+    Creates a pool with no threads.  Call Start to get some going.
+
+================================================================================
+*/
+ThreadPool::ThreadPool()
+    : mNumQueued(0)
+    , mNumUnfinished(0)
+    , mStopping(false)
+{
+    mQueues.push_back(new WorkQueue);
+}
+
+/*
+================================================================================
+
+ThreadPool destructor
+
+    Finishes the queued tasks and stops the threads.
+
+================================================================================
+*/
+ThreadPool::~ThreadPool()
+{
+    Stop();
+
+    for (unsigned i = 0; i < mQueues.size(); i++) {
+        delete mQueues[i];
+    }
+}
+
+/*
+================================================================================
+
+ThreadPool::Start
+
+    Starts the given number of worker threads.  Zero is fine; the tasks
+    then run in Wait.
+
+================================================================================
+*/
+void ThreadPool::Start(int numThreads)
+{
+    Stop();
+
+    // the queues are all empty after Stop, so they can just be remade
+    for (unsigned i = 0; i < mQueues.size(); i++) {
+        delete mQueues[i];
+    }
+    mQueues.clear();
+    for (int i = 0; i < numThreads + 1; i++) {
+        mQueues.push_back(new WorkQueue);
+    }
+
+    mStopping = false;
+    for (int i = 0; i < numThreads; i++) {
+        mThreads.push_back(std::thread([this, i]() { WorkerLoop(i); }));
+    }
+}
+
+/*
+================================================================================
+
+ThreadPool::Stop
+
+    Finishes the queued tasks and then joins all the worker threads.
+
+================================================================================
+*/
+void ThreadPool::Stop()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mTaskAdded.notify_all();
+
+    for (unsigned i = 0; i < mThreads.size(); i++) {
+        mThreads[i].join();
+    }
+    mThreads.clear();
+}
+
+/*
+================================================================================
+
+ThreadPool::Submit
+
+    Queues a copy of a task.
+
+================================================================================
+*/
+void ThreadPool::Submit(const std::function<void()>& task)
+{
+    QueuedTask queued;
+    queued.function = task;
+    queued.borrowed = NULL;
+    Push(queued);
+}
+
+/*
+================================================================================
+
+ThreadPool::Submit
+
+    Queues a task without copying it.  It has to stay around until it has
+    run (Wait makes sure of that).
+
+================================================================================
+*/
+void ThreadPool::Submit(const std::function<void()>* task)
+{
+    QueuedTask queued;
+    queued.borrowed = task;
+    Push(queued);
+}
+
+/*
+================================================================================
+
+ThreadPool::Push
+
+    Queues a task: in the submitting worker's own queue if it's called from
+    a task, in the shared queue otherwise.
+
+================================================================================
+*/
+void ThreadPool::Push(const QueuedTask& task)
+{
+    WorkQueue& queue = *mQueues[sWorkerPool == this ? sWorkerQueue : GetSharedQueue()];
+
+    mNumUnfinished++;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(task);
+    }
+    mNumQueued++;
+
+    // taking the lock makes sure a worker that just found nothing to do is
+    // either still looking at mNumQueued or already asleep, not in between
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+    }
+    mTaskAdded.notify_one();
+}
+
+/*
+================================================================================
+
+ThreadPool::Wait
+
+    Helps out with the queued tasks, then waits for the ones other threads
+    are still running.
+
+================================================================================
+*/
+void ThreadPool::Wait()
+{
+    QueuedTask task;
+
+    for (;;) {
+        if (PopTask(GetSharedQueue(), &task)) {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mNumUnfinished == 0) {
+            break;
+        }
+        if (mNumQueued == 0) {
+            // the workers have taken everything; whatever they still
+            // submit, they'll take as well
+            mTaskDone.wait(lock);
+        }
+    }
+}
+
+/*
+================================================================================
+
+ThreadPool::PopTask
+
+    Takes the newest task from the given queue, or if it's empty, steals
+    the oldest one from the next queue that isn't.  Returns false if all of
+    them are empty.
+
+================================================================================
+*/
+bool ThreadPool::PopTask(int queue, QueuedTask* task)
+{
+    int numQueues = (int)mQueues.size();
+
+    for (int i = 0; i < numQueues; i++) {
+        WorkQueue& q = *mQueues[(queue + i) % numQueues];
+
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.first == q.tasks.size()) {
+            continue;
+        }
+
+        if (i == 0) {
+            *task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            *task = std::move(q.tasks[q.first]);
+            q.first++;
+        }
+        if (q.first == q.tasks.size()) {
+            q.tasks.clear();
+            q.first = 0;
+        }
+        mNumQueued--;
+        return true;
+    }
+    return false;
+}
+
+/*
+================================================================================
+
+ThreadPool::RunTask
+
+    Runs a task, and wakes up the threads in Wait when it was the last one.
+
+================================================================================
+*/
+void ThreadPool::RunTask(const QueuedTask& task)
+{
+    {
+        GG_PROFILE_SCOPE("ThreadPool.Task");
+        task.Run();
+    }
+
+    if (--mNumUnfinished == 0) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTaskDone.notify_all();
+    }
+}
+
+/*
+================================================================================
+
+ThreadPool::WorkerLoop
+
+    What each worker thread does: run tasks until told to stop.
+
+================================================================================
+*/
+void ThreadPool::WorkerLoop(int queue)
+{
+    Profiler::SetThreadName("Worker");
+
+    sWorkerPool = this;
+    sWorkerQueue = queue;
+
+    QueuedTask task;
+
+    for (;;) {
+        if (PopTask(queue, &task)) {
+            RunTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (mNumQueued == 0 && !mStopping) {
+            mTaskAdded.wait(lock);
+        }
+        if (mNumQueued == 0) {
+            break;  // stopping, and nothing left to do
+        }
+    }
+
+    sWorkerPool = NULL;
+}
+
+/*
+================================================================================
+
+ThreadPool::GetDefaultNumThreads
+
+    One worker per core, minus one for the thread that calls Wait.
+
+================================================================================
+*/
+int ThreadPool::GetDefaultNumThreads()
+{
+    int numCores = SDL_GetCPUCount();
+    return numCores > 1 ? numCores - 1 : 0;
+}
+
+} // end namespace
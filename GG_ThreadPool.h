@@ -0,0 +1,111 @@
+#ifndef GG_THREAD_POOL_H_
+#define GG_THREAD_POOL_H_
+
+#include <SDL.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GG {
+
+/*
+================================================================================
+
+ThreadPool class
+
+    A handful of worker threads that share out tasks by stealing them from
+    each other.  Every worker has a queue of its own, and threads that
+    aren't workers share one more.  A task submitted by a worker goes into
+    that worker's queue, and a task submitted by anybody else goes into
+    the shared one.  Threads take the newest task from their own queue
+    (it's the one whose data is most likely still in the cache), and when
+    that's empty, they steal the oldest task from somebody else's.
+
+    Submit queues a task, and Wait blocks until every task submitted so far
+    has finished.  The calling thread doesn't just sit there while waiting,
+    it runs tasks too.  So a pool started with GetDefaultNumThreads workers
+    keeps every core busy, and a pool with no workers at all still works
+    (everything runs inside Wait).
+
+    Tasks can submit more tasks (see TaskGraph, which submits each task as
+    soon as the ones it depends on are done), and Wait waits for those as
+    well.  Tasks must not call Wait, and they must not touch anything the
+    calling thread uses until Wait returns.
+
+    Submit copies the task it's given, and copying a std::function with
+    more than a pointer or two captured in it allocates memory.  Code that
+    submits the same tasks over and over (like TaskGraph) can keep its own
+    std::functions around instead and submit pointers to them, which
+    doesn't copy anything.
+
+    Each queue has its own lock, so threads working from their own queues
+    don't get in each other's way, but every task still costs a lock or
+    two and maybe waking a thread up.  That's nothing next to decoding a
+    file or a stage of a step with a few hundred entities in it, but it's
+    too much for a task that only takes a microsecond.
+
+================================================================================
+*/
+class ThreadPool {
+
+    struct QueuedTask {
+        std::function<void()>               function;   // a copy of the task
+        const std::function<void()>*        borrowed;   // or the submitter's own, see Submit
+
+        void                                Run() const     { borrowed ? (*borrowed)() : function(); }
+    };
+
+    // a vector instead of a deque, so that queueing tasks doesn't allocate
+    // once it's big enough: stealing just moves first along, and the whole
+    // thing gets cleared (keeping its capacity) whenever it runs empty
+    struct WorkQueue {
+        std::mutex                          mutex;
+        std::vector<QueuedTask>             tasks;
+        size_t                              first;      // tasks before this one have been stolen
+
+                                            WorkQueue() : first(0) {}
+    };
+
+    std::vector<std::thread>            mThreads;
+    std::vector<WorkQueue*>             mQueues;        // one for each worker, then the shared one
+
+    std::atomic<int>                    mNumQueued;     // tasks in all the queues together
+    std::atomic<int>                    mNumUnfinished; // tasks submitted but not finished yet
+    bool                                mStopping;
+
+    std::mutex                          mMutex;         // only for going to sleep and waking up
+    std::condition_variable             mTaskAdded;
+    std::condition_variable             mTaskDone;
+
+    int                                 GetSharedQueue() const  { return (int)mQueues.size() - 1; }
+    void                                Push(const QueuedTask& task);
+    bool                                PopTask(int queue, QueuedTask* task);
+    void                                RunTask(const QueuedTask& task);
+    void                                WorkerLoop(int queue);
+
+                                        ThreadPool(const ThreadPool&);
+    ThreadPool&                         operator= (const ThreadPool&);
+
+public:
+                                        ThreadPool();
+                                        ~ThreadPool();
+
+    void                                Start(int numThreads);
+    void                                Stop();
+
+    void                                Submit(const std::function<void()>& task);
+    void                                Submit(const std::function<void()>* task);
+    void                                Wait();
+
+    int                                 GetNumThreads() const   { return (int)mThreads.size(); }
+
+    static int                          GetDefaultNumThreads();
+};
+
+} // end namespace
+
+#endif
@@ -8,6 +8,39 @@ namespace GG {
 /*
 ================================================================================
 
+GetTicks
+
+    Reads the high resolution performance counter (QueryPerformanceCounter
+    on Windows, clock_gettime(CLOCK_MONOTONIC) on Linux).  Ticks are only
+    good for measuring differences; GetTickFrequency says how many there
+    are per second, and TicksToNs converts a difference to nanoseconds.
+
+    Reading the counter is cheap enough to do thousands of times a frame,
+    which is what the profiler does.
+
+================================================================================
+*/
+inline Uint64 GetTicks()
+{
+    return SDL_GetPerformanceCounter();
+}
+
+inline Uint64 GetTickFrequency()
+{
+    return SDL_GetPerformanceFrequency();
+}
+
+// splits the math so that it doesn't overflow 64 bits for any realistic
+// counter frequency or duration
+inline Uint64 TicksToNs(Uint64 ticks)
+{
+    Uint64 freq = GetTickFrequency();
+    return ticks / freq * 1000000000u + ticks % freq * 1000000000u / freq;
+}
+
+/*
+================================================================================
+
 Timer class
 
     This class can be used to keep track of elapsed time.
@@ -17,18 +50,21 @@ Timer class
     Once a Timer is started, the Pause and Unpause methods can be used to
     pause and unpause the timer (duh).
 
-    The GetTime method returns the current elapsed time in seconds.
-    
-    All of the methods in this class (except the constructor) assume that
-    SDL has already been initialized, since we use the SDL_GetTicks function
-    to get the system time.  SDL_GetTicks returns the number of milliseconds
-    since SDL was initialized.
+    The GetTimeNs method returns the current elapsed time in nanoseconds,
+    as a 64-bit count, so it stays exact over any session length.
+    GetTime returns it in seconds as a float, which is handy for short
+    intervals but gets coarser the longer the timer runs (to about a
+    millisecond after a few hours), so long-running things should use
+    GetTimeNs.
+
+    The time comes from the performance counter (see GetTicks), which
+    works before SDL is initialized.
 
 ================================================================================
 */
 class Timer {
-    Uint32              mTimeOffset;
-    Uint32              mPauseTime;
+    Uint64              mStartTicks;
+    Uint64              mPauseTicks;
     bool                mPaused;
 
 public:
@@ -41,27 +77,28 @@ public:
 
     bool                IsPaused() const;
 
+    Uint64              GetTimeNs() const;
     float               GetTime() const;
 };
 
 inline Timer::Timer()
-    : mTimeOffset(0)
-    , mPauseTime(0)
+    : mStartTicks(0)
+    , mPauseTicks(0)
     , mPaused(true)
 { }
 
 
 inline void Timer::Start()
 {
-    mTimeOffset = SDL_GetTicks();
-    mPauseTime = 0;
+    mStartTicks = GetTicks();
+    mPauseTicks = mStartTicks;
     mPaused = false;
 }
 
 inline void Timer::Pause()
 {
     if (!mPaused) {
-        mPauseTime = SDL_GetTicks();
+        mPauseTicks = GetTicks();
         mPaused = true;
     }
 }
@@ -69,7 +106,7 @@ inline void Timer::Pause()
 inline void Timer::Unpause()
 {
     if (mPaused) {
-        mTimeOffset += SDL_GetTicks() - mPauseTime;
+        mStartTicks += GetTicks() - mPauseTicks;
         mPaused = false;
     }
 }
@@ -79,13 +116,16 @@ inline bool Timer::IsPaused() const
     return mPaused;
 }
 
+inline Uint64 Timer::GetTimeNs() const
+{
+    // a paused timer stays at the time it was paused
+    Uint64 now = mPaused ? mPauseTicks : GetTicks();
+    return TicksToNs(now - mStartTicks);
+}
+
 inline float Timer::GetTime() const
 {
-    if (!mPaused) {
-        return 0.001f * (SDL_GetTicks() - mTimeOffset);
-    } else {
-        return 0.001f * mPauseTime;
-    }
+    return (float)(GetTimeNs() * 1e-9);
 }
 
 } // end namespace
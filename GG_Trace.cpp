@@ -0,0 +1,185 @@
+#include "GG_Trace.h"
+
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
+namespace GG {
+
+/*
+================================================================================
+
+TraceCapture constructor
+
+================================================================================
+*/
+TraceCapture::TraceCapture()
+    : mFramesLeft(0)
+    , mNumDropped(0)
+{ }
+
+/*
+================================================================================
+
+TraceCapture::Start
+
+    Starts capturing the next numFrames frames, with room for maxEvents
+    zones in all.  Returns false if a capture is already going.
+
+================================================================================
+*/
+bool TraceCapture::Start(const std::string& path, int numFrames, int maxEvents)
+{
+    if (IsCapturing()) {
+        std::cerr << "*** Already capturing a trace to " << mPath << std::endl;
+        return false;
+    }
+
+    mPath = path;
+    mFramesLeft = numFrames > 0 ? numFrames : 1;
+    mNumDropped = 0;
+
+    mEvents.clear();
+    mEvents.reserve(maxEvents);
+
+    std::cout << "*** Capturing " << mFramesLeft << " frames to " << mPath << std::endl;
+    return true;
+}
+
+/*
+================================================================================
+
+TraceCapture::AddFrame
+
+    Adds one frame's zones, and writes the file after the last frame.
+
+================================================================================
+*/
+void TraceCapture::AddFrame(const std::vector<ProfileEvent>& events)
+{
+    if (!IsCapturing()) {
+        return;
+    }
+
+    size_t room = mEvents.capacity() - mEvents.size();
+    size_t n = events.size() < room ? events.size() : room;
+    mEvents.insert(mEvents.end(), events.begin(), events.begin() + n);
+    mNumDropped += (Uint32)(events.size() - n);
+
+    if (--mFramesLeft == 0) {
+        if (Write()) {
+            std::cout << "*** Wrote " << mEvents.size() << " trace events to " << mPath;
+            if (mNumDropped > 0) {
+                std::cout << " (" << mNumDropped << " didn't fit)";
+            }
+            std::cout << std::endl;
+        }
+
+        // give the memory back, traces are rare
+        std::vector<ProfileEvent>().swap(mEvents);
+    }
+}
+
+// Writes a string as a JSON string literal
+static void WriteJsonString(FILE* f, const char* s)
+{
+    std::fputc('"', f);
+    for ( ; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            std::fputc('\\', f);
+        }
+        std::fputc(*s, f);
+    }
+    std::fputc('"', f);
+}
+
+/*
+================================================================================
+
+TraceCapture::Write
+
+    Each zone becomes a complete ("X") event, with times in microseconds
+    from the start of the capture.  The category is the part of the zone
+    name before the first dot ("Update" for "Update.Crawlers"), which the
+    trace viewers can filter by.  Named threads get a metadata event so
+    the viewers show their names.
+
+================================================================================
+*/
+bool TraceCapture::Write() const
+{
+    FILE* f = std::fopen(mPath.c_str(), "w");
+    if (!f) {
+        std::cerr << "*** Couldn't open " << mPath << " for writing" << std::endl;
+        return false;
+    }
+
+    Uint64 base = mEvents.empty() ? 0 : mEvents[0].start;
+    for (size_t i = 0; i < mEvents.size(); i++) {
+        base = mEvents[i].start < base ? mEvents[i].start : base;
+    }
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    std::vector<const char*> threadNames;
+    Profiler::GetThreadNames(&threadNames);
+
+    bool first = true;
+    for (size_t t = 0; t < threadNames.size(); t++) {
+        if (threadNames[t]) {
+            std::fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                         first ? "" : ",\n", (unsigned)t);
+            WriteJsonString(f, threadNames[t]);
+            std::fprintf(f, "}}");
+            first = false;
+        }
+    }
+
+    for (size_t i = 0; i < mEvents.size(); i++) {
+        const ProfileEvent& e = mEvents[i];
+
+        char category[64];
+        size_t len = 0;
+        while (e.name[len] && e.name[len] != '.' && len + 1 < sizeof(category)) {
+            category[len] = e.name[len];
+            len++;
+        }
+        category[len] = '\0';
+
+        std::fprintf(f, "%s{\"name\":", first ? "" : ",\n");
+        WriteJsonString(f, e.name);
+        std::fprintf(f, ",\"cat\":");
+        WriteJsonString(f, category);
+        std::fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     (unsigned)e.threadId, TicksToNs(e.start - base) * 1e-3, TicksToNs(e.end - e.start) * 1e-3);
+        first = false;
+    }
+
+    std::fprintf(f, "\n]}\n");
+
+    bool ok = std::ferror(f) == 0;
+    if (std::fclose(f) != 0 || !ok) {
+        std::cerr << "*** Error writing " << mPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+================================================================================
+
+MakeTimestampedName
+
+================================================================================
+*/
+std::string MakeTimestampedName(const char* prefix, const char* suffix)
+{
+    std::time_t now = std::time(NULL);
+
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", std::localtime(&now));
+
+    return std::string(prefix) + stamp + suffix;
+}
+
+} // end namespace
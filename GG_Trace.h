@@ -0,0 +1,66 @@
+#ifndef GG_TRACE_H_
+#define GG_TRACE_H_
+
+#include "GG_Profiler.h"
+
+#include <string>
+#include <vector>
+
+namespace GG {
+
+/*
+================================================================================
+
+TraceCapture class
+
+    Records the profiling zones of a number of frames and writes them out
+    as a Chrome trace-event JSON file, which chrome://tracing and the
+    Perfetto UI (ui.perfetto.dev) can open to show a timeline of every
+    zone on every thread.
+
+    Start sets up a capture and AddFrame takes in each frame's zones (from
+    Profiler::Collect) until the requested number of frames is reached,
+    at which point the file gets written.  The profiler has to be on for
+    there to be anything to capture.
+
+    The buffer for the events is allocated in full by Start, so that the
+    capture doesn't allocate (or move a lot of memory around) in the
+    middle of the frames it's measuring.  Events that don't fit get
+    dropped and counted.  Writing the file happens after the last frame,
+    so it doesn't show up in the trace either.
+
+================================================================================
+*/
+class TraceCapture {
+    std::vector<ProfileEvent>   mEvents;
+    std::string             mPath;
+    int                     mFramesLeft;
+    Uint32                  mNumDropped;
+
+    bool                    Write() const;
+
+public:
+                            TraceCapture();
+
+    bool                    Start(const std::string& path, int numFrames, int maxEvents);
+    bool                    IsCapturing() const     { return mFramesLeft > 0; }
+
+    void                    AddFrame(const std::vector<ProfileEvent>& events);
+};
+
+/*
+================================================================================
+
+MakeTimestampedName
+
+    Returns prefix + the current local date and time + suffix, like
+    "trace-20140412-153012.json", for files that shouldn't overwrite the
+    ones from earlier runs.
+
+================================================================================
+*/
+std::string MakeTimestampedName(const char* prefix, const char* suffix);
+
+} // end namespace
+
+#endif
@@ -1,9 +1,35 @@
 #include "Game.h"
 #include "Level.h"
+#include "GG_Memory.h"
+#include "GG_Cpu.h"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <sstream>
 
+// the length of a simulation step (see SIM_STEP) in nanoseconds, which is
+// what the real time gets counted in
+static const Uint64 SIM_STEP_NS = 1000000000 / SIM_RATE;
+
+// how many frames T captures for the trace viewer, and room for their zones
+// (a few dozen zones a frame normally, far more on a frame that loads stuff)
+static const int TRACE_FRAMES = 120;
+static const int TRACE_MAX_EVENTS = 256 * 1024;
+
+// how many steps --headless runs in each scene, unless told otherwise
+// (a minute of game time)
+static const int HEADLESS_STEPS = 60 * SIM_RATE;
+
+// how many steps each world in a --batch run gets, unless told otherwise
+// (ten seconds of game time)
+static const int BATCH_STEPS = 10 * SIM_RATE;
+
+// frames that take longer than this (like a breakpoint, or dragging the
+// window around) only get this much simulation, instead of a long burst
+// of steps that would take even longer to run
+static const Uint64 MAX_FRAME_TIME_NS = 250000000;
+
 /*
 ================================================================================
 
@@ -24,13 +50,34 @@ Game::Game()
     , mScrWidth(0)
     , mScrHeight(0)
     , mTexMgr(NULL)
+    , mClips(NULL)
+    , mSpriteBatch(NULL)
+    , mWorkers(NULL)
+	, mAssetPack(new GG::AssetPack)
+	, mPackPath("media/assets.pak")
+	, mLooseFiles(false)
+	, mHeadless(false)
+	, mHeadlessSteps(HEADLESS_STEPS)
+	, mAudioOpen(false)
+	, mBatchWorlds(0)
+	, mBatchSteps(BATCH_STEPS)
+	, mWorld(NULL)
+	, mReplaying(false)
+	, mPendingInput(0)
+	, mStepInput(0)
     , mShouldQuit(false)
-    , mTime(0.0f)
-	, mMeteorTime(0.0f)
-    , mGrid(NULL)
-	, mRobot(NULL)
-	, mScene(0)
+    , mFrameTimeNs(0)
+    , mStepAccumulatorNs(0)
+    , mStepAlpha(1.0f)
+    , mNumProfiledFrames(0)
+    , mPrintProfile(false)
+    , mHitchBudgetMs(-1.0f)
+	, mSceneCache(NULL)
+	, mHud(NULL)
+	, mProfilerOverlay(NULL)
+	, mOverlayVisible(false)
 	, rectVisible(0)
+	, mStatsTime(0.0f)
 	, mCoinSound(NULL)
 	, mJumpSound(NULL)
 	, mStompSound(NULL)
@@ -38,18 +85,10 @@ Game::Game()
 	, mDieSound(NULL)
 	, mBlockSound(NULL)
 	, mThudSound(NULL)
+	, mOneupSound(NULL)
+	, mMusic(NULL)
 	, mGoodGameOverMusic(NULL)
 	, mBadGameOverMusic(NULL)
-	, mMusic(NULL)
-	, mCoins(NULL)
-	, mBackground(NULL)
-	, mForeground(NULL)
-	, mFlagPole(NULL)
-	, mPointsLabel(NULL)
-	, mLivesLabel(NULL)
-	, mPoints(0)
-	, mFlashTime(0.0f)
-	, mFlashesNeeded(0.0f)
 {
 }
 
@@ -86,6 +125,129 @@ Game* Game::GetInstance()
 /*
 ================================================================================
 
+Game::Configure
+
+    Handles the command line, before Run.  Returns false if the game
+    shouldn't run afterwards (because the arguments were bad, or because
+    they asked for a tool instead of the game).
+
+      --pack <file>         load images and levels from this asset pack
+                            (media/assets.pak by default, if it exists)
+      --loose               load the loose files in media/, even if there's a pack
+      --build-pack [file]   decode everything in media/ into an asset pack and quit
+      --headless [steps]    run each scene for this many simulation steps with
+                            no window, renderer or audio, as fast as possible,
+                            report the steps per second and quit (with
+                            --replay, run the recording instead)
+      --batch <worlds> [steps]
+                            simulate this many independent worlds for this
+                            many steps each (headless), first on one thread
+                            and then on every core, report the steps per
+                            second of both and quit
+      --record <file>       record the random seed and every step's input
+      --replay <file>       play a recording back instead of reading the keyboard
+      --hitch-budget <ms>   dump the last few seconds of frames when one takes
+                            longer than this (two display refreshes by default,
+                            0 turns it off)
+
+    Comparing the startup reports of --loose and --pack runs shows what the
+    pack buys, both right after a reboot (cold file cache) and on a second
+    run (warm file cache).
+
+================================================================================
+*/
+bool Game::Configure(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--pack" && i + 1 < argc)
+		{
+			mPackPath = argv[++i];
+			mLooseFiles = false;
+		}
+		else if (arg == "--loose")
+		{
+			mLooseFiles = true;
+		}
+		else if (arg == "--build-pack")
+		{
+			std::string path = (i + 1 < argc) ? argv[++i] : mPackPath;
+			BuildAssetPack("media/", path);
+			return false;
+		}
+		else if (arg == "--profile")
+		{
+			mPrintProfile = true;
+			UpdateProfilerEnabled();
+		}
+		else if (arg == "--trace")
+		{
+			// capture the startup and the first few frames
+			int numFrames = (i + 1 < argc && argv[i + 1][0] != '-') ? std::atoi(argv[++i]) : TRACE_FRAMES;
+			StartTrace(numFrames);
+		}
+		else if (arg == "--headless")
+		{
+			mHeadless = true;
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+			{
+				mHeadlessSteps = std::atoi(argv[++i]);
+			}
+		}
+		else if (arg == "--batch" && i + 1 < argc)
+		{
+			mHeadless = true;
+			mBatchWorlds = std::atoi(argv[++i]);
+			if (i + 1 < argc && argv[i + 1][0] != '-')
+			{
+				mBatchSteps = std::atoi(argv[++i]);
+			}
+			if (mBatchWorlds <= 0 || mBatchSteps <= 0)
+			{
+				std::cerr << "*** --batch needs a number of worlds and steps above 0" << std::endl;
+				return false;
+			}
+		}
+		else if (arg == "--record" && i + 1 < argc)
+		{
+			mRecordPath = argv[++i];
+		}
+		else if (arg == "--replay" && i + 1 < argc)
+		{
+			if (!mReplay.Load(argv[++i]))
+			{
+				return false;
+			}
+
+			// everything random from here on comes out the way it did
+			GG::InitRandom(mReplay.GetSeed());
+			mReplaying = true;
+		}
+		else if (arg == "--hitch-budget" && i + 1 < argc)
+		{
+			mHitchBudgetMs = (float)std::atof(argv[++i]);
+		}
+		else if (arg == "--bench-collision")
+		{
+			GG::BenchmarkOverlap(2048, 20);
+			return false;
+		}
+		else
+		{
+			std::cerr << "*** Unknown argument '" << arg << "'" << std::endl;
+			std::cerr << "*** Usage: " << argv[0] << " [--pack <file> | --loose | --profile | --trace [frames] | --hitch-budget <ms> | --headless [steps] | --batch <worlds> [steps] | --record <file> | --replay <file> | --build-pack [file] | --bench-collision]" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+================================================================================
+
 Game::Run
 
     Manages the key stages of the game: initialization, main loop, and cleanup.
@@ -95,6 +257,15 @@ Game::Run
 */
 void Game::Run()
 {
+	GG::Profiler::SetThreadName("Main");
+
+	// the seed is set by now (by main, or by --replay), and nothing random
+	// has happened yet
+	if (!mRecordPath.empty())
+	{
+		mRecording.Start(GG::GetRandomSeed());
+	}
+
     // startup
     if (!Initialize())
 	{
@@ -102,35 +273,121 @@ void Game::Run()
         return;
     }
 
+	// no window, just the simulation as fast as it goes
+	if (mHeadless)
+	{
+		if (mBatchWorlds > 0)
+		{
+			RunBatch();
+		}
+		else
+		{
+			RunHeadless();
+		}
+		Shutdown();
+		return;
+	}
+
     // start timing
     mTimer.Start();
-    mTime = 0.0f;
+    mFrameTimeNs = 0;
+    mStepAccumulatorNs = 0;
+    mStepAlpha = 1.0f;
     
     // main loop
     mShouldQuit = false;
     while (!mShouldQuit)
 	{
+		Uint64 frameAllocations = GG::GetNumAllocations();
+		Uint64 frameSteps = mWorld->GetNumSteps();
+		mFrameInput.numEvents = 0;
+		mFrameInput.numKeysPressed = 0;
 
-        // dispatch events
-        SDL_Event e;
-        while (SDL_PollEvent(&e))
 		{
-            HandleEvent(e);
-        }
+			GG_PROFILE_SCOPE("Frame");
+
+			// dispatch events
+			{
+				GG_PROFILE_SCOPE("Events");
+				SDL_Event e;
+				while (SDL_PollEvent(&e))
+				{
+					mFrameInput.numEvents++;
+					HandleEvent(e);
+				}
+
+			}
+
+			// only run the simulation if we're not paused
+			if (!mTimer.IsPaused())
+			{
+				// get time elapsed since last frame
+				Uint64 now = mTimer.GetTimeNs();
+				Uint64 frameTime = now - mFrameTimeNs;
+				mFrameTimeNs = now;
+				if (frameTime > MAX_FRAME_TIME_NS)
+				{
+					frameTime = MAX_FRAME_TIME_NS;
+				}
 
-        // draw this frame
-        Draw();
+				// run as many fixed steps as fit in the time that has passed,
+				// and carry the rest over to the next frame
+				mStepAccumulatorNs += frameTime;
+				while (mStepAccumulatorNs >= SIM_STEP_NS)
+				{
+					Step();
+					mStepAccumulatorNs -= SIM_STEP_NS;
+				}
 
-        // only run update if we're not paused
-        if (!mTimer.IsPaused())
+				// how far we are between the last two steps
+				mStepAlpha = (float)mStepAccumulatorNs / SIM_STEP_NS;
+			}
+
+			// draw this frame
+			Draw();
+		}
+
+		// what the simulation played with (in the last step, if there was one)
+		mFrameInput.input = mStepInput;
+
+		// gather up this frame's zones (the frame's own zone has ended by
+		// now).  This happens even with the profiler off, so that zones that
+		// were still open when it got turned off don't linger until the next
+		// time it's turned on.
+		mProfileEvents.clear();
+		GG::Profiler::Collect(&mProfileEvents);
+		if (GG::Profiler::IsEnabled() && !mProfileEvents.empty())
 		{
-            // get time elapsed since last frame
-            float now = mTimer.GetTime();
-            float dt = now - mTime;
-            mTime = now;
-            // run game logic for this frame
-            Update(dt);
-        }
+			if (mPrintProfile)
+			{
+				mProfileSummary.Add(mProfileEvents);
+				mNumProfiledFrames++;
+			}
+
+			if (mTrace.IsCapturing())
+			{
+				mTrace.AddFrame(mProfileEvents);
+				if (!mTrace.IsCapturing())
+				{
+					UpdateProfilerEnabled();
+				}
+			}
+
+			FrameCounters counters;
+			counters.numDrawCalls = mSpriteBatch->GetNumDrawCalls();
+			counters.numSprites = mSpriteBatch->GetNumSprites();
+			counters.numEntities = mWorld->GetEntities()->GetCount();
+			counters.numAllocations = (int)(GG::GetNumAllocations() - frameAllocations);
+			counters.numSteps = (int)(mWorld->GetNumSteps() - frameSteps);
+
+			if (mOverlayVisible)
+			{
+				mProfilerOverlay->AddFrame(mProfileEvents, counters);
+			}
+
+			// this may write a file, which is why it comes after the frame's zones
+			mHitchRecorder.AddFrame(mProfileEvents, counters, mFrameInput);
+		}
     }
 
     // cleanup
@@ -140,6 +397,208 @@ void Game::Run()
 /*
 ================================================================================
 
+Game::RunHeadless
+
+    The main loop for --headless: runs the simulation as fast as possible,
+    with nothing drawn and nothing played, and reports the steps per
+    second, which is the number to watch when optimizing the game logic.
+    With --profile, the summary at exit shows where the time went, per
+    step.
+
+    With --replay, it plays out the whole recording, which makes for the
+    same workload on every run.  Otherwise it loads each scene in turn,
+    with a fresh robot, and runs mHeadlessSteps steps in it.  Nobody
+    presses any keys then, so the robot stands where it starts while the
+    crawlers, coins and meteors do their thing.
+
+================================================================================
+*/
+void Game::RunHeadless()
+{
+	Uint64 totalNs = 0;
+	Uint64 totalSteps = 0;
+	int maxEntities = 0;
+
+	if (mReplaying)
+	{
+		std::cout << "*** Replaying " << mReplay.GetNumSteps() << " steps, headless" << std::endl;
+
+		totalSteps = mReplay.GetNumSteps();
+		totalNs = RunHeadlessSteps((int)totalSteps, &maxEntities);
+	}
+	else
+	{
+		std::cout << "*** Running " << mHeadlessSteps << " steps in each of " << NUM_LEVEL_FILES << " scenes, headless" << std::endl;
+
+		for (int scene = 0; scene < NUM_LEVEL_FILES; scene++)
+		{
+			// start over, so the scenes don't depend on each other
+			mWorld->Reset(scene);
+
+			Uint64 ns = RunHeadlessSteps(mHeadlessSteps, &maxEntities);
+			totalNs += ns;
+			totalSteps += mHeadlessSteps;
+
+			std::cout << "*** Scene " << scene << ": " << mHeadlessSteps << " steps in " << ns * 1e-6 << " ms, "
+			          << (ns > 0 ? mHeadlessSteps * 1e9 / ns : 0.0) << " steps/s (up to "
+			          << maxEntities << " entities)" << std::endl;
+		}
+	}
+
+	if (GG::Profiler::IsEnabled())
+	{
+		mProfileEvents.clear();
+		GG::Profiler::Collect(&mProfileEvents);
+		mProfileSummary.Add(mProfileEvents);
+		mNumProfiledFrames = (int)totalSteps;
+	}
+
+	std::cout << "*** " << totalSteps << " steps in " << totalNs * 1e-6 << " ms, "
+	          << (totalNs > 0 ? totalSteps * 1e9 / totalNs : 0.0) << " steps/s, "
+	          << (totalSteps > 0 ? totalNs * 1e-3 / totalSteps : 0.0) << " us/step" << std::endl;
+}
+
+// Runs numSteps steps with nothing else going on, and returns how long
+// they took (in nanoseconds)
+Uint64 Game::RunHeadlessSteps(int numSteps, int* maxEntities)
+{
+	GG::Timer timer;
+	timer.Start();
+
+	*maxEntities = 0;
+	for (int step = 0; step < numSteps; step++)
+	{
+		Step();
+
+		*maxEntities = std::max(*maxEntities, mWorld->GetEntities()->GetCount());
+
+		// the profiler's buffers only hold a few hundred steps' worth
+		if (GG::Profiler::IsEnabled() && step % 256 == 255)
+		{
+			mProfileEvents.clear();
+			GG::Profiler::Collect(&mProfileEvents);
+			mProfileSummary.Add(mProfileEvents);
+		}
+	}
+
+	return timer.GetTimeNs();
+}
+
+/*
+================================================================================
+
+Game::RunBatch
+
+    The main loop for --batch: simulates mBatchWorlds independent worlds
+    for mBatchSteps steps each, first with every world on this thread and
+    then with the worlds spread over the worker threads as well, and
+    reports the steps per second of both.  Each world has its own seed and
+    starts in its own scene (they take turns), and nobody presses any
+    keys.
+
+    The worlds share nothing but the textures and levels, which nobody
+    changes, so they need no locks, and the second pass should be about
+    as many times faster as there are threads.  Both passes have to end
+    up with the same worlds, which gets checked at the end: a world that
+    came out differently on another thread would mean that some state is
+    shared between worlds after all.
+
+================================================================================
+*/
+void Game::RunBatch()
+{
+	std::cout << "*** Simulating " << mBatchWorlds << " worlds for " << mBatchSteps << " steps each, headless" << std::endl;
+
+	// the zones of thousands of steps on every thread wouldn't fit in the
+	// profiler's buffers, and recording them would get in the way of scaling
+	if (mPrintProfile)
+	{
+		std::cout << "*** (--profile doesn't apply to --batch runs)" << std::endl;
+		mPrintProfile = false;
+	}
+	GG::Profiler::SetEnabled(false);
+
+	GG::ThreadPool serial;		// no workers, the tasks run in Wait
+	std::vector<Uint32> serialChecksums;
+	Uint64 serialNs = RunBatchPass(&serial, &serialChecksums);
+
+	std::vector<Uint32> parallelChecksums;
+	Uint64 parallelNs = RunBatchPass(mWorkers, &parallelChecksums);
+
+	Uint64 totalSteps = (Uint64)mBatchWorlds * mBatchSteps;
+	double serialRate = serialNs > 0 ? totalSteps * 1e9 / serialNs : 0.0;
+	double parallelRate = parallelNs > 0 ? totalSteps * 1e9 / parallelNs : 0.0;
+
+	std::cout << "*** 1 thread: " << totalSteps << " steps in " << serialNs * 1e-6 << " ms, "
+	          << serialRate << " steps/s" << std::endl;
+	std::cout << "*** " << mWorkers->GetNumThreads() + 1 << " threads: " << totalSteps << " steps in "
+	          << parallelNs * 1e-6 << " ms, " << parallelRate << " steps/s ("
+	          << (serialRate > 0.0 ? parallelRate / serialRate : 0.0) << " times as many)" << std::endl;
+
+	if (serialChecksums != parallelChecksums)
+	{
+		std::cerr << "*** Some worlds came out differently on more threads, they aren't independent" << std::endl;
+	}
+}
+
+// Runs all the worlds of a batch as tasks on pool, puts each world's
+// checksum at the end in checksums, and returns how long it all took
+// (in nanoseconds)
+Uint64 Game::RunBatchPass(GG::ThreadPool* pool, std::vector<Uint32>* checksums)
+{
+	checksums->assign(mBatchWorlds, 0);
+
+	WorldAssets assets = GetWorldAssets();
+	unsigned seed = GG::GetRandomSeed();
+	int numSteps = mBatchSteps;
+
+	GG::Timer timer;
+	timer.Start();
+
+	for (int w = 0; w < mBatchWorlds; w++)
+	{
+		Uint32* checksum = &(*checksums)[w];
+		pool->Submit([assets, seed, w, numSteps, checksum]()
+		{
+			World world(assets, seed + w, NULL);
+			world.Reset(w % NUM_LEVEL_FILES);
+
+			for (int step = 0; step < numSteps; step++)
+			{
+				world.Step(0);
+			}
+
+			*checksum = world.ComputeChecksum();
+		});
+	}
+	pool->Wait();
+
+	return timer.GetTimeNs();
+}
+
+/*
+================================================================================
+
+Game::GetWorldAssets
+
+    What every world shares (see WorldAssets).  The textures, clips
+    and levels have to be loaded by now.
+
+================================================================================
+*/
+WorldAssets Game::GetWorldAssets() const
+{
+	WorldAssets assets;
+	assets.clips = mClips;
+	assets.levels = &mLevels;
+	assets.width = mScrWidth;
+	assets.height = mScrHeight;
+	return assets;
+}
+
+/*
+================================================================================
+
 Game::Initialize
 
     Performs the bulk of game initialization.  Creates a window, renderer, and
@@ -150,6 +609,8 @@ Game::Initialize
 */
 bool Game::Initialize()
 {
+	Uint64 startupStart = SDL_GetPerformanceCounter();
+
 	// Instructions:
     std::cout << "***" << std::endl;
     std::cout << "*** Press A and D to move left and right" << std::endl;
@@ -157,6 +618,8 @@ bool Game::Initialize()
 	std::cout << "*** Press K to remove all the crawlers from a scene!" << std::endl;
 	std::cout << "*** Press P to pause/unpause the game" << std::endl;
 	std::cout << "*** Press V to show/hide the collision rectangles" << std::endl;
+	std::cout << "*** Press F to show/hide the frame profiler" << std::endl;
+	std::cout << "*** Press T to capture a trace of the next " << TRACE_FRAMES << " frames (for chrome://tracing)" << std::endl;
 	std::cout << "*** Press 9 to stop/play background music" << std::endl;
 	std::cout << "*** Press X to add a strong crawler on the ground tiles" << std::endl;
 	std::cout << "*** Press C to add a weak crawler on the ground tiles" << std::endl;
@@ -167,8 +630,8 @@ bool Game::Initialize()
 	std::cout << "*** You have a total of 5 lives to begin with" << std::endl;
     std::cout << "***" << std::endl;
 
-    // initialize SDL
-    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    // initialize SDL (only the timer and events without a window)
+    if (SDL_Init(mHeadless ? 0 : SDL_INIT_VIDEO) < 0)
 	{
         std::cerr << "*** Failed to initialize SDL: " << SDL_GetError() << std::endl;
         return false;
@@ -184,22 +647,9 @@ bool Game::Initialize()
     mScrWidth = 640;
     mScrHeight = 480;
 
-    // create a window
-    mWindow = SDL_CreateWindow("C++ Final Project",
-                               SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                               mScrWidth, mScrHeight,
-                               SDL_WINDOW_SHOWN /*| SDL_WINDOW_RESIZABLE*/);
-    if (!mWindow)
-	{
-        std::cerr << "*** Failed to create window: " << SDL_GetError() << std::endl;
-        return false;
-    }
-
-    // create a renderer that takes care of drawing stuff to the window
-    mRenderer = SDL_CreateRenderer(mWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-    if (!mRenderer)
+    // the window, renderer and sprite batch (headless runs have none)
+    if (!mHeadless && !OpenDisplay())
 	{
-        std::cerr << "*** Failed to create renderer: " << SDL_GetError() << std::endl;
         return false;
     }
 
@@ -222,50 +672,144 @@ bool Game::Initialize()
         return false;
     }
 
-	//Initialize SDL Audio
-	if (SDL_INIT_AUDIO < 0)
+	// give the built-in textures the ids the entities know them by
+	if (!InternTextureIds(mTexMgr))
 	{
-		std::cerr << "SDL audio not initialize! SDL Error: " << SDL_GetError() << std::endl;
 		return false;
 	}
 
-	//Initialize SDL_mixer
-	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0)
+	// the audio device (headless runs have a null mixer: the sounds don't get
+	// loaded, and PlayChunk, PlayMusic and friends do nothing)
+	if (!mHeadless && !OpenAudio())
 	{
-		std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
 		return false;
 	}
 
-	//Load musicIn
-	mMusic = Mix_LoadMUS("media/music.mp3");
-	mGoodGameOverMusic = Mix_LoadMUS("media/gameover_music.wav");
-	mBadGameOverMusic = Mix_LoadMUS("media/gameover_music.mp3");
-	if (mMusic == NULL || mGoodGameOverMusic == NULL || mBadGameOverMusic == NULL)
+    // decode the textures and sounds on every core (only the uploads happen on this thread)
+	Uint64 assetsStart = SDL_GetPerformanceCounter();
+
+	// images and levels come from the asset pack if there is one (see Configure)
+	if (!mLooseFiles && mAssetPack->Open(mPackPath))
+	{
+		std::cout << "*** Loading assets from '" << mPackPath << "'" << std::endl;
+	}
+	else
+	{
+		std::cout << "*** Loading assets from loose files" << std::endl;
+	}
+
+	mWorkers = new GG::ThreadPool;
+	mWorkers->Start(GG::ThreadPool::GetDefaultNumThreads());
+
+    // load textures (packed into atlas pages to cut down on texture switches)
+	mTexMgr->BeginAtlas(mWorkers);
+	LoadTextures();
+
+	if (mAudioOpen)
+	{
+		//Load musicIn (SDL_mixer isn't busy on the workers yet, so this is safe)
+		mMusic = Mix_LoadMUS("media/music.mp3");
+		mGoodGameOverMusic = Mix_LoadMUS("media/gameover_music.wav");
+		mBadGameOverMusic = Mix_LoadMUS("media/gameover_music.mp3");
+
+		//loading the Coin Sound
+		LoadSounds();
+	}
+
+	// wait for the decoding, then pack and upload
+	bool atlasBuilt = mTexMgr->EndAtlas();
+
+	// EndAtlas only waits if there were textures to decode (not with the
+	// asset pack), so wait for the sounds here
+	mWorkers->Wait();
+
+	if (!atlasBuilt)
+	{
+		std::cerr << "*** Failed to build the texture atlas" << std::endl;
+		return false;
+	}
+
+	// the clips every sprite plays (they need the sizes of the textures)
+	mClips = new GG::ClipLibrary;
+	if (!RegisterClips(mClips, mTexMgr))
+	{
+		return false;
+	}
+
+	if (mAudioOpen && (mMusic == NULL || mGoodGameOverMusic == NULL || mBadGameOverMusic == NULL))
 	{
 		std::cerr << " Failed to load beat music! SDL_mixer Error:" << Mix_GetError() << std::endl;
 		return false;
 	}
-	//loading the Coin Sound
-	LoadSounds();
-	if (mCoinSound == NULL || mJumpSound == NULL || mStompSound == NULL || 
-		mDieSound == NULL || mStompSoundNoKill == NULL || mBlockSound == NULL)
+	if (mAudioOpen && (mCoinSound == NULL || mJumpSound == NULL || mStompSound == NULL || 
+		mDieSound == NULL || mStompSoundNoKill == NULL || mBlockSound == NULL))
 	{
 		std::cerr << "*** Failed to initialize mCoinSound" << Mix_GetError()<<std::endl;
 		return false;
 	}
 
-    // load textures
-	LoadTextures();
-	LoadGrayscaleTextures();
+	// every scene's level gets read once, and built from memory whenever a world loads it
+	if (!LoadLevels())
+	{
+		return false;
+	}
+	Uint64 assetsEnd = SDL_GetPerformanceCounter();
+
+	// set up the render targets for the static part of each scene
+	mSceneCache = new SceneCache;
+	if (mRenderer)
+	{
+		mSceneCache->Initialize(mRenderer, mScrWidth, mScrHeight);
+	}
+
+	// the world we play in (a batch run makes its own), seeded the way the
+	// recording or the replay says (see Run and Configure)
+	if (mBatchWorlds == 0)
+	{
+		mWorld = new World(GetWorldAssets(), GG::GetRandomSeed(), this);
+		mWorld->SetWorkers(mWorkers);	// the assets are loaded, so the workers are free
+		mWorld->Reset(0);
+	}
+
+	// initialize the HUD (the counters keep themselves up to date)
+	mHud = new Hud;
+	SDL_Color pointsColor = {0, 0, 0, 255};
+	mHud->Add(new Counter(10.0f, -5.0f, "Points = ", pointsColor, [this]() { return mWorld ? mWorld->GetPoints() : 0; }));
+	SDL_Color livesColor = {255, 50, 50, 255};
+	mHud->Add(new Counter(140.0f, -5.0f, "Lives = ", livesColor, [this]() { return mWorld ? mWorld->GetRobot()->GetLives() : 0; }));
 
-    // initialize grid from a text file (including crawlers and coins!)
-    LoadScene(mScene, true);
+	// the profiler overlay goes in the top right corner (F shows it)
+	mProfilerOverlay = new ProfilerOverlay(mScrWidth - 330, 30, SIM_STEP * 1000.0f);
 
-	// initialize the robot
-	mRobot = new Robot(35.0f, mScrHeight-160.0f);
+	// a frame that misses two vsyncs in a row is a hitch, unless told otherwise
+	// (headless runs have no frames)
+	if (mHeadless)
+	{
+		mHitchBudgetMs = 0.0f;
+	}
+	else if (mHitchBudgetMs < 0.0f)
+	{
+		SDL_DisplayMode mode;
+		int refreshRate = 60;
+		if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(mWindow), &mode) == 0 && mode.refresh_rate > 0)
+		{
+			refreshRate = mode.refresh_rate;
+		}
+		mHitchBudgetMs = 2.0f * 1000.0f / refreshRate;
+	}
+	mHitchRecorder.SetBudgetNs((Uint64)(mHitchBudgetMs * 1000000.0f));
+	UpdateProfilerEnabled();
+	if (mHitchRecorder.IsEnabled())
+	{
+		std::cout << "*** Frames over " << mHitchBudgetMs << " ms get written to hitch-<date>-<time>.txt" << std::endl;
+	}
 
-	// initialize the foreground
-	mForeground = new Layer(0.0f, 0.0f, 800.0f, 480.0f, "Foreground", "Foreground2");
+	// startup timing report
+	double msPerTick = 1000.0 / SDL_GetPerformanceFrequency();
+	std::cout << "*** Startup took " << (SDL_GetPerformanceCounter() - startupStart) * msPerTick << " ms ("
+	          << (assetsEnd - assetsStart) * msPerTick << " ms loading assets from "
+	          << (mAssetPack->IsOpen() ? "the asset pack" : "loose files") << " on "
+	          << mWorkers->GetNumThreads() + 1 << " threads)" << std::endl;
 
     return true;
 }
@@ -273,6 +817,75 @@ bool Game::Initialize()
 /*
 ================================================================================
 
+Game::OpenDisplay
+
+    Creates the window, the renderer that draws to it, and the sprite
+    batch that collects everything we draw in a frame.
+
+================================================================================
+*/
+bool Game::OpenDisplay()
+{
+    // create a window
+    mWindow = SDL_CreateWindow("C++ Final Project",
+                               SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                               mScrWidth, mScrHeight,
+                               SDL_WINDOW_SHOWN /*| SDL_WINDOW_RESIZABLE*/);
+    if (!mWindow)
+	{
+        std::cerr << "*** Failed to create window: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // create a renderer that takes care of drawing stuff to the window
+    mRenderer = SDL_CreateRenderer(mWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
+    if (!mRenderer)
+	{
+        std::cerr << "*** Failed to create renderer: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // create a sprite batch that collects everything we draw in a frame
+    mSpriteBatch = new GG::SpriteBatch;
+    mSpriteBatch->Initialize(mRenderer);
+
+    return true;
+}
+
+/*
+================================================================================
+
+Game::OpenAudio
+
+    Opens the audio device through SDL_mixer.  Until this succeeds, the
+    game has a null mixer: none of the sounds get loaded, and the Game
+    methods that play and stop them do nothing.
+
+================================================================================
+*/
+bool Game::OpenAudio()
+{
+	//Initialize SDL Audio
+	if (SDL_INIT_AUDIO < 0)
+	{
+		std::cerr << "SDL audio not initialize! SDL Error: " << SDL_GetError() << std::endl;
+		return false;
+	}
+
+	//Initialize SDL_mixer
+	if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0)
+	{
+		std::cerr << "SDL_mixer could not initialize! SDL_mixer Error: " << Mix_GetError() << std::endl;
+		return false;
+	}
+
+	mAudioOpen = true;
+	return true;
+}
+
+/*
+================================================================================
+
 Game::Shutdown
 
     Performs cleanup after the game ends.  Deletes any active entities,
@@ -282,6 +895,16 @@ Game::Shutdown
 */
 void Game::Shutdown()
 {
+	if (mPrintProfile && mNumProfiledFrames > 0)
+	{
+		mProfileSummary.Print(mNumProfiledFrames);
+	}
+
+	if (!mRecordPath.empty() && mRecording.Save(mRecordPath))
+	{
+		std::cout << "*** Recorded " << mRecording.GetNumSteps() << " steps to " << mRecordPath << std::endl;
+	}
+
 	//Frees the sound chunks and sets it to NULL
 	Mix_FreeChunk(mCoinSound);
 	mCoinSound = NULL;
@@ -307,63 +930,39 @@ void Game::Shutdown()
 	//We also need to quit the mixer
 	Mix_Quit();
 
-	delete mRobot;
-	mRobot = NULL;
-
-    // delete grid
-    delete mGrid;
-    mGrid = NULL;
-
-    // delete all explosions
-    std::list<Explosion*>::iterator it = mExplosions.begin();
-    for ( ; it != mExplosions.end(); ++it)
-	{
-        delete *it;
-    }
-    mExplosions.clear();
-
-	// delete all meteors
-    std::list<Meteor*>::iterator metIt = mMeteors.begin();
-    for ( ; metIt != mMeteors.end(); ++metIt) {
-        delete *metIt;
-    }
-    mMeteors.clear();
-
-	// delete all crawlers and clear the list
-    std::list<Crawler*>::iterator crawlerIter = mCrawlers.begin();
-    for ( ; crawlerIter != mCrawlers.end(); ++crawlerIter)
+    // delete the world (and all the entities in it)
+	if (mWorld)
 	{
-        Crawler* crawler = *crawlerIter;
-        delete crawler;
-    }
-    mCrawlers.clear();
-
-	// delete all coins and clear the list
-    std::list<Coin*>::iterator coinIter = mCoins.begin();
-    for ( ; coinIter != mCoins.end(); ++coinIter)
-	{
-        Coin* coin = *coinIter;
-        delete coin;
-    }
-    mCoins.clear();
+		mWorld->GetEntities()->ReportUsage();
+	}
+	delete mWorld;
+	mWorld = NULL;
 
-	// delete all mushrooms
-	std::list<Layer*>::iterator mushIter = mMushrooms.begin();
-    for ( ; mushIter != mMushrooms.end(); ++mushIter)
-	{
-        delete *mushIter;
-    }
-	mMeteors.clear();
+	delete mClips;
+	mClips = NULL;
 
     // delete the texture manager (and all the textures it loaded for us)
     delete mTexMgr;
     mTexMgr = NULL;
 
-	delete mBackground;
-	mBackground = NULL;
+	// stop the worker threads
+	delete mWorkers;
+	mWorkers = NULL;
+
+	// the textures are gone, so nothing points into the pack anymore
+	delete mAssetPack;
+	mAssetPack = NULL;
+
+    delete mSpriteBatch;
+    mSpriteBatch = NULL;
 
-	delete mForeground;
-	mForeground = NULL;
+	delete mSceneCache;
+	mSceneCache = NULL;
+
+	delete mHud;
+	mHud = NULL;
+	delete mProfilerOverlay;
+	mProfilerOverlay = NULL;
 
 	// Shutdown the TTF library
 	TTF_Quit();
@@ -395,15 +994,35 @@ void Game::HandleEvent(const SDL_Event& e)
         mShouldQuit = true;
         break;
 
+    case SDL_RENDER_TARGETS_RESET:
+		// the contents of the render targets are gone, so composite the scene again
+		mSceneCache->Invalidate();
+		break;
+
     case SDL_WINDOWEVENT:
         if (e.window.event == SDL_WINDOWEVENT_RESIZED)
 		{
             mScrWidth = e.window.data1;
             mScrHeight = e.window.data2;
+
+			// the cached scene has to be as big as the window again
+			if (mRenderer)
+			{
+				mSceneCache->Resize(mScrWidth, mScrHeight);
+			}
         }
         break;
 
     case SDL_KEYDOWN:
+		if (!e.key.repeat)
+		{
+			if (mFrameInput.numKeysPressed < FrameInput::MAX_KEYS_PRESSED)
+			{
+				mFrameInput.keysPressed[mFrameInput.numKeysPressed] = e.key.keysym.sym;
+			}
+			mFrameInput.numKeysPressed++;
+		}
+
         switch (e.key.keysym.sym)
 		{
         case SDLK_ESCAPE:
@@ -412,17 +1031,9 @@ void Game::HandleEvent(const SDL_Event& e)
 
         case SDLK_k:
             //
-            // Removes all the crawlers
+            // Removes all the crawlers (in the next step, see Step)
             //
-			{
-				std::list<Crawler*>::iterator crawlerIter = mCrawlers.begin();
-				for ( ; crawlerIter != mCrawlers.end(); ++crawlerIter)
-				{
-					Crawler* crawler = *crawlerIter;
-					delete crawler;
-				}
-				mCrawlers.clear();
-			}
+			mPendingInput |= INPUT_KILL_CRAWLERS;
             break;
 
         case SDLK_p:
@@ -442,26 +1053,39 @@ void Game::HandleEvent(const SDL_Event& e)
             break;
 		case SDLK_v:
 			{
-				// show/hide collision rectangle
+				// show/hide collision rectangle (and the draw call stats)
 				rectVisible = rectVisible ? 0 : 1;
+				if (!rectVisible)
+				{
+					SDL_SetWindowTitle(mWindow, "C++ Final Project");
+				}
 				break;
 			}
+		case SDLK_f:
+			// show/hide the frame profiler (it needs the profiler running)
+			mOverlayVisible = !mOverlayVisible;
+			UpdateProfilerEnabled();
+			break;
+		case SDLK_t:
+			// capture a timeline of the next few frames
+			StartTrace(TRACE_FRAMES);
+			break;
 		case SDLK_9:
 			//If there is no music playing
 			if (Mix_PlayingMusic() == 0)
 			{
 				//Play the music
-				if (mRobot->GetLives() == 0)
+				if (mWorld->GetRobot()->GetLives() == 0)
 				{
-					Mix_PlayMusic(mBadGameOverMusic, 0);
+					PlayMusic(mBadGameOverMusic, 0);
 				}
-				else if (mScene < 6)
+				else if (mWorld->GetScene() < 6)
 				{
-					Mix_PlayMusic(mMusic, -1);
+					PlayMusic(mMusic, -1);
 				}
 				else
 				{
-					Mix_PlayMusic(mGoodGameOverMusic, -1);
+					PlayMusic(mGoodGameOverMusic, -1);
 				}
 			}
 			//If music is being played
@@ -482,30 +1106,14 @@ void Game::HandleEvent(const SDL_Event& e)
 			}
 			break;
 		case SDLK_x:
-			{
-				if (!mRobot->IsDead())
-				{
-					// Add a strong crawler
-					float x = GG::RandomFloat(32, mScrWidth - 32.0f);
-					Crawler* crawler = new CrawlerStrong(x, mScrHeight - 1.0f - 32.0f, false);
-					crawler->SetDirection(GG::RandomSign());
-					mCrawlers.push_back(crawler);
-				}
-				break;		
-			}
+			// Add a strong crawler (in the next step)
+			mPendingInput |= INPUT_ADD_STRONG_CRAWLER;
+			break;
 
 		case SDLK_c:
-			{
-				if (!mRobot->IsDead())
-				{
-					// Add a weak crawler
-					float x = GG::RandomFloat(32, mScrWidth - 32.0f);
-					Crawler* crawler = new CrawlerWeak(x, mScrHeight - 1.0f - 32.0f, true);
-					crawler->SetDirection(GG::RandomSign());
-					mCrawlers.push_back(crawler);
-				}
-				break;
-			}
+			// Add a weak crawler (in the next step)
+			mPendingInput |= INPUT_ADD_WEAK_CRAWLER;
+			break;
         }
 		break;
 	}
@@ -514,303 +1122,94 @@ void Game::HandleEvent(const SDL_Event& e)
 /*
 ================================================================================
 
-Game::Update
+Game::StartTrace
 
-    Gets called once per frame to perform game logic.
-    The parameter dt is the time elapsed since last frame (in seconds).
+    Starts capturing a trace of the next numFrames frames, to a file named
+    after the current time.
 
 ================================================================================
 */
-void Game::Update(float dt)
+void Game::StartTrace(int numFrames)
 {
-	// Update the robot
-	if (mRobot)
-	{
-		// If the robot has reached the last scene
-		// disable its controls and play game over animation
-		if (mScene == 6 && !mRobot->GetJumping() && !mRobot->GetFalling())
-		{
-			mRobot->SetAutoPilot(true);
-		}
-		mRobot->Update(dt);
-	}
+	mTrace.Start(GG::MakeTimestampedName("trace-", ".json"), numFrames, TRACE_MAX_EVENTS);
+	UpdateProfilerEnabled();
+}
+
+/*
+================================================================================
+
+Game::UpdateProfilerEnabled
+
+    The profiler runs whenever something wants its zones: the overlay, a
+    trace capture, the hitch recorder, or the summary printed at exit.
+
+================================================================================
+*/
+void Game::UpdateProfilerEnabled()
+{
+	GG::Profiler::SetEnabled(mOverlayVisible || mTrace.IsCapturing() || mHitchRecorder.IsEnabled() || mPrintProfile);
+}
 
-	// Update the coins
-	std::list<Coin*>::iterator coinIt = mCoins.begin();
-	while (coinIt != mCoins.end())
+/*
+================================================================================
+
+Game::Step
+
+    Advances the world by one fixed step.  The step's input comes from the
+    recording if one is being replayed, and from the keyboard otherwise:
+    the keys held down right now, plus the K, X and C presses since the
+    last step.  That input is all the world gets to see of the player (see
+    World::IsKeyDown), which is what makes recording it enough to replay
+    a session exactly.
+
+================================================================================
+*/
+void Game::Step()
+{
+	if (mReplaying)
 	{
-		Coin *coin = *coinIt;
-		// Check if the robot collides with the coin
-		if (mRobot->GetCollisonRect().y < coin->GetRect().y + coin->GetRect().h)
-		{
-			if ((mRobot->GetCollisonRect().x < coin->GetRect().x + coin->GetRect().w)
-				&& (mRobot->GetCollisonRect().x + mRobot->GetCollisonRect().w > coin->GetRect().x))
-			{
-				if ((mRobot->GetCollisonRect().y < coin->GetRect().y + coin->GetRect().h)
-					&& (mRobot->GetCollisonRect().y + mRobot->GetCollisonRect().h > coin->GetRect().y))
-				{
-					//I have found that the sound is delayed...So I start it a bit earlier than the actualy delete of the Coin
-					if (coin->GetSoundDelay() == 0)
-					{
-						// You get 5 points!
-						mPoints += 5;
-						Mix_PlayChannel(-1, mCoinSound, 0);
-						coin->SetSoundDelay(1);
-					}
-					//Once it has run through 4 times then it Deletes the coin
-					else if (coin->GetSoundDelay() == 5)
-					{
-						coinIt = mCoins.erase(coinIt); // remove the entry from the list and advance iterator
-						delete coin;
-						coin = NULL;
-					}
-					else
-					{
-						coin->SetSoundDelay(1);
-					}
-				}
-				else
-				{
-					coin->Update(dt);
-					++coinIt;
-				}
-			}
-			else
-			{
-				coin->Update(dt);
-				++coinIt;
-			}
-		}
-		else
-		{
-			coin->Update(dt);
-			++coinIt;
-		}
-			
+		mStepInput = mReplay.Next();
 	}
-
-	// update all crawlers
-	std::list<Crawler*>::iterator crawlerIt = mCrawlers.begin();
-    while (crawlerIt != mCrawlers.end())
+	else
 	{
-		Crawler *crawler =   *crawlerIt;
-		if (crawler->GetState() == Crawler::CRAWLER_DEAD)
-		{
-			crawlerIt = mCrawlers.erase(crawlerIt); // remove the entry from the list and advance iterator
-            delete crawler;              // delete the object
-		}
-		else
-		{
-			// If the robot is falling from a jump or just falling
-			if (mRobot->GetVerticalVelocity() > 0.0 && (mRobot->GetJumping() || mRobot->GetFalling()))
-			{
-				// Check if the robot has started squashing the poor crawler
-				if (mRobot->GetCollisonRect().x + mRobot->GetCollisonRect().w > crawler->GetCollisionRect().x && 
-				mRobot->GetCollisonRect().x < crawler->GetCollisionRect().x + crawler->GetCollisionRect().w)
-				{
-					if (mRobot->GetCollisonRect().y + mRobot->GetCollisonRect().h > crawler->GetCollisionRect().y &&
-						mRobot->GetCollisonRect().y < crawler->GetCollisionRect().y)
-					{
-						if (crawler->GetState() != CrawlerWeak::CRAWLER_DYING)
-						{
-							// You get 25 points!
-							mPoints += 25;
-							if (crawler->IsJumpedOn())
-							{
-								Mix_PlayChannel(-1, mStompSound, 0);
-								mRobot->Bounce(-400, false);
-								crawler->SetState(Crawler::CRAWLER_DYING);
-							}
-							else
-							{
-								Mix_PlayChannel(-1, mStompSoundNoKill, 0);
-								mRobot->Bounce(-400, false);
-								crawler->SetState(Crawler::CRAWLER_DYING);
-							}
-						}
-					}
-				}
-			}
-			// If the robot runs into a crawler, the robot must die (but it should not falling onto it from above)
-			else if (mRobot->GetCollisonRect().x + mRobot->GetCollisonRect().w > crawler->GetCollisionRect().x && 
-				mRobot->GetCollisonRect().x < crawler->GetCollisionRect().x + crawler->GetCollisionRect().w)
-			{
-				if (mRobot->GetCollisonRect().y + mRobot->GetCollisonRect().h > crawler->GetCollisionRect().y && 
-				mRobot->GetCollisonRect().y < crawler->GetCollisionRect().y + crawler->GetCollisionRect().h)
-				{
-					if (!mRobot->IsDead() && mRobot->GetVerticalVelocity() == -850.0f && crawler->GetState() != CrawlerWeak::CRAWLER_DYING)
-					{
-						// You lose a life:(
-						mRobot->SetLives(mRobot->GetLives() - 1);
-						Mix_PlayChannel(-1, mDieSound, 0);
-						// Stop the background music
-						Mix_HaltMusic();
-						if (mRobot->GetLives() == 0)
-						{
-							printf("\nGame over music is being played!");
-							Mix_VolumeMusic(32);
-							Mix_PlayMusic(mBadGameOverMusic, 0);
-							SetEntitiesGrayscale(true);
-						}
-						mRobot->Bounce(-400, true);             // kill the robot
-					}
-				}
-			}
-			crawler->Update(dt);
-			++crawlerIt;
-		}
-    }
+		mStepInput = mPendingInput;
+		mStepInput |= mKeyState[SDL_SCANCODE_A] ? INPUT_LEFT : 0;
+		mStepInput |= mKeyState[SDL_SCANCODE_D] ? INPUT_RIGHT : 0;
+		mStepInput |= mKeyState[SDL_SCANCODE_SPACE] ? INPUT_JUMP : 0;
+		mStepInput |= mKeyState[SDL_SCANCODE_R] ? INPUT_RESURRECT : 0;
+	}
+	mPendingInput = 0;
 
-    //
-    // update the explosions
-    //
-    std::list<Explosion*>::iterator it = mExplosions.begin();
-    while (it != mExplosions.end())
+	if (!mRecordPath.empty())
 	{
+		mRecording.Add(mStepInput);
+	}
 
-        Explosion* entity = *it;        // get a pointer to this explosion
-
-        if (entity->IsFinished())
-		{
-            it = mExplosions.erase(it); // remove the entry from the list and advance iterator
-            delete entity;              // delete the object
-        } 
-		else
-		{
-            entity->Update(dt);     // update the entity
-            ++it;                   // advance list iterator
-        }
-    }
+	mWorld->Step(mStepInput);
 
-	//
-    // update the meteors
-    //
-    std::list<Meteor*>::iterator metIt = mMeteors.begin();
-    while (metIt != mMeteors.end())
+	// Update the HUD (only does work if the points or lives changed)
 	{
-        Meteor* entity = *metIt;        // get a pointer to this meteor
-
-		// If the meteor has either reached the ground, destroy it with an explosion
-        if (entity->GetRect().y > mScrHeight-32-64) 
-		{
-			if (!mRobot->IsDead())
-			{
-				Mix_PlayChannel(-1, mThudSound, 0);
-			}
-			Explosion* boom = new Explosion(entity->GetRect().x + entity->GetRect().w / 2, entity->GetRect().y + entity->GetRect().h / 2);
-            mExplosions.push_back(boom);
-            metIt = mMeteors.erase(metIt); // remove the entry from the list and advance iterator
-            delete entity;              // delete the object
-        }
-		// If the meteor has hit the robot from the top, destroy it with an explosion and also kill the robot
-		else if (entity->GetRect().y + entity->GetRect().h > mRobot->GetCollisonRect().y &&
-				entity->GetRect().y < mRobot->GetCollisonRect().y + mRobot->GetCollisonRect().h &&
-				entity->GetRect().x + entity->GetRect().w > mRobot->GetCollisonRect().x &&
-				entity->GetRect().x < mRobot->GetCollisonRect().x + mRobot->GetCollisonRect().w && !mRobot->IsDead())
-		{
-			// You lose a life:(
-			mRobot->SetLives(mRobot->GetLives() - 1);
-			Mix_PlayChannel(-1, mThudSound, 0);
-			Mix_PlayChannel(-1, mDieSound, 0);
-			// Stop the background music
-			Mix_HaltMusic();
-			if (mRobot->GetLives() == 0)
-			{
-				Mix_VolumeMusic(32);
-				Mix_PlayMusic(mBadGameOverMusic, 0);
-				SetEntitiesGrayscale(true);
-			}
-			mRobot->Bounce(-400, true);             // kill the robot
-			Explosion* boom = new Explosion(entity->GetRect().x + entity->GetRect().w / 2, entity->GetRect().y + entity->GetRect().h / 2);
-			mExplosions.push_back(boom);
-			metIt = mMeteors.erase(metIt); // remove the entry from the list and advance iterator
-			delete entity;              // delete the object
-		}
-		else
-		{
-            entity->Update(dt);     // update the entity
-            ++metIt;                   // advance list iterator
-        }
-    }
+		GG_PROFILE_SCOPE("Update.Hud");
+		mHud->Update();
+	}
 
-	//
-    // update the mushrooms
-    //
-    std::list<Layer*>::iterator mushIt = mMushrooms.begin();
-    while (mushIt != mMushrooms.end())
-	{
-        Layer* entity = *mushIt;
-		// If the robot collects the mushroom, it gets an extra life!
-		if (entity->GetRect().y + entity->GetRect().h > mRobot->GetCollisonRect().y &&
-			entity->GetRect().y < mRobot->GetCollisonRect().y + mRobot->GetCollisonRect().h &&
-			entity->GetRect().x + entity->GetRect().w > mRobot->GetCollisonRect().x &&
-			entity->GetRect().x < mRobot->GetCollisonRect().x + mRobot->GetCollisonRect().w && !mRobot->IsDead())
+	// now and then, note down where the game is, to catch replays that drift
+	if (!mRecordPath.empty() && mRecording.GetNumSteps() % InputRecording::CHECKSUM_INTERVAL == 0)
+	{
+		mRecording.AddChecksum(mWorld->ComputeChecksum());
+	}
+	if (mReplaying)
+	{
+		if (mReplay.GetStep() % InputRecording::CHECKSUM_INTERVAL == 0)
 		{
-			mRobot->SetLives(mRobot->GetLives() + 1);
-			SetFlashesNeeded(2);
-			Mix_PlayChannel(-1, mOneupSound, 0);
-			mushIt = mMushrooms.erase(mushIt); // remove the entry from the list and advance iterator
-			delete entity;              // delete the object
+			mReplay.CheckChecksum(mWorld->ComputeChecksum());
 		}
-		else
-		{
-            ++mushIt;                   // advance list iterator
-        }
-    }
-
-	//
-    // generates a grayscale flash every 50 ms (if needed)
-    //
-	if (mFlashesNeeded > 0.0f)
-	{
-		if (mTime - mFlashTime > 0.1)
+		if (mReplay.IsFinished())
 		{
-			if ((int)mFlashesNeeded % 2)
-			{
-				SetEntitiesGrayscale(false);
-			}
-			else
-			{
-				SetEntitiesGrayscale(true);
-			}
-			mFlashesNeeded--;
-			mFlashTime = mTime;
+			std::cout << "*** The replay is over after " << mReplay.GetStep() << " steps" << std::endl;
+			mReplaying = false;
 		}
 	}
-
-	//
-    // create a new meteor every 0.2 to 1.2 seconds in scene 5
-    //
-	if (mTime - mMeteorTime > GG::UnitRandom() + 0.2 && mScene == 5)
-	{
-		int randomX = GG::RandomInt(mScrWidth-64);
-		int randomRotation = GG::RandomInt(90) + 180;
-		randomRotation = (randomRotation % 2) ? randomRotation : -randomRotation;
-		Meteor* meteor = new Meteor(randomX, -64, (double)randomRotation);  
-		mMeteors.push_back(meteor);
-		// timestamp this meteor!
-		mMeteorTime = mTime;
-	}
-
-	// Update the points label
-	mTexMgr->DeleteTexture("PointsLabel");
-	std::stringstream newLabel;
-	newLabel << "Points = " << mPoints;
-	SDL_Color text_color = {0, 0, 0};
-	mTexMgr->LoadTexture("PointsLabel", newLabel.str().c_str(), text_color);
-	delete mPointsLabel;
-	mPointsLabel = new Label(10.0f, -5.0f, "PointsLabel");
-
-	// Update the lives label
-	mTexMgr->DeleteTexture("LivesLabel");
-	newLabel.str(std::string());
-	newLabel << "Lives = " << mRobot->GetLives();
-	text_color.r = 255;
-	text_color.g = 50;
-	text_color.b = 50;
-	mTexMgr->LoadTexture("LivesLabel", newLabel.str().c_str(), text_color);
-	delete mLivesLabel;
-	mLivesLabel = new Label(140.0f, -5.0f, "LivesLabel");
 }
 
 /*
@@ -824,157 +1223,172 @@ Game::Draw
 */
 void Game::Draw()
 {
-    // clear the screen
-    SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, 255);
-    SDL_RenderClear(mRenderer);
-	
-	if (mBackground)
-	{
-		Render(mBackground->GetRenderable(), &mBackground->GetRect(), SDL_FLIP_NONE);
-	}
-	if (mForeground)
-	{
-		//Render(mForeground->GetRenderable(), &mForeground->GetRect(), SDL_FLIP_NONE);
-	}
-	if (mFlagPole)
-	{
-		Render(mFlagPole->GetRenderable(), &mFlagPole->GetRect(), SDL_FLIP_NONE);
-	}
+	GG_PROFILE_SCOPE("Draw");
+
+	Robot* robot = mWorld->GetRobot();
+	const EntityStore* entities = mWorld->GetEntities();
 
-    //
-    // draw the grid
-    //
-    if (mGrid)
 	{
-        int tileWidth = mGrid->TileWidth();
-        int tileHeight = mGrid->TileHeight();
-        GG::Rect tileRect(0, 0, tileWidth, tileHeight);
-        for (int y = 0; y < mGrid->NumRows(); y++)
+		GG_PROFILE_SCOPE("Draw.Scene");
+
+		// bring the cached static scene up to date before we start drawing
+		mSceneCache->Update(mSpriteBatch, mWorld->GetBackground(), mWorld->GetFlagPole(), mWorld->GetGrid());
+
+		// clear the screen
+		SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, 255);
+		SDL_RenderClear(mRenderer);
+
+		// everything goes through the sprite batch from here on
+		mSpriteBatch->Begin();
+
+		//
+		// draw the background, flag pole and grid (in one go, if they're cached)
+		//
+		if (mSceneCache->IsAvailable())
 		{
-            for (int x = 0; x < mGrid->NumCols(); x++)
-			{
-                const GG::Renderable* renderable = mGrid->GetTile(y, x)->GetRenderable();
-                if (renderable)
-				{
-                    Render(renderable, &tileRect, SDL_FLIP_NONE);
-                }
-                tileRect.x += tileWidth;
-            }
-            tileRect.y += tileHeight;
-            tileRect.x = 0;
-        }
-    }
+			GG::Rect sceneRect(0, 0, mSceneCache->GetWidth(), mSceneCache->GetHeight());
+			mSpriteBatch->Draw(mSceneCache->GetTexture(mWorld->IsGrayscale()), sceneRect, sceneRect, 0.0, NULL, SDL_FLIP_NONE);
+		}
+		else
+		{
+			SceneCache::Compose(mSpriteBatch, mWorld->GetBackground(), mWorld->GetFlagPole(), mWorld->GetGrid(),
+							   mWorld->IsGrayscale(), GG::Rect(0, 0, mScrWidth, mScrHeight));
+		}
+	}
 
 	// Draw the collision rectangles
 	if (rectVisible)
 	{
+		// the rectangles go on top of everything batched so far
+		mSpriteBatch->Flush();
+
 		SDL_SetRenderDrawColor(mRenderer, 255, 0, 0, 255);
-		SDL_RenderFillRect(mRenderer, &mRobot->GetBottomTileRect());
+		SDL_RenderFillRect(mRenderer, &robot->GetBottomTileRect());
 		SDL_SetRenderDrawColor(mRenderer, 150, 0, 0, 255);
-		SDL_RenderFillRect(mRenderer, &mRobot->GetTopTileRect());
+		SDL_RenderFillRect(mRenderer, &robot->GetTopTileRect());
 		SDL_SetRenderDrawColor(mRenderer, 255, 255, 0, 255);
-		SDL_RenderFillRect(mRenderer, &mRobot->GetCollisonRect());
-		for (auto coinIt = mCoins.begin(); coinIt != mCoins.end(); ++coinIt)
+		SDL_RenderFillRect(mRenderer, &robot->GetCollisonRect());
+		const CoinTable& coins = entities->GetCoins();
+		const CrawlerTable& crawlers = entities->GetCrawlers();
+		const MeteorTable& meteors = entities->GetMeteors();
+		for (int i = 0; i < coins.GetCount(); i++)
 		{
-			Coin* coin = *coinIt;
-			SDL_RenderFillRect(mRenderer, &coin->GetRect());
+			SDL_RenderFillRect(mRenderer, &coins.rect[i]);
 		}
-		for (auto crawlerIt = mCrawlers.begin(); crawlerIt != mCrawlers.end(); ++crawlerIt)
+		for (int i = 0; i < crawlers.GetCount(); i++)
 		{
-			Crawler* crawler = *crawlerIt;
-			SDL_RenderFillRect(mRenderer, &crawler->GetCollisionRect());
+			SDL_RenderFillRect(mRenderer, &crawlers.collisionRect[i]);
 		}
-		for (auto meteorIt = mMeteors.begin(); meteorIt != mMeteors.end(); ++meteorIt)
+		for (int i = 0; i < meteors.GetCount(); i++)
 		{
-			Meteor* meteor = *meteorIt;
-			SDL_RenderFillRect(mRenderer, &meteor->GetRect());
+			SDL_RenderFillRect(mRenderer, &meteors.rect[i]);
 		}
 		SDL_SetRenderDrawColor(mRenderer, 0, 0, 255, 255);
-		for (auto crawlerIt = mCrawlers.begin(); crawlerIt != mCrawlers.end(); ++crawlerIt)
+		for (int i = 0; i < crawlers.GetCount(); i++)
 		{
-			Crawler* crawler = *crawlerIt;
-			SDL_RenderFillRect(mRenderer, &crawler->GetTileRect());
+			SDL_RenderFillRect(mRenderer, &crawlers.tileRect[i]);
 		}
 	}
 
-	//
-    // draw the robot
-    //
-	if (mRobot)
 	{
-		Render(mRobot->GetRenderable(), &mRobot->GetRect(), mRobot->GetDirection()?SDL_FLIP_HORIZONTAL:SDL_FLIP_NONE);
-	}
+		GG_PROFILE_SCOPE("Draw.Entities");
 
-	//
-    // draw the coins
-    //
-	std::list<Coin*>::iterator coinIt = mCoins.begin();
-    for ( ; coinIt != mCoins.end(); ++coinIt)
-	{
-        Coin* coin = *coinIt;
-        Render(coin->GetRenderable(), &coin->GetRect(), SDL_FLIP_NONE);
-    }
+		//
+		// draw the robot
+		//
+		if (robot)
+		{
+			GG::Rect robotRect = GG::InterpolateRect(robot->GetPrevRect(), robot->GetRect(), mStepAlpha);
+			Render(robot->GetRenderable(), &robotRect, robot->GetDirection()?SDL_FLIP_HORIZONTAL:SDL_FLIP_NONE);
+		}
 
-	//
-    // draw the mushrooms
-    //
-	std::list<Layer*>::iterator mushIter = mMushrooms.begin();
-    for ( ; mushIter != mMushrooms.end(); ++mushIter)
-	{
-        Layer* mushroom = *mushIter;
-        Render(mushroom->GetRenderable(), &mushroom->GetRect(), SDL_FLIP_NONE);
-    }
+		//
+		// draw the coins
+		//
+		const CoinTable& coins = entities->GetCoins();
+		for (int i = 0; i < coins.GetCount(); i++)
+		{
+			Render(coins.anim[i], coins.grayscale[i] != 0, coins.rect[i], 0.0, SDL_FLIP_NONE);
+		}
 
-	//
-    // draw the crawlers
-    //
-    for (auto crawlerIt = mCrawlers.begin(); crawlerIt != mCrawlers.end(); ++crawlerIt)
-	{
-        Crawler* crawler = *crawlerIt;
-		if (crawler->GetDirection() == 1)
+		//
+		// draw the mushrooms
+		//
+		const MushroomTable& mushrooms = entities->GetMushrooms();
+		for (int i = 0; i < mushrooms.GetCount(); i++)
 		{
-			Render(crawler->GetRenderable(), &crawler->GetRect(), SDL_FLIP_HORIZONTAL);
+			Render(mushrooms.anim[i], mushrooms.grayscale[i] != 0, mushrooms.rect[i], 0.0, SDL_FLIP_NONE);
 		}
-		else
+
+		//
+		// draw the crawlers
+		//
+		const CrawlerTable& crawlers = entities->GetCrawlers();
+		for (int i = 0; i < crawlers.GetCount(); i++)
 		{
-			Render(crawler->GetRenderable(), &crawler->GetRect(), SDL_FLIP_NONE);
+			SDL_RendererFlip flip = crawlers.ai[i].direction == 1 ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
+			GG::Rect rect = GG::InterpolateRect(crawlers.prevRect[i], crawlers.rect[i], mStepAlpha);
+			Render(crawlers.anim[i], crawlers.grayscale[i] != 0, rect, 0.0, flip);
 		}
-    }
 
-    //
-    // draw the explosions
-    //
-    std::list<Explosion*>::iterator it = mExplosions.begin();
-    for ( ; it != mExplosions.end(); ++it)
+		//
+		// draw the explosions
+		//
+		const ExplosionTable& explosions = entities->GetExplosions();
+		for (int i = 0; i < explosions.GetCount(); i++)
+		{
+			Render(explosions.anim[i], explosions.grayscale[i] != 0, explosions.rect[i], 0.0, SDL_FLIP_NONE);
+		}
+
+		//
+		// draw the meteors
+		//
+		const MeteorTable& meteors = entities->GetMeteors();
+		for (int i = 0; i < meteors.GetCount(); i++)
+		{
+			GG::Rect rect = GG::InterpolateRect(meteors.prevRect[i], meteors.rect[i], mStepAlpha);
+			Render(meteors.anim[i], meteors.grayscale[i] != 0, rect, meteors.rotAngle[i], SDL_FLIP_NONE);
+		}
+	}
+
+	// Draw the HUD on top of everything
+	if (mHud)
 	{
-        Explosion* boom = *it;
-        Render(boom->GetRenderable(), &boom->GetRect(), SDL_FLIP_NONE);
-    }
+		GG_PROFILE_SCOPE("Draw.Hud");
+		mHud->Draw(mSpriteBatch);
+	}
 
-	//
-    // draw the meteors
-    //
-    std::list<Meteor*>::iterator metIt = mMeteors.begin();
-    for ( ; metIt != mMeteors.end(); ++metIt)
+	// and the profiler overlay on top of that
+	if (mOverlayVisible)
 	{
-        Meteor* meteor = *metIt;
-        Render(meteor->GetRenderable(), &meteor->GetRect(), SDL_FLIP_NONE);
-    }
+		GG_PROFILE_SCOPE("Draw.Overlay");
+		SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_BLEND);		// the panel is see-through
+		mProfilerOverlay->Draw(mSpriteBatch);
+	}
 
-	// Draw the points label
-	if (mPointsLabel)
+	// the batch sends everything to the renderer here
 	{
-		Render(mPointsLabel->GetRenderable(), &mPointsLabel->GetRect(), SDL_FLIP_NONE);
+		GG_PROFILE_SCOPE("Draw.Flush");
+		mSpriteBatch->End();
 	}
 
-	// Draw the lives label
-	if (mLivesLabel)
+	// In debug mode, report how well the batching works (once a second,
+	// since changing the window title isn't free)
+	if (rectVisible && mWorld->GetTime() - mStatsTime >= 1.0f)
 	{
-		Render(mLivesLabel->GetRenderable(), &mLivesLabel->GetRect(), SDL_FLIP_NONE);
+		std::stringstream title;
+		title << "C++ Final Project - " << mSpriteBatch->GetNumSprites() << " sprites in "
+			  << mSpriteBatch->GetNumDrawCalls() << " draw calls ("
+			  << mSpriteBatch->GetNumDrawCallsSaved() << " saved)";
+		SDL_SetWindowTitle(mWindow, title.str().c_str());
+		mStatsTime = mWorld->GetTime();
 	}
 
     // display everything we just drew
-    SDL_RenderPresent(mRenderer);
+	{
+		GG_PROFILE_SCOPE("Present");
+		SDL_RenderPresent(mRenderer);
+	}
 }
 
 
@@ -985,255 +1399,236 @@ Game::Render
 
     A helper method for drawing a Renderable into a destination rectangle
     on the screen.  It gets the Renderable's texture and source rectangle
-    in the texture and forwards everything to the SDL_RenderCopy function.
+    in the texture (atlas page) and forwards everything to the sprite batch,
+    which submits it along with the rest of the frame.
 
     One purpose of this method is to save some typing and improve
     readability of drawing code in the Game::Draw method.
 
     Additionally, this method provides an extra check for NULL Renderable
     pointers, which helps to keep shit game code afloat a while longer.
-    In case of a NULL Renderable, this method will use the TextureManager's
-    default texture instead.
+    In case of a NULL Renderable (or one without a clip), this method will
+    use the TextureManager's default texture instead.
+
+    Renderables are drawn unrotated.  The only things that turn are the
+    meteors, and they keep their angle in the meteor table (see the
+    overload below).
 
 ================================================================================
 */
 void Game::Render(const GG::Renderable* renderable, const GG::Rect* dstRect, SDL_RendererFlip flip)
 {
-    if (renderable)
-	{
-        SDL_RenderCopyEx(mRenderer,
-                         renderable->GetTexture()->GetPtr(),
-                         renderable->GetRect(),
-                         dstRect,
-                         renderable->GetRotationAngle(),
-                         &renderable->GetRotationOrigin(),
-                         flip);
+    if (renderable && renderable->GetClip())
+	{
+        GG::Rect srcRect = renderable->GetSourceRect();
+        mSpriteBatch->Draw(renderable->GetTexture()->GetPtr(),
+                           srcRect,
+                           *dstRect,
+                           0.0,
+                           renderable->GetRotationOrigin(),
+                           flip);
     }
 	else
 	{
-        SDL_RenderCopy(mRenderer,
-                       mTexMgr->GetDefaultTexture()->GetPtr(),
-                       NULL,
-                       dstRect);
+        const GG::Texture* tex = mTexMgr->GetDefaultTexture();
+        mSpriteBatch->Draw(tex->GetPtr(),
+                           tex->GetRegion(),
+                           *dstRect,
+                           0.0,
+                           NULL,
+                           SDL_FLIP_NONE);
     }
 }
 
-void Game::PlaySound(std::string name)
+/*
+================================================================================
+
+Game::Render
+
+    Same as above, for entity animations (slots of the entity tables'
+    RenderableArrays), which keep their grayscale flag and rotation angle
+    (in degrees, around the middle of the frame) on the side.
+
+================================================================================
+*/
+void Game::Render(const GG::RenderableArray::ConstSlot& anim, bool grayscale, const GG::Rect& dstRect, double angle, SDL_RendererFlip flip)
+{
+    mSpriteBatch->Draw(anim.GetTexture(grayscale)->GetPtr(),
+                       anim.GetSourceRect(grayscale),
+                       dstRect,
+                       angle,
+                       &anim.GetRotationOrigin(),
+                       flip);
+}
+
+// The world's sounds and music (see WorldListener)
+void Game::PlaySound(WorldSound sound)
 {
-	if (name == "Jump")
+	switch (sound)
 	{
-		Mix_PlayChannel(-1, mJumpSound, 0);
+	case SOUND_COIN:			PlayChunk(mCoinSound); break;
+	case SOUND_JUMP:			PlayChunk(mJumpSound); break;
+	case SOUND_STOMP:			PlayChunk(mStompSound); break;
+	case SOUND_STOMP_NO_KILL:	PlayChunk(mStompSoundNoKill); break;
+	case SOUND_DIE:				PlayChunk(mDieSound); break;
+	case SOUND_BLOCK:			PlayChunk(mBlockSound); break;
+	case SOUND_THUD:			PlayChunk(mThudSound); break;
+	case SOUND_ONEUP:			PlayChunk(mOneupSound); break;
 	}
-	else if (name == "Block")
+}
+
+void Game::PlayMusic(WorldMusic music, int loops)
+{
+	switch (music)
 	{
-		Mix_PlayChannel(-1, mBlockSound, 0);
+	case MUSIC_MAIN:			PlayMusic(mMusic, loops); break;
+	case MUSIC_GOOD_GAME_OVER:	PlayMusic(mGoodGameOverMusic, loops); break;
+	case MUSIC_BAD_GAME_OVER:	PlayMusic(mBadGameOverMusic, loops); break;
 	}
 }
 
-void Game::StopSounds()
+void Game::SceneLoaded()
 {
-	Mix_HaltChannel(-1);
+	// the static part of the scene has to be composited again
+	mSceneCache->Invalidate();
 }
 
-// Load the scene with/without the crawlers and coins
-void Game::LoadScene(int scene, bool items)
+// The mixer calls go through these, so they show up in the profiler,
+// and so they do nothing when there's no audio device (see OpenAudio)
+void Game::StopSounds()
 {
-	// delete all crawlers and clear the list
-    std::list<Crawler*>::iterator crawlerIter = mCrawlers.begin();
-    for ( ; crawlerIter != mCrawlers.end(); ++crawlerIter)
-	{
-        Crawler* crawler = *crawlerIter;
-        delete crawler;
-    }
-    mCrawlers.clear();
-
-	// delete all coins and clear the list
-    std::list<Coin*>::iterator coinIter = mCoins.begin();
-    for ( ; coinIter != mCoins.end(); ++coinIter)
-	{
-        Coin* coin = *coinIter;
-        delete coin;
-    }
-    mCoins.clear();
-
-	// delete all meteors
-    std::list<Meteor*>::iterator metIt = mMeteors.begin();
-    for ( ; metIt != mMeteors.end(); ++metIt) {
-        delete *metIt;
-    }
-    mMeteors.clear();
-
-	// delete all mushrooms
-	std::list<Layer*>::iterator mushIter = mMushrooms.begin();
-    for ( ; mushIter != mMushrooms.end(); ++mushIter)
+	GG_PROFILE_SCOPE("Audio.StopSounds");
+	if (mAudioOpen)
 	{
-        delete *mushIter;
-    }
-	mMushrooms.clear();
-
-	delete mBackground;
-	mBackground = NULL;
-
-	delete mGrid;
-	mGrid = NULL;
-
-	std::stringstream b, gb, t;
-	t << "media/" << mScene << ".txt";
-	b << "Background" << mScene + 1;
-	gb << "BackgroundGray" << mScene + 1;
-	mBackground = new Layer(0.0f, 0.0f, 800.0f, 480.0f, b.str(), gb.str());
-	mGrid = LoadLevel(t.str(), items);
-
-	// First scene
-	if (mScene == 0)
-	{
-		// Play the background music
-		Mix_VolumeMusic(32);
-		Mix_PlayMusic(mMusic, -1);
+		Mix_HaltChannel(-1);
 	}
-	// Game over scene
-	if (mScene == 6)
+}
+
+void Game::PlayChunk(Mix_Chunk* chunk)
+{
+	GG_PROFILE_SCOPE("Audio.PlayChunk");
+	if (mAudioOpen)
 	{
-		mFlagPole = new Layer(mScrWidth *.7f, 68.0f, 124.0f, 380.0f, "FlagPole", "FlagPoleGray");
-		Mix_VolumeMusic(128);
-		Mix_PlayMusic(mGoodGameOverMusic, 0);
+		Mix_PlayChannel(-1, chunk, 0);
 	}
 }
 
-// Load textures without grayscale
-void Game::LoadTextures()
+void Game::PlayMusic(Mix_Music* music, int loops)
 {
-	mTexMgr->LoadTexture("Background1", "Layer1.png", false);
-	mTexMgr->LoadTexture("Background2", "Layer2.png", false);
-	mTexMgr->LoadTexture("Background3", "Layer3.png", false);
-	mTexMgr->LoadTexture("Background4", "Layer4.png", false);
-	mTexMgr->LoadTexture("Background5", "Layer5.png", false);
-	mTexMgr->LoadTexture("Background6", "Layer6.png", false);
-	mTexMgr->LoadTexture("Background7", "Layer7.png", false);
-	mTexMgr->LoadTexture("Foreground", "Layer0.png", false);
-    mTexMgr->LoadTexture("Tiles", "tiles.tga", false, 7);
-	mTexMgr->LoadTexture("Tiles2", "tiles2.tga", false, 7);
-    mTexMgr->LoadTexture("Explosion", "explosion.tga", false, 16);
-	mTexMgr->LoadTexture("RobotIdle", "robot_idle.png", false, 8);
-	mTexMgr->LoadTexture("RobotRun", "robot_run.png", false, 6);
-	mTexMgr->LoadTexture("RobotJump", "robot_jump.png", false, 8);
-	mTexMgr->LoadTexture("RobotDie", "robot_die.png", false, 8);
-	mTexMgr->LoadTexture("RobotWalk", "robot_walk.png", false, 8);
-	mTexMgr->LoadTexture("RobotCelebrate", "robot_celebrate.png", false, 13);
-	mTexMgr->LoadTexture("Meteor", "meteor.png", false);
-	mTexMgr->LoadTexture("CrawlerWalk", "crawler_walk.png", false, 8);
-    mTexMgr->LoadTexture("CrawlerIdle", "crawler_idle.png", false, 8);
-	mTexMgr->LoadTexture("CrawlerWalkPink", "crawler_walk_pink.png", false, 8);
-	mTexMgr->LoadTexture("CrawlerIdlePink", "crawler_idle_pink.png", false, 8);
-	mTexMgr->LoadTexture("CrawlerDie", "crawler_die.png", false, 8);
-	mTexMgr->LoadTexture("Coin", "coin.png", false, 10);
-	mTexMgr->LoadTexture("FlagPole", "flagpole.png", false);
-	mTexMgr->LoadTexture("Mushroom", "mushroom.png", false);
+	GG_PROFILE_SCOPE("Audio.PlayMusic");
+	if (mAudioOpen)
+	{
+		Mix_PlayMusic(music, loops);
+	}
 }
 
-// Load textures with grayscale (done programmatically!)
-void Game::LoadGrayscaleTextures()
+void Game::StopMusic()
 {
-	mTexMgr->LoadTexture("BackgroundGray1", "Layer1.png", true);
-	mTexMgr->LoadTexture("BackgroundGray2", "Layer2.png", true);
-	mTexMgr->LoadTexture("BackgroundGray3", "Layer3.png", true);
-	mTexMgr->LoadTexture("BackgroundGray4", "Layer4.png", true);
-	mTexMgr->LoadTexture("BackgroundGray5", "Layer5.png", true);
-	mTexMgr->LoadTexture("BackgroundGray6", "Layer6.png", true);
-	mTexMgr->LoadTexture("BackgroundGray7", "Layer7.png", true);
-	mTexMgr->LoadTexture("ForegroundGray", "Layer0.png", true);
-    mTexMgr->LoadTexture("TilesGray", "tiles.tga", true, 7);
-	mTexMgr->LoadTexture("TilesGray2", "tiles2.tga", true, 7);
-    mTexMgr->LoadTexture("ExplosionGray", "explosion.tga", true, 16);
-	mTexMgr->LoadTexture("RobotIdleGray", "robot_idle.png", true, 8);
-	mTexMgr->LoadTexture("RobotRunGray", "robot_run.png", true, 6);
-	mTexMgr->LoadTexture("RobotJumpGray", "robot_jump.png", true, 8);
-	mTexMgr->LoadTexture("RobotDieGray", "robot_die.png", true, 8);
-	mTexMgr->LoadTexture("RobotWalkGray", "robot_walk.png", true, 8);
-	mTexMgr->LoadTexture("RobotCelebrateGray", "robot_celebrate.png", true, 13);
-	mTexMgr->LoadTexture("MeteorGray", "meteor.png", true);
-	mTexMgr->LoadTexture("CrawlerWalkGray", "crawler_walk.png", true, 8);
-    mTexMgr->LoadTexture("CrawlerIdleGray", "crawler_idle.png", true, 8);
-	mTexMgr->LoadTexture("CrawlerDieGray", "crawler_die.png", true, 8);
-	mTexMgr->LoadTexture("CoinGray", "coin.png", true, 10);
-	mTexMgr->LoadTexture("FlagPoleGray", "flagpole.png", true);
-	mTexMgr->LoadTexture("MushroomGray", "mushroom.png", true);
+	GG_PROFILE_SCOPE("Audio.StopMusic");
+	if (mAudioOpen)
+	{
+		Mix_HaltMusic();
+	}
 }
 
-void Game::LoadSounds()
+void Game::SetMusicVolume(int volume)
 {
-	mCoinSound = Mix_LoadWAV("media/coin_sound.wav");
-	mJumpSound = Mix_LoadWAV("media/jump_sound.wav");
-	mStompSound = Mix_LoadWAV("media/stomp_sound.wav");
-	mStompSoundNoKill = Mix_LoadWAV("media/stomp_sound_nokill.wav");
-	mDieSound = Mix_LoadWAV("media/die_sound.wav");
-	mBlockSound = Mix_LoadWAV("media/block_sound.wav");
-	mThudSound = Mix_LoadWAV("media/thud_sound.wav");
-	mOneupSound = Mix_LoadWAV("media/oneup_sound.wav");
+	if (mAudioOpen)
+	{
+		Mix_VolumeMusic(volume);
+	}
 }
 
-// Tells the entities to use their grayscale renderables
-// instead of their colored ones (applies to all entities)
-void Game::SetEntitiesGrayscale(bool grayscale)
+// Load textures, along with their grayscale versions (done programmatically, from the same decode!)
+void Game::LoadTextures()
 {
-	if (mRobot) mRobot->SetGrayscale(grayscale);
-	if (mBackground) mBackground->SetGrayscale(grayscale);
-	if (mForeground) mForeground->SetGrayscale(grayscale);
-	if (mFlagPole) mFlagPole->SetGrayscale(grayscale);
-	
-	if (mGrid)
-	{
-        int tileWidth = mGrid->TileWidth();
-        int tileHeight = mGrid->TileHeight();
-        GG::Rect tileRect(0, 0, tileWidth, tileHeight);
-        for (int y = 0; y < mGrid->NumRows(); y++)
+	GG_PROFILE_SCOPE("LoadTextures");
+
+	// the pack has everything pre-decoded, names and cell counts included
+	if (mAssetPack->IsOpen())
+	{
+		for (int i = 0; i < mAssetPack->GetNumEntries(); i++)
 		{
-            for (int x = 0; x < mGrid->NumCols(); x++)
+			const GG::PackEntry& entry = mAssetPack->GetEntry(i);
+			if (entry.type == GG::PACK_IMAGE)
 			{
-                Tile* tile = mGrid->GetTile(y, x);
-                if (tile->GetRenderable())
-				{
-                    tile->SetGrayscale(grayscale);
-                }
-                tileRect.x += tileWidth;
-            }
-            tileRect.y += tileHeight;
-            tileRect.x = 0;
-        }
-    }
+				mTexMgr->LoadPackedTexture(*mAssetPack, entry);
+			}
+		}
+		return;
+	}
 
-	std::list<Explosion*>::iterator it = mExplosions.begin();
-    for ( ; it != mExplosions.end(); ++it)
+	for (int i = 0; i < NUM_TEXTURE_ASSETS; i++)
 	{
-        Explosion* boom = *it;
-        boom->SetGrayscale(grayscale);
-    }
+		const TextureAsset& asset = TEXTURE_ASSETS[i];
+		if (asset.grayName)
+		{
+			mTexMgr->LoadTexturePair(asset.name, asset.grayName, asset.filename, asset.numCells);
+		}
+		else
+		{
+			mTexMgr->LoadTexture(asset.name, asset.filename, false, asset.numCells);
+		}
+	}
+}
 
-	std::list<Meteor*>::iterator metIt = mMeteors.begin();
-    for ( ; metIt != mMeteors.end(); ++metIt)
-	{
-        Meteor* meteor = *metIt;
-        meteor->SetGrayscale(grayscale);
-    }
+/*
+================================================================================
 
-	std::list<Crawler*>::iterator crawlerIter = mCrawlers.begin();
-    for ( ; crawlerIter != mCrawlers.end(); ++crawlerIter)
-	{
-        Crawler* crawler = *crawlerIter;
-        crawler->SetGrayscale(grayscale);
-    }
+Game::LoadLevels
+
+    Reads every scene's level into mLevels, from the asset pack if there's
+    one, and from the loose files otherwise.
+
+================================================================================
+*/
+bool Game::LoadLevels()
+{
+	GG_PROFILE_SCOPE("LoadLevels");
 
-	std::list<Coin*>::iterator coinIter = mCoins.begin();
-    for ( ; coinIter != mCoins.end(); ++coinIter)
+	mLevels.resize(NUM_LEVEL_FILES);
+	for (int i = 0; i < NUM_LEVEL_FILES; i++)
 	{
-        Coin* coin = *coinIter;
-        coin->SetGrayscale(grayscale);
-    }
+		const GG::PackEntry* level = mAssetPack->Find(LEVEL_FILES[i]);
+		if (level)
+		{
+			LoadLevelFromText((const char*)mAssetPack->GetData(*level), level->size, &mLevels[i]);
+		}
+		else if (!LoadLevel(std::string("media/") + LEVEL_FILES[i], &mLevels[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Game::LoadSounds()
+{
+	GG_PROFILE_SCOPE("LoadSounds");
 
-	std::list<Layer*>::iterator mushIter = mMushrooms.begin();
-    for ( ; mushIter != mMushrooms.end(); ++mushIter)
+	// SDL_mixer isn't thread safe, so the chunks all get loaded by one job
+	// (only ever on one thread at a time), not by a job each
+	auto load = [this]()
 	{
-        Layer* mushroom = *mushIter;
-        mushroom->SetGrayscale(grayscale);
-    }
-}
\ No newline at end of file
+		mCoinSound = Mix_LoadWAV("media/coin_sound.wav");
+		mJumpSound = Mix_LoadWAV("media/jump_sound.wav");
+		mStompSound = Mix_LoadWAV("media/stomp_sound.wav");
+		mStompSoundNoKill = Mix_LoadWAV("media/stomp_sound_nokill.wav");
+		mDieSound = Mix_LoadWAV("media/die_sound.wav");
+		mBlockSound = Mix_LoadWAV("media/block_sound.wav");
+		mThudSound = Mix_LoadWAV("media/thud_sound.wav");
+		mOneupSound = Mix_LoadWAV("media/oneup_sound.wav");
+	};
+
+	// on the workers if there are any, in which case the chunks are only
+	// there after the workers are done (see Initialize)
+	if (mWorkers)
+	{
+		mWorkers->Submit(load);
+	}
+	else
+	{
+		load();
+	}
+}
@@ -1,25 +1,28 @@
 #ifndef GAME_H_
 #define GAME_H_
 
+#include "GG_AssetPack.h"
 #include "GG_Graphics.h"
+#include "GG_SpriteBatch.h"
 #include "GG_Timer.h"
-#include "Explosion.h"
+#include "GG_Profiler.h"
+#include "GG_Trace.h"
+#include "GG_ThreadPool.h"
+#include "GG_SpatialHash.h"
 #include "Grid.h"
-#include "Crawler.h"
-#include "Robot.h"
-#include "Layer.h"
-#include "Label.h"
-#include "Coin.h"
-#include "Meteor.h"
-#include "CrawlerStrong.h"
-#include "CrawlerWeak.h"
+#include "SceneCache.h"
+#include "World.h"
+#include "Level.h"
+#include "Assets.h"
+#include "Hud.h"
+#include "ProfilerOverlay.h"
+#include "HitchRecorder.h"
+#include "InputRecording.h"
 
 #include <SDL_mixer.h>
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 
-#include <list>
-
 /*
 ================================================================================
 
@@ -27,9 +30,18 @@ Game class
 
     This class takes care of the overall game tasks:
     - setting up a window, renderer, and resource managers
-    - input handling and basic game logic
-    - main loop: the Update and Draw methods get called once per frame
+    - loading the assets that every World shares (textures and levels)
+    - input handling, and playing the sounds and music of the World it
+      shows (the game logic is in the World, see the World class)
+    - main loop: the world advances in fixed steps (as many per frame as
+      the elapsed time calls for), and the Draw method gets called once
+      per frame, drawing the moving things in between the last two steps
+      so the motion stays smooth at any frame rate
     - keeping track of elapsed time
+    - recording the input of every step, and replaying it (see Step)
+    - running the simulation headless, with no window, renderer or audio
+      (see RunHeadless), or many worlds at once on every core (see
+      RunBatch)
 
     The class is a singleton, i.e., there can only be one Game object
     during the lifetime of the application.  This is accomplished by
@@ -38,14 +50,16 @@ Game class
 
     To create and start a game, the main function can do something like this:
 
-    Game::GetInstance()->Run();
+    if (Game::GetInstance()->Configure(argc, argv)) {
+        Game::GetInstance()->Run();
+    }
 
     The Run method then takes over and performs initialization, runs the main loop,
     and cleans up when the game is finished.
 
 ================================================================================
 */
-class Game {
+class Game : public WorldListener {
 
     SDL_Window*             mWindow;
     SDL_Renderer*           mRenderer;
@@ -55,33 +69,52 @@ class Game {
     int                     mScrHeight;
 
     GG::TextureManager*     mTexMgr;
+    GG::ClipLibrary*        mClips;         // every animation, registered once the textures are loaded
+    GG::SpriteBatch*        mSpriteBatch;
+    GG::ThreadPool*         mWorkers;       // for loading assets in parallel, then for the busy steps
+    GG::AssetPack*          mAssetPack;     // pre-decoded images and levels (not open if using loose files)
+    std::string             mPackPath;
+    bool                    mLooseFiles;    // ignore the pack
+    bool                    mHeadless;      // no window, renderer or audio, just the simulation (see RunHeadless)
+    int                     mHeadlessSteps; // steps per scene in a headless run
+    bool                    mAudioOpen;     // false means a null mixer, the sounds don't play
+    int                     mBatchWorlds;   // worlds in a --batch run (0 for a normal game)
+    int                     mBatchSteps;    // steps each of them runs
+
+    std::vector<LevelData>  mLevels;        // every scene's level, read once and shared by all worlds
+    World*                  mWorld;         // the world being played (or run headless)
+
+    InputRecording          mRecording;     // the session so far, if mRecordPath isn't empty
+    std::string             mRecordPath;
+    InputRecording          mReplay;        // the session being played back, if mReplaying
+    bool                    mReplaying;
+    StepInput               mPendingInput;  // K, X and C presses since the last step
+    StepInput               mStepInput;     // the input of the current (or last) step
 
     bool                    mShouldQuit;
 
     GG::Timer               mTimer;
-    float                   mTime;          // time elapsed since game started (in seconds)
-	float					mMeteorTime;	// time that the last meteor was created (in seconds)
-	float					mFlashTime;		// time that the last grayscale/color switch occured
-	float					mFlashesNeeded;  // number of flashes that are needed
-
-    Grid*                   mGrid;
+    Uint64                  mFrameTimeNs;   // timer reading at the start of the last frame
+    Uint64                  mStepAccumulatorNs; // real time that hasn't been simulated yet
+    float                   mStepAlpha;     // where to draw, between the previous step (0) and the last one (1)
 
-	Robot*					mRobot;
-	Layer*					mBackground;
-	Layer*					mForeground;
-	Layer*					mFlagPole;
-	Label*					mPointsLabel;
-	Label*					mLivesLabel;
+    std::vector<GG::ProfileEvent>   mProfileEvents;     // the last frame's zones (if profiling)
+    GG::ProfileSummary      mProfileSummary;    // all the frames' zones
+    int                     mNumProfiledFrames;
+    bool                    mPrintProfile;  // print mProfileSummary at exit?
+    GG::TraceCapture        mTrace;         // frames being captured for the trace viewer (T starts one)
+    HitchRecorder           mHitchRecorder; // the last few seconds of frames, dumped when one is too slow
+    float                   mHitchBudgetMs; // frames longer than this are hitches (0 for none, -1 for two refreshes)
+    FrameInput              mFrameInput;    // this frame's input, for the hitch recorder
 
-	std::list<Explosion*>   mExplosions;
-	std::list<Meteor*>		mMeteors;
-	std::list<Crawler*>     mCrawlers;
-	std::list<Coin*>		mCoins;
-	std::list<Layer*>		mMushrooms;
+	SceneCache*				mSceneCache;	// background, flag pole and tiles, composited once per scene
 
-	int						mScene;
+	Hud*					mHud;			// points and lives counters, and whatever else goes on top
+	ProfilerOverlay*		mProfilerOverlay;	// frame times and where they go
+	bool					mOverlayVisible;
 
 	bool					rectVisible;
+	float					mStatsTime;		// time that the draw call stats were last reported
 
 	Mix_Chunk*				mCoinSound;
 	Mix_Chunk*				mJumpSound;
@@ -95,11 +128,10 @@ class Game {
 	Mix_Music*				mGoodGameOverMusic;
 	Mix_Music*				mBadGameOverMusic;
 
-	int						mPoints;
-
 public:
     static Game*            GetInstance();
 
+    bool                    Configure(int argc, char** argv);
     void                    Run();
 
     int                     GetScrWidth() const				{ return mScrWidth; }
@@ -107,28 +139,22 @@ public:
 
     GG::TextureManager*     GetTextureManager() const		{ return mTexMgr; }
 
-    float                   GetTime() const					{ return mTime; }
-	float                   GetMeteorTime() const       { return mMeteorTime; }
+	World*					GetWorld() const				{ return mWorld; }
 
-    Grid*                   GetGrid() const					{ return mGrid; }
-	Robot*					GetRobot() const				{ return mRobot; }
-	int						GetScene() const				{ return mScene; }
-	Layer*					GetFlagPole() const				{ return mFlagPole; }
+	// WorldListener
+	void					PlaySound(WorldSound sound) override;
+	void					StopSounds() override;
+	void					PlayMusic(WorldMusic music, int loops) override;
+	void					StopMusic() override;
+	void					SetMusicVolume(int volume) override;
+	void					SceneLoaded() override;
 
-    bool                    IsKeyDown(SDL_Scancode s)		{ return mKeyState[s] != 0; }
-	void					PlaySound(std::string name);
-	void					StopSounds();
+	void					PlayChunk(Mix_Chunk* chunk);
+	void					PlayMusic(Mix_Music* music, int loops);
 
-	std::list<Crawler*>*	GetCrawlers()					{ return &mCrawlers; }
-	std::list<Coin*>*		GetCoins()						{ return &mCoins; }
-	std::list<Layer*>*		GetMushrooms()					{ return &mMushrooms; }
-	void					SetScene(int scene)				{ mScene = scene; }
-	void					LoadScene(int scene, bool items);
 	void					LoadTextures();
-	void					LoadGrayscaleTextures();
+	bool					LoadLevels();
 	void					LoadSounds();
-	void					SetEntitiesGrayscale(bool grayscale);
-	void					SetFlashesNeeded(int flashes)	{ mFlashesNeeded = (float)flashes*2.0f; }
 
 private:
                             Game();
@@ -138,15 +164,30 @@ private:
     Game&                   operator= (const Game&);
 
     bool                    Initialize();
+    bool                    OpenDisplay();
+    bool                    OpenAudio();
     void                    Shutdown();
 
+    void                    RunHeadless();
+    Uint64                  RunHeadlessSteps(int numSteps, int* maxEntities);
+
+    void                    RunBatch();
+    Uint64                  RunBatchPass(GG::ThreadPool* pool, std::vector<Uint32>* checksums);
+
+    WorldAssets             GetWorldAssets() const;
+
+    void                    Step();
+
     void                    HandleEvent(const SDL_Event& e);
 
-    void                    Update(float dt);
+    void                    StartTrace(int numFrames);
+    void                    UpdateProfilerEnabled();
+
     void                    Draw();
 
 private:
     void					Render(const GG::Renderable* renderable, const GG::Rect* dstRect, SDL_RendererFlip flip);
+    void					Render(const GG::RenderableArray::ConstSlot& anim, bool grayscale, const GG::Rect& dstRect, double angle, SDL_RendererFlip flip);
 };
 
 #endif
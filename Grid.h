@@ -15,6 +15,7 @@ public:
     void                    SetRenderable(GG::Renderable* renderable);  // takes ownership
 
     GG::Renderable*         GetRenderable()		   { return mRenderable; }
+    const GG::Renderable*   GetRenderable() const   { return mRenderable; }
 
 	void					SetGrayscale(bool grayscale);
 };
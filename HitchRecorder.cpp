@@ -0,0 +1,277 @@
+#include "HitchRecorder.h"
+#include "GG_Trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// a zone only counts as the reason its parent was slow if it took at
+// least this share of the parent's time
+static const float SLOW_SHARE = 0.5f;
+
+static float TicksToMs(Uint64 ticks)
+{
+    return GG::TicksToNs(ticks) * 1e-6f;
+}
+
+// Finds the longest zone directly inside zones[parent] (same thread, one
+// level deeper, within its start and end), or -1 if there's none
+static int FindLongestChild(const GG::ProfileEvent* zones, int numZones, int parent)
+{
+    const GG::ProfileEvent& p = zones[parent];
+
+    int longest = -1;
+    for (int i = 0; i < numZones; i++) {
+        const GG::ProfileEvent& z = zones[i];
+        if (z.threadId == p.threadId && z.depth == p.depth + 1 && z.start >= p.start && z.end <= p.end) {
+            if (longest < 0 || z.end - z.start > zones[longest].end - zones[longest].start) {
+                longest = i;
+            }
+        }
+    }
+    return longest;
+}
+
+// Writes the chain of zones that made zones[frameZone] slow: the longest
+// zone inside it, then the longest zone inside that one for as long as it
+// takes up most of its parent, like "Update 31.20 ms > LoadScene 30.90 ms"
+static void WriteSlowPhase(FILE* f, const GG::ProfileEvent* zones, int numZones, int frameZone)
+{
+    if (frameZone < 0) {
+        std::fprintf(f, "(no Frame zone)");
+        return;
+    }
+
+    int parent = frameZone;
+    bool first = true;
+    for (;;) {
+        int child = FindLongestChild(zones, numZones, parent);
+        if (child < 0) {
+            break;
+        }
+
+        Uint64 childTicks = zones[child].end - zones[child].start;
+        Uint64 parentTicks = zones[parent].end - zones[parent].start;
+        if (!first && childTicks < SLOW_SHARE * parentTicks) {
+            break;
+        }
+
+        std::fprintf(f, "%s%s %.2f ms", first ? "" : " > ", zones[child].name, TicksToMs(childTicks));
+        parent = child;
+        first = false;
+    }
+
+    if (first) {
+        std::fprintf(f, "(nothing inside Frame)");
+    }
+}
+
+// orders zones by thread, then by start time, with outer zones before the
+// ones inside them
+static bool ZoneOrder(const GG::ProfileEvent& a, const GG::ProfileEvent& b)
+{
+    if (a.threadId != b.threadId) {
+        return a.threadId < b.threadId;
+    }
+    if (a.start != b.start) {
+        return a.start < b.start;
+    }
+    return a.depth < b.depth;
+}
+
+/*
+================================================================================
+
+HitchRecorder constructor
+
+    Allocates the ring buffer.  The recorder starts out off; SetBudgetNs
+    turns it on.
+
+================================================================================
+*/
+HitchRecorder::HitchRecorder()
+    : mFrames(HISTORY)
+    , mFramePos(0)
+    , mNumFrames(0)
+    , mBudgetNs(0)
+    , mNextDumpFrame(0)
+    , mNumSkippedHitches(0)
+{
+}
+
+/*
+================================================================================
+
+HitchRecorder::AddFrame
+
+    Records one frame's zones, counters and input, and dumps the buffer if
+    the frame went over the budget.
+
+================================================================================
+*/
+void HitchRecorder::AddFrame(const std::vector<GG::ProfileEvent>& events,
+                             const FrameCounters& counters, const FrameInput& input)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+
+    Frame& frame = mFrames[mFramePos];
+    mFramePos = (mFramePos + 1) % HISTORY;
+
+    frame.number = mNumFrames++;
+    frame.counters = counters;
+    frame.input = input;
+
+    // keep the outer zones first, since they're what a hitch gets blamed
+    // on (a frame that loads a scene can have hundreds of inner ones)
+    Uint32 maxDepth = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        maxDepth = events[i].depth > maxDepth ? events[i].depth : maxDepth;
+    }
+
+    frame.numZones = 0;
+    frame.frameZone = -1;
+    for (Uint32 depth = 0; depth <= maxDepth && frame.numZones < MAX_ZONES; depth++) {
+        for (size_t i = 0; i < events.size() && frame.numZones < MAX_ZONES; i++) {
+            if (events[i].depth == depth) {
+                if (depth == 0 && frame.frameZone < 0 && std::strcmp(events[i].name, "Frame") == 0) {
+                    frame.frameZone = frame.numZones;
+                }
+                frame.zones[frame.numZones++] = events[i];
+            }
+        }
+    }
+    frame.numDroppedZones = (int)events.size() - frame.numZones;
+
+    if (frame.frameZone < 0) {
+        // the profiler got turned on in the middle of the frame
+        frame.frameTicks = 0;
+        return;
+    }
+
+    const GG::ProfileEvent& frameZone = frame.zones[frame.frameZone];
+    frame.frameTicks = frameZone.end - frameZone.start;
+
+    if (GG::TicksToNs(frame.frameTicks) > mBudgetNs) {
+        if (frame.number >= mNextDumpFrame) {
+            Dump(frame);
+            mNextDumpFrame = frame.number + HISTORY / 2;
+            mNumSkippedHitches = 0;
+        }
+        else {
+            mNumSkippedHitches++;
+        }
+    }
+}
+
+/*
+================================================================================
+
+HitchRecorder::Dump
+
+    Writes the hitch frame's slow phase and zones, and then one line for
+    each frame in the buffer, oldest first.
+
+================================================================================
+*/
+void HitchRecorder::Dump(const Frame& hitch)
+{
+    std::string path = GG::MakeTimestampedName("hitch-", ".txt");
+
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) {
+        std::cerr << "*** Couldn't open " << path << " for writing" << std::endl;
+        return;
+    }
+
+    std::fprintf(f, "Hitch in frame %llu: %.2f ms, over the budget of %.2f ms\n",
+                 (unsigned long long)hitch.number, TicksToMs(hitch.frameTicks), mBudgetNs * 1e-6f);
+    if (mNumSkippedHitches > 0) {
+        std::fprintf(f, "(%d more frames went over the budget since the last dump)\n", mNumSkippedHitches);
+    }
+
+    std::fprintf(f, "Slow phase: ");
+    WriteSlowPhase(f, hitch.zones, hitch.numZones, hitch.frameZone);
+    std::fprintf(f, "\n\n");
+
+    // the hitch frame's zones as a tree, one thread at a time
+    std::vector<GG::ProfileEvent> zones(hitch.zones, hitch.zones + hitch.numZones);
+    std::sort(zones.begin(), zones.end(), ZoneOrder);
+
+    std::vector<const char*> threadNames;
+    GG::Profiler::GetThreadNames(&threadNames);
+
+    std::fprintf(f, "Zones of frame %llu:\n", (unsigned long long)hitch.number);
+    for (size_t i = 0; i < zones.size(); i++) {
+        const GG::ProfileEvent& z = zones[i];
+        if (i == 0 || z.threadId != zones[i - 1].threadId) {
+            const char* name = z.threadId < threadNames.size() ? threadNames[z.threadId] : NULL;
+            std::fprintf(f, "  thread %u (%s)\n", (unsigned)z.threadId, name ? name : "unnamed");
+        }
+        std::fprintf(f, "    %*s%-*s %8.3f ms  at %8.3f ms\n", (int)z.depth * 2, "", 32 - (int)z.depth * 2, z.name,
+                     TicksToMs(z.end - z.start), TicksToMs(z.start - zones[0].start));
+    }
+    if (hitch.numDroppedZones > 0) {
+        std::fprintf(f, "    (%d more deeply nested zones weren't kept)\n", hitch.numDroppedZones);
+    }
+
+    // the frames leading up to it
+    std::fprintf(f, "\nLast %d frames, oldest first:\n", HISTORY);
+    std::fprintf(f, "   frame       ms steps draws sprites entities allocs events input   pressed          slow phase\n");
+
+    int numFrames = mNumFrames < (Uint64)HISTORY ? (int)mNumFrames : HISTORY;
+    int oldest = (mFramePos - numFrames + HISTORY) % HISTORY;
+    for (int i = 0; i < numFrames; i++) {
+        WriteFrameLine(f, mFrames[(oldest + i) % HISTORY]);
+    }
+
+    bool ok = std::ferror(f) == 0;
+    if (std::fclose(f) != 0 || !ok) {
+        std::cerr << "*** Error writing " << path << std::endl;
+        return;
+    }
+
+    std::cout << "*** Frame " << hitch.number << " took " << TicksToMs(hitch.frameTicks)
+              << " ms, wrote the last " << numFrames << " frames to " << path << std::endl;
+}
+
+/*
+================================================================================
+
+HitchRecorder::WriteFrameLine
+
+================================================================================
+*/
+void HitchRecorder::WriteFrameLine(FILE* f, const Frame& frame) const
+{
+    const FrameCounters& c = frame.counters;
+    const FrameInput& in = frame.input;
+
+    // the keys as they'd be typed, with SPACE as J
+    static const char INPUT_LETTERS[] = "ADJRKXC";
+    char held[sizeof(INPUT_LETTERS)];
+    for (int b = 0; b < (int)sizeof(INPUT_LETTERS) - 1; b++) {
+        held[b] = (in.input & (1 << b)) ? INPUT_LETTERS[b] : '-';
+    }
+    held[sizeof(INPUT_LETTERS) - 1] = '\0';
+
+    char pressed[64] = "";
+    int numKept = in.numKeysPressed < FrameInput::MAX_KEYS_PRESSED ? in.numKeysPressed : FrameInput::MAX_KEYS_PRESSED;
+    for (int k = 0; k < numKept; k++) {
+        size_t len = std::strlen(pressed);
+        SDL_snprintf(pressed + len, sizeof(pressed) - len, "%s%s", k > 0 ? "," : "", SDL_GetKeyName(in.keysPressed[k]));
+    }
+    if (in.numKeysPressed > numKept) {
+        size_t len = std::strlen(pressed);
+        SDL_snprintf(pressed + len, sizeof(pressed) - len, ",...");
+    }
+
+    bool over = GG::TicksToNs(frame.frameTicks) > mBudgetNs;
+    std::fprintf(f, "%c%7llu %8.2f %5d %5d %7d %8d %6d %6d %-7s %-16s ",
+                 over ? '!' : ' ', (unsigned long long)frame.number, TicksToMs(frame.frameTicks),
+                 c.numSteps, c.numDrawCalls, c.numSprites, c.numEntities, c.numAllocations,
+                 in.numEvents, held, pressed[0] ? pressed : "-");
+    WriteSlowPhase(f, frame.zones, frame.numZones, frame.frameZone);
+    std::fprintf(f, "\n");
+}
@@ -0,0 +1,102 @@
+#ifndef HITCH_RECORDER_H_
+#define HITCH_RECORDER_H_
+
+#include "GG_Profiler.h"
+#include "InputRecording.h"
+#include "ProfilerOverlay.h"
+
+#include <cstdio>
+#include <vector>
+
+/*
+================================================================================
+
+FrameInput struct
+
+    What the player was doing during a frame: the input of the frame's
+    last simulation step (see StepInput), and the keys that got pressed
+    during the frame.
+
+================================================================================
+*/
+struct FrameInput {
+    enum {
+        MAX_KEYS_PRESSED = 4
+    };
+
+    StepInput               input;
+    int                     numEvents;      // SDL events handled
+    SDL_Keycode             keysPressed[MAX_KEYS_PRESSED];
+    int                     numKeysPressed; // can be more than MAX_KEYS_PRESSED, the rest just aren't kept
+};
+
+/*
+================================================================================
+
+HitchRecorder class
+
+    A flight recorder for frame hitches.  It keeps the last few seconds of
+    frames in a ring buffer (each frame's profiling zones, counters and
+    input), and when a frame takes longer than the budget, it dumps the
+    whole buffer to a file named after the current time, like
+    "hitch-20140412-153012.txt".  The file starts with the phase that
+    made the hitch frame slow, found by following the longest zone down
+    from "Frame" for as long as it takes up most of its parent
+    ("Update > LoadScene > LoadScene.BuildLevel"), and then lists the hitch
+    frame's zones and a line for every frame leading up to it.
+
+    Game feeds it every frame with AddFrame (the profiler has to be on, see
+    GG::Profiler).  The ring buffer is allocated by the constructor, so
+    recording doesn't allocate; only dumping does, after the frame is over.
+    After a dump, the recorder waits for half the buffer to fill with new
+    frames before it dumps again, so a burst of slow frames makes one file
+    instead of dozens.  The hitches it skipped get mentioned in the next one.
+
+================================================================================
+*/
+class HitchRecorder {
+
+public:
+    enum {
+        HISTORY = 360,              // frames kept (six seconds at 60 Hz)
+        MAX_ZONES = 64              // zones kept per frame
+    };
+
+private:
+    struct Frame {
+        Uint64              number;
+        Uint64              frameTicks;     // length of the "Frame" zone
+        int                 frameZone;      // index of the "Frame" zone in zones, -1 if there isn't one
+        GG::ProfileEvent    zones[MAX_ZONES];   // the shallowest ones, if there were too many
+        int                 numZones;
+        int                 numDroppedZones;
+        FrameCounters       counters;
+        FrameInput          input;
+    };
+
+    std::vector<Frame>      mFrames;        // ring buffer, the oldest at mFramePos once it's full
+    int                     mFramePos;
+    Uint64                  mNumFrames;     // frames added since the recorder was made
+
+    Uint64                  mBudgetNs;      // 0 turns the recorder off
+    Uint64                  mNextDumpFrame; // no dumping before this one
+    int                     mNumSkippedHitches; // since the last dump
+
+    void                    Dump(const Frame& hitch);
+    void                    WriteFrameLine(FILE* f, const Frame& frame) const;
+
+                            HitchRecorder(const HitchRecorder&);
+    HitchRecorder&          operator= (const HitchRecorder&);
+
+public:
+                            HitchRecorder();
+
+    void                    SetBudgetNs(Uint64 budgetNs)    { mBudgetNs = budgetNs; }
+    Uint64                  GetBudgetNs() const             { return mBudgetNs; }
+    bool                    IsEnabled() const               { return mBudgetNs > 0; }
+
+    void                    AddFrame(const std::vector<GG::ProfileEvent>& events,
+                                     const FrameCounters& counters, const FrameInput& input);
+};
+
+#endif
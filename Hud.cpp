@@ -0,0 +1,68 @@
+#include "Hud.h"
+
+Counter::Counter(float x, float y, const std::string& prefix, SDL_Color color, std::function<int()> source)
+    : Label(x, y, prefix, color)
+    , mPrefix(prefix)
+    , mSource(source)
+    , mValue(0)
+    , mShown(false)
+{
+    Refresh();
+}
+
+bool Counter::Refresh()
+{
+    int value = mSource();
+    if (mShown && value == mValue)
+	{
+        return false;
+    }
+
+    mValue = value;
+    mShown = true;
+
+    char text[64];
+    SDL_snprintf(text, sizeof(text), "%s%d", mPrefix.c_str(), value);
+    SetText(text);
+
+    return true;
+}
+
+
+Hud::Hud()
+{
+}
+
+Hud::~Hud()
+{
+    for (unsigned i = 0; i < mWidgets.size(); i++)
+	{
+        delete mWidgets[i];
+    }
+}
+
+void Hud::Add(HudWidget* widget)
+{
+    mWidgets.push_back(widget);
+}
+
+int Hud::Update()
+{
+    int numChanged = 0;
+    for (unsigned i = 0; i < mWidgets.size(); i++)
+	{
+        if (mWidgets[i]->Refresh())
+		{
+            numChanged++;
+        }
+    }
+    return numChanged;
+}
+
+void Hud::Draw(GG::SpriteBatch* batch) const
+{
+    for (unsigned i = 0; i < mWidgets.size(); i++)
+	{
+        mWidgets[i]->Draw(batch);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef HUD_H_
+#define HUD_H_
+
+#include "Label.h"
+
+#include <functional>
+#include <vector>
+
+/*
+================================================================================
+
+Counter class
+
+    A Label that shows a number after a fixed prefix, like "Points = 25".
+
+    The counter is bound to a function that returns the current value.
+    Refresh calls it and only formats new text (and redoes the layout)
+    when the value differs from what's on the screen.
+
+================================================================================
+*/
+class Counter : public Label {
+
+    std::string             mPrefix;
+    std::function<int()>    mSource;
+    int                     mValue;         // value currently shown
+    bool                    mShown;         // has any value been shown yet?
+
+public:
+                            Counter(float x, float y, const std::string& prefix, SDL_Color color, std::function<int()> source);
+
+    bool                    Refresh() override;
+};
+
+/*
+================================================================================
+
+Hud class
+
+    A retained overlay that sits on top of the game.  It owns a list of
+    widgets, refreshes them once per frame in Update, and draws them on top
+    of everything else in Draw.
+
+    Widgets only do work when the values they show change, so on a frame
+    where nothing changed, Update amounts to a few comparisons and Draw
+    just resubmits quads that were laid out earlier.
+
+================================================================================
+*/
+class Hud {
+
+    std::vector<HudWidget*> mWidgets;
+
+public:
+                            Hud();
+                            ~Hud();
+
+    void                    Add(HudWidget* widget);     // takes ownership
+
+    int                     Update();                   // returns the number of widgets that changed
+    void                    Draw(GG::SpriteBatch* batch) const;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef HUD_WIDGET_H_
+#define HUD_WIDGET_H_
+
+#include "GG_SpriteBatch.h"
+
+/*
+================================================================================
+
+HudWidget class
+
+    Base class for anything that lives in the HUD (see the Hud class).
+
+    Widgets are retained: they keep whatever they need for drawing around
+    from one frame to the next.  Refresh gives a widget a chance to look at
+    the values it shows and redo its layout if any of them changed.  It
+    returns true if the widget changed.  Draw just submits what the widget
+    already has.
+
+================================================================================
+*/
+class HudWidget {
+
+public:
+    virtual                 ~HudWidget() {}
+
+    virtual bool            Refresh()   { return false; }   // static widgets never change by themselves
+    virtual void            Draw(GG::SpriteBatch* batch) const = 0;
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include "InputRecording.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// "GGIN" and the format version, at the start of every file
+static const char MAGIC[4] = { 'G', 'G', 'I', 'N' };
+static const Uint32 VERSION = 1;
+
+// the file is little-endian whatever the CPU is
+static void WriteU16(FILE* f, Uint16 v)
+{
+    std::fputc(v & 0xff, f);
+    std::fputc(v >> 8, f);
+}
+
+static void WriteU32(FILE* f, Uint32 v)
+{
+    WriteU16(f, (Uint16)(v & 0xffff));
+    WriteU16(f, (Uint16)(v >> 16));
+}
+
+static bool ReadU16(FILE* f, Uint16* v)
+{
+    int lo = std::fgetc(f);
+    int hi = std::fgetc(f);
+    *v = (Uint16)(lo | (hi << 8));
+    return hi != EOF;
+}
+
+static bool ReadU32(FILE* f, Uint32* v)
+{
+    Uint16 lo, hi;
+    if (!ReadU16(f, &lo) || !ReadU16(f, &hi)) {
+        return false;
+    }
+    *v = lo | ((Uint32)hi << 16);
+    return true;
+}
+
+/*
+================================================================================
+
+InputRecording constructor
+
+================================================================================
+*/
+InputRecording::InputRecording()
+    : mSeed(0)
+    , mNumSteps(0)
+    , mRunIndex(0)
+    , mRunPos(0)
+    , mStep(0)
+    , mDiverged(false)
+{
+}
+
+/*
+================================================================================
+
+InputRecording::Start
+
+    Starts a new recording of a session that was seeded with seed.
+
+================================================================================
+*/
+void InputRecording::Start(Uint32 seed)
+{
+    mSeed = seed;
+    mRuns.clear();
+    mChecksums.clear();
+    mNumSteps = 0;
+    mRunIndex = 0;
+    mRunPos = 0;
+    mStep = 0;
+    mDiverged = false;
+}
+
+/*
+================================================================================
+
+InputRecording::Add
+
+    Records the input of the next step.
+
+================================================================================
+*/
+void InputRecording::Add(StepInput input)
+{
+    if (mRuns.empty() || mRuns.back().input != input || mRuns.back().length == 0xffff) {
+        Run run;
+        run.input = input;
+        run.length = 0;
+        mRuns.push_back(run);
+    }
+
+    mRuns.back().length++;
+    mNumSteps++;
+}
+
+/*
+================================================================================
+
+InputRecording::Save
+
+================================================================================
+*/
+bool InputRecording::Save(const std::string& path) const
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "*** Couldn't open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    std::fwrite(MAGIC, 1, sizeof(MAGIC), f);
+    WriteU32(f, VERSION);
+    WriteU32(f, mSeed);
+    WriteU32(f, mNumSteps);
+
+    WriteU32(f, (Uint32)mRuns.size());
+    for (size_t i = 0; i < mRuns.size(); i++) {
+        std::fputc(mRuns[i].input, f);
+        WriteU16(f, mRuns[i].length);
+    }
+
+    WriteU32(f, CHECKSUM_INTERVAL);
+    WriteU32(f, (Uint32)mChecksums.size());
+    for (size_t i = 0; i < mChecksums.size(); i++) {
+        WriteU32(f, mChecksums[i]);
+    }
+
+    bool ok = std::ferror(f) == 0;
+    if (std::fclose(f) != 0 || !ok) {
+        std::cerr << "*** Error writing " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+================================================================================
+
+InputRecording::Load
+
+    Reads a recording and gets ready to replay it from the first step.
+
+================================================================================
+*/
+bool InputRecording::Load(const std::string& path)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::cerr << "*** Couldn't open " << path << std::endl;
+        return false;
+    }
+
+    Start(0);
+
+    char magic[sizeof(MAGIC)];
+    Uint32 version = 0;
+    bool ok = std::fread(magic, 1, sizeof(magic), f) == sizeof(magic) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+              ReadU32(f, &version) && version == VERSION;
+    if (!ok) {
+        std::cerr << "*** " << path << " isn't an input recording (or it's from an incompatible version)" << std::endl;
+        std::fclose(f);
+        return false;
+    }
+
+    Uint32 numRuns = 0;
+    ok = ReadU32(f, &mSeed) && ReadU32(f, &mNumSteps) && ReadU32(f, &numRuns);
+
+    Uint32 runSteps = 0;
+    for (Uint32 i = 0; i < numRuns && ok; i++) {
+        Run run;
+        int input = std::fgetc(f);
+        ok = input != EOF && ReadU16(f, &run.length);
+        run.input = (StepInput)input;
+        runSteps += run.length;
+        mRuns.push_back(run);
+    }
+
+    Uint32 interval = 0;
+    Uint32 numChecksums = 0;
+    ok = ok && ReadU32(f, &interval) && ReadU32(f, &numChecksums);
+    for (Uint32 i = 0; i < numChecksums && ok; i++) {
+        Uint32 checksum;
+        ok = ReadU32(f, &checksum);
+        mChecksums.push_back(checksum);
+    }
+
+    std::fclose(f);
+
+    if (!ok || runSteps != mNumSteps) {
+        std::cerr << "*** " << path << " is truncated or corrupt" << std::endl;
+        Start(0);
+        return false;
+    }
+
+    // checksums taken at another interval can't be compared
+    if (interval != CHECKSUM_INTERVAL) {
+        mChecksums.clear();
+    }
+
+    return true;
+}
+
+/*
+================================================================================
+
+InputRecording::Next
+
+    Returns the input of the next step of a replay.  Past the end, there's
+    no input.
+
+================================================================================
+*/
+StepInput InputRecording::Next()
+{
+    if (IsFinished()) {
+        return 0;
+    }
+
+    StepInput input = mRuns[mRunIndex].input;
+    if (++mRunPos == mRuns[mRunIndex].length) {
+        mRunIndex++;
+        mRunPos = 0;
+    }
+    mStep++;
+
+    return input;
+}
+
+/*
+================================================================================
+
+InputRecording::CheckChecksum
+
+    Compares the state after the current replay step with the recording,
+    if there's a checksum for this step.  Reports the first mismatch, and
+    returns false from then on.
+
+================================================================================
+*/
+bool InputRecording::CheckChecksum(Uint32 checksum)
+{
+    if (mDiverged || mStep == 0 || mStep % CHECKSUM_INTERVAL != 0) {
+        return !mDiverged;
+    }
+
+    size_t i = mStep / CHECKSUM_INTERVAL - 1;
+    if (i < mChecksums.size() && mChecksums[i] != checksum) {
+        std::cerr << "*** The replay stopped matching the recording somewhere in the " << (int)CHECKSUM_INTERVAL
+                  << " steps before step " << mStep << std::endl;
+        mDiverged = true;
+    }
+
+    return !mDiverged;
+}
@@ -0,0 +1,102 @@
+#ifndef INPUT_RECORDING_H_
+#define INPUT_RECORDING_H_
+
+#include <SDL.h>
+
+#include <string>
+#include <vector>
+
+/*
+================================================================================
+
+StepInput
+
+    Everything the player can do to the simulation in one step, as bits:
+    the keys the robot reads, and the keys that add or remove crawlers.
+    Game::Step applies one of these per step, whether it came from the
+    keyboard or from a recording.
+
+================================================================================
+*/
+typedef Uint8 StepInput;
+
+enum {
+    INPUT_LEFT = 1,                 // A held
+    INPUT_RIGHT = 2,                // D held
+    INPUT_JUMP = 4,                 // SPACE held
+    INPUT_RESURRECT = 8,            // R held
+    INPUT_KILL_CRAWLERS = 16,       // K pressed
+    INPUT_ADD_STRONG_CRAWLER = 32,  // X pressed
+    INPUT_ADD_WEAK_CRAWLER = 64     // C pressed
+};
+
+/*
+================================================================================
+
+InputRecording class
+
+    A play session, reduced to what it takes to play it again exactly: the
+    seed the world started with, and the input of every simulation step.
+    Since a World runs in fixed steps and takes all its random numbers
+    from its own generator, seeded by the World constructor, feeding the
+    same input to a world built with the same seed (in the same build)
+    gives the same game, bit for bit, however fast or slow the frames come.
+
+    Recording: Start with the seed, then Add each step's input, and Save.
+    The input barely changes from one step to the next, so it's stored as
+    runs of identical steps, a few bytes per key press.
+
+    Replaying: Load, create the World with GetSeed as its seed
+    (World(assets, seed, listener)), then call Next once per step until
+    IsFinished.
+
+    Every CHECKSUM_INTERVAL steps, the game adds a checksum of its state
+    (AddChecksum while recording, CheckChecksum while replaying), so a
+    replay that drifts from the original (say, because the build changed
+    what the game logic does) gets noticed at the second it happened
+    instead of going unnoticed.
+
+================================================================================
+*/
+class InputRecording {
+
+public:
+    enum {
+        CHECKSUM_INTERVAL = 120         // steps
+    };
+
+private:
+    struct Run {
+        StepInput           input;
+        Uint16              length;
+    };
+
+    Uint32                  mSeed;
+    std::vector<Run>        mRuns;
+    std::vector<Uint32>     mChecksums;
+    Uint32                  mNumSteps;
+
+    size_t                  mRunIndex;      // where a replay is
+    Uint32                  mRunPos;
+    Uint32                  mStep;
+    bool                    mDiverged;      // a checksum didn't match
+
+public:
+                            InputRecording();
+
+    void                    Start(Uint32 seed);
+    void                    Add(StepInput input);
+    void                    AddChecksum(Uint32 checksum)    { mChecksums.push_back(checksum); }
+    bool                    Save(const std::string& path) const;
+
+    bool                    Load(const std::string& path);
+    StepInput               Next();
+    bool                    IsFinished() const      { return mStep >= mNumSteps; }
+    bool                    CheckChecksum(Uint32 checksum);
+
+    Uint32                  GetSeed() const         { return mSeed; }
+    Uint32                  GetNumSteps() const     { return mNumSteps; }
+    Uint32                  GetStep() const         { return mStep; }
+};
+
+#endif
@@ -3,24 +3,55 @@
 
 #include <iostream>
 
-Label::Label(float x, float y, const std::string name)
-    : mRenderable(NULL)
-    , mPosX(x)
-    , mPosY(y)
+Label::Label(float x, float y, const std::string& text, SDL_Color color)
+    : mGlyphs(NULL)
+    , mText()
+    , mColor(color)
+    , mRect()
 {
-    GG::Texture* tex = Game::GetInstance()->GetTextureManager()->GetTexture(name);
-
-    mRenderable = new GG::Renderable(tex, tex);
+    mGlyphs = Game::GetInstance()->GetTextureManager()->GetGlyphAtlas();
 
     // Position the top left hand corner of the label at
 	// the specified coordinates
     mRect.x = (int)x;
     mRect.y = (int)y;
-    mRect.w = mRenderable->GetWidth();
-    mRect.h = mRenderable->GetHeight();
+    mRect.h = mGlyphs ? mGlyphs->GetHeight() : 0;
+
+    mText = text;
+    Layout();
 }
 
 Label::~Label()
 {
-    delete mRenderable;
+}
+
+void Label::SetText(const char* text)
+{
+    if (mText == text)
+	{
+        return;     // nothing to do
+    }
+
+    mText = text;
+    Layout();
+}
+
+// Lays out the text and fits the screen rect around it
+void Label::Layout()
+{
+    if (mGlyphs)
+	{
+        mRect.w = mGlyphs->Layout(mText.c_str(), mRect.x, mRect.y, &mQuads);
+    }
+}
+
+void Label::Draw(GG::SpriteBatch* batch) const
+{
+    if (mGlyphs)
+	{
+        for (unsigned i = 0; i < mQuads.size(); i++)
+		{
+            batch->Draw(mGlyphs->GetTexture(), mQuads[i].src, mQuads[i].dst, 0.0, NULL, SDL_FLIP_NONE, mColor);
+        }
+    }
 }
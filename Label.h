@@ -1,22 +1,49 @@
 #ifndef LABEL_H_
 #define LABEL_H_
 
-#include "GG_Renderable.h"
+#include "HudWidget.h"
+#include "GG_Text.h"
 
-class Label {
+#include <string>
+#include <vector>
 
-    GG::Renderable*         mRenderable;
+/*
+================================================================================
+
+Label class
+
+    A Label is a line of text on the screen.  The text is drawn with the
+    texture manager's glyph atlas, so changing it is cheap: no new texture
+    has to be rendered.  The screen rect follows the size of the text.
+
+    The glyph layout is worked out when the text changes and kept around,
+    so drawing an unchanged label doesn't lay anything out.  Setting the
+    same text again does nothing.
+
+================================================================================
+*/
+class Label : public HudWidget {
+
+    const GG::GlyphAtlas*   mGlyphs;
+    std::string             mText;
+    SDL_Color               mColor;
     GG::Rect                mRect;
 
-    float                   mPosX;
-    float                   mPosY;
+    std::vector<GG::GlyphQuad>  mQuads;     // laid out text
+
+    void                    Layout();
 
 public:
-                            Label(float x, float y, const std::string name);
+                            Label(float x, float y, const std::string& text, SDL_Color color);
                             ~Label();
 
-    GG::Renderable*         GetRenderable()		   { return mRenderable; }
+    const std::string&      GetText() const         { return mText; }
+    void                    SetText(const char* text);
+
+    SDL_Color               GetColor() const        { return mColor; }
     const GG::Rect&         GetRect() const         { return mRect; }
+
+    void                    Draw(GG::SpriteBatch* batch) const override;
 };
 
-#endif
\ No newline at end of file
+#endif
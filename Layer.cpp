@@ -1,16 +1,10 @@
 #include "Layer.h"
-#include "Game.h"
 
 #include <iostream>
 
-Layer::Layer(float x, float y, float w, float h, const std::string texName, const std::string grayTexName)
-    : mRenderable(NULL)
+Layer::Layer(const GG::AnimationClip* clip, float x, float y, float w, float h)
+    : mRenderable(clip)
 {
-    GG::Texture* tex = Game::GetInstance()->GetTextureManager()->GetTexture(texName);
-	GG::Texture* grayTex = Game::GetInstance()->GetTextureManager()->GetTexture(grayTexName);
-
-    mRenderable = new GG::Renderable(tex, grayTex);
-
     // center the layer at the specified coordinate
     mRect.x = (int)x;
     mRect.y = (int)y;
@@ -18,12 +12,7 @@ Layer::Layer(float x, float y, float w, float h, const std::string texName, cons
     mRect.h = (int)h;
 }
 
-Layer::~Layer()
-{
-    delete mRenderable;
-}
-
 void Layer::SetGrayscale(bool grayscale)
 {
-	mRenderable->SetGrayscale(grayscale);
+	mRenderable.SetGrayscale(grayscale);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef LAYER_H_
 #define LAYER_H_
 
+#include "GG_Graphics.h"
 #include "GG_Renderable.h"
 
 /*
@@ -17,14 +18,14 @@ Layer class
 
 class Layer {
 
-    GG::Renderable*         mRenderable;
+    GG::Renderable          mRenderable;
     GG::Rect                mRect;
 
 public:
-                            Layer(float x, float y, float w, float h, const std::string texName, const std::string grayTexName);
-                            ~Layer();
+                            Layer(const GG::AnimationClip* clip, float x, float y, float w, float h);
 
-    GG::Renderable*         GetRenderable()		   { return mRenderable; }
+    GG::Renderable*         GetRenderable()		   { return &mRenderable; }
+    const GG::Renderable*   GetRenderable() const   { return &mRenderable; }
     const GG::Rect&         GetRect() const         { return mRect; }
 
 	void					SetGrayscale(bool grayscale);
@@ -1,31 +1,70 @@
 #include "Level.h"
-#include "Game.h"
+#include "World.h"
+#include "Assets.h"
+#include "GG_Profiler.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
-#include "Crawler.h"
-#include "CrawlerWeak.h"
-#include "CrawlerStrong.h"
-#include "Coin.h"
 
-Grid* LoadLevel(const std::string& filename, bool items)
+// Reads a level file into level
+bool LoadLevel(const std::string& filename, LevelData* level)
 {
+	GG_PROFILE_SCOPE("LoadLevels.ReadLevel");
+
 	std::fstream f(filename);
 	//f.open(filename);
 	if (!f.good())
 	{
 		std::cerr << "*** Error: failed to open " << filename << std::endl;
-		return NULL;
+		return false;
 	}
 
 	std::string line;
-	std::vector<std::string> lines;
+	level->lines.clear();
 
 	while (std::getline(f, line))
 	{
-		lines.push_back(line);
+		level->lines.push_back(line);
+	}
+
+	return true;
+}
+
+// Same as LoadLevel, but the level comes from memory (e.g., an asset pack)
+void LoadLevelFromText(const char* text, size_t size, LevelData* level)
+{
+	std::vector<std::string>& lines = level->lines;
+	lines.clear();
+
+	size_t start = 0;
+	while (start < size)
+	{
+		size_t end = start;
+		while (end < size && text[end] != '\n')
+		{
+			end++;
+		}
+
+		// the pack stores the files as they are, so there may be Windows line endings
+		size_t len = end - start;
+		if (len > 0 && text[start + len - 1] == '\r')
+		{
+			len--;
+		}
+		lines.push_back(std::string(text + start, len));
+
+		start = end + 1;
 	}
+}
+
+// Makes the level's grid, and spawns its entities into world
+// (only the coins and mushrooms unless items is set)
+Grid* BuildLevel(const LevelData& level, World& world, bool items)
+{
+	GG_PROFILE_SCOPE("LoadScene.BuildLevel");
+
+	const std::vector<std::string>& lines = level.lines;
 
 	// Just outputs the file contents (for debugging)
 	for (unsigned i = 0; i < lines.size(); i++)
@@ -48,15 +87,15 @@ Grid* LoadLevel(const std::string& filename, bool items)
 		}
 	}
 
-	Game* game = Game::GetInstance();
-	GG::Texture* tex = game->GetTextureManager()->GetTexture("Tiles");
-	GG::Texture* grayTex = game->GetTextureManager()->GetTexture("TilesGray");
-	GG::Texture* tex2 = game->GetTextureManager()->GetTexture("Tiles2");
-	GG::Texture* grayTex2 = game->GetTextureManager()->GetTexture("TilesGray2");
+	EntityStore* entities = world.GetEntities();
+	GG::Random* random = world.GetRandom();
+	const GG::AnimationClip* tiles = world.GetClips()->GetClip(CLIP_TILES);
+	const GG::AnimationClip* tiles2 = world.GetClips()->GetClip(CLIP_TILES2);
 
-	int numCells = tex->GetNumCells();
-	int tileWidth = tex->GetCellWidth();
-    int tileHeight = tex->GetCellHeight();
+	// each tile shows a random cell of the tile sheet
+	int numCells = tiles->numFrames;
+	int tileWidth = tiles->frameWidth;
+    int tileHeight = tiles->frameHeight;
 	Grid* grid = new Grid;
 	grid->Allocate(numCols, numRows, tileWidth, tileHeight);
 
@@ -74,9 +113,7 @@ Grid* LoadLevel(const std::string& filename, bool items)
 			{
 				if (items)
 				{
-					Crawler* crawler = new CrawlerWeak((float)col*tileWidth, (float)(row+1)*tileHeight, true);
-					crawler->SetDirection(GG::RandomSign());
-					game->GetCrawlers()->push_back(crawler);
+					entities->SpawnCrawler((float)col*tileWidth, (float)(row+1)*tileHeight, false, random->Sign(), world.GetTime());
 				}
 				break;
 			}
@@ -84,34 +121,30 @@ Grid* LoadLevel(const std::string& filename, bool items)
 			{
 				if (items)
 				{
-					Crawler* crawler = new CrawlerStrong((float)col*tileWidth, (float)(row+1)*tileHeight, false);
-					crawler->SetDirection(GG::RandomSign());
-					game->GetCrawlers()->push_back(crawler);
+					entities->SpawnCrawler((float)col*tileWidth, (float)(row+1)*tileHeight, true, random->Sign(), world.GetTime());
 				}
 				break;
 			}
 			case 'c':
 			{
-				Coin* coin = new Coin((float)col*tileWidth,(float) (row+1)*tileHeight);
-				game->GetCoins()->push_back(coin);
+				entities->SpawnCoin((float)col*tileWidth,(float) (row+1)*tileHeight);
 				break;
 			}
 			case '@':
 			{
-				int r = GG::RandomInt(numCells);
-				tile->SetRenderable(new GG::Renderable(tex2, grayTex2, r));
+				int r = random->Int(numCells);
+				tile->SetRenderable(new GG::Renderable(tiles2, r));
 				break;
 			}
 			case 'm':
 			{
-				Layer* mushroom = new Layer((float)col*tileWidth, (float)row*tileHeight-8.0f, 40.0f, 40.0f, "Mushroom", "MushroomGray");
-				game->GetMushrooms()->push_back(mushroom);
+				entities->SpawnMushroom((float)col*tileWidth, (float)row*tileHeight-8.0f, 40.0f, 40.0f);
 				break;
 			}
 			case '#':
 			{
-				int r = GG::RandomInt(numCells);
-				tile->SetRenderable(new GG::Renderable(tex, grayTex, r));
+				int r = random->Int(numCells);
+				tile->SetRenderable(new GG::Renderable(tiles, r));
 				break;
 			}
 			default:
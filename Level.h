@@ -3,7 +3,30 @@
 
 #include "Grid.h"
 
+#include <string>
+#include <vector>
 
-Grid* LoadLevel(const std::string& filename, bool items);
+class World;
+
+/*
+================================================================================
+
+LevelData struct
+
+    A level file, read once and kept: its lines, one row of tiles each
+    ('#' and '@' are tiles, 'w' and 's' weak and strong crawlers, 'c'
+    coins and 'm' mushrooms).  BuildLevel turns it into a grid and
+    entities in a world, as many times and in as many worlds as needed.
+
+================================================================================
+*/
+struct LevelData {
+    std::vector<std::string>    lines;
+};
+
+bool LoadLevel(const std::string& filename, LevelData* level);
+void LoadLevelFromText(const char* text, size_t size, LevelData* level);
+
+Grid* BuildLevel(const LevelData& level, World& world, bool items);
 
 #endif
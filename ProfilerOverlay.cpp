@@ -0,0 +1,200 @@
+#include "ProfilerOverlay.h"
+
+#include <cstring>
+
+// the zones that make up the phase bars, and what to call them
+static const char* const PHASE_ZONES[] = {
+    "Events", "Update.Robot", "Update.Coins", "Update.Crawlers", "Update.Meteors",
+    "Update.Hud", "Draw.Scene", "Draw.Entities", "Present"
+};
+static const char* const PHASE_NAMES[] = {
+    "events", "robot", "coins", "crawlers", "meteors",
+    "HUD", "grid draw", "entity draw", "present"
+};
+
+static const int PANEL_WIDTH = 320;
+static const int MARGIN = 6;
+static const int GRAPH_HEIGHT = 60;
+static const int ROW_HEIGHT = 22;
+static const int NUM_COUNTER_ROWS = 3;
+
+static const float FRAME_60HZ_MS = 1000.0f / 60.0f;
+static const float GRAPH_SCALE = GRAPH_HEIGHT / (2.0f * FRAME_60HZ_MS);    // the graph tops out at two 60 Hz frames
+static const float BAR_SCALE = 120.0f / FRAME_60HZ_MS;                     // a 60 Hz frame fills the width of a bar
+
+static const float DISPLAY_INTERVAL_NS = 250000000.0f;
+
+static const SDL_Color PANEL_COLOR = { 0, 0, 0, 170 };
+static const SDL_Color GOOD_COLOR = { 80, 220, 80, 255 };
+static const SDL_Color SLOW_COLOR = { 240, 200, 40, 255 };
+static const SDL_Color HITCH_COLOR = { 240, 60, 60, 255 };
+static const SDL_Color STEP_LINE_COLOR = { 80, 200, 255, 255 };
+static const SDL_Color FRAME_LINE_COLOR = { 255, 255, 255, 255 };
+static const SDL_Color BAR_COLOR = { 80, 160, 255, 255 };
+static const SDL_Color TEXT_COLOR = { 255, 255, 255, 255 };
+
+/*
+================================================================================
+
+ProfilerOverlay constructor
+
+    Puts the top left corner of the panel at (x, y).  stepMs is the length
+    of a simulation step, which gets its own line in the graph.
+
+================================================================================
+*/
+ProfilerOverlay::ProfilerOverlay(int x, int y, float stepMs)
+    : mPanel(x, y, PANEL_WIDTH, 0)
+    , mGraph(x + MARGIN, y + MARGIN, HISTORY, GRAPH_HEIGHT)
+    , mBarX(x + PANEL_WIDTH - MARGIN - (int)(BAR_SCALE * FRAME_60HZ_MS))
+    , mStepMs(stepMs)
+    , mHistoryPos(0)
+    , mFrameTicks(0)
+    , mNumFrames(0)
+{
+    for (int i = 0; i < HISTORY; i++) {
+        mFrameMs[i] = 0.0f;
+    }
+    for (int p = 0; p < NUM_PHASES; p++) {
+        mPhaseTicks[p] = 0;
+        mPhaseMs[p] = 0.0f;
+    }
+    std::memset(&mCounters, 0, sizeof(mCounters));
+
+    int rowY = mGraph.y + GRAPH_HEIGHT + MARGIN;
+    for (int row = 0; row < NUM_PHASES + NUM_COUNTER_ROWS; row++) {
+        const char* text = row < NUM_PHASES ? PHASE_NAMES[row] : "";
+        mLabels.push_back(new Label((float)(x + MARGIN), (float)rowY, text, TEXT_COLOR));
+        rowY += ROW_HEIGHT;
+    }
+
+    mPanel.h = rowY + MARGIN - y;
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    for (size_t i = 0; i < mLabels.size(); i++) {
+        delete mLabels[i];
+    }
+}
+
+/*
+================================================================================
+
+ProfilerOverlay::AddFrame
+
+    Takes in one frame's worth of zones (the "Frame" zone gives the frame
+    time) and counters.
+
+================================================================================
+*/
+void ProfilerOverlay::AddFrame(const std::vector<GG::ProfileEvent>& events, const FrameCounters& counters)
+{
+    mFrameZones.Clear();
+    mFrameZones.Add(events);
+
+    const GG::ProfileSummary::Zone* frame = mFrameZones.FindZone("Frame");
+    if (!frame) {
+        return;     // the profiler got turned on in the middle of the frame
+    }
+
+    mFrameMs[mHistoryPos] = GG::TicksToNs(frame->totalTicks) * 1e-6f;
+    mHistoryPos = (mHistoryPos + 1) % HISTORY;
+
+    for (int p = 0; p < NUM_PHASES; p++) {
+        const GG::ProfileSummary::Zone* zone = mFrameZones.FindZone(PHASE_ZONES[p]);
+        if (zone) {
+            mPhaseTicks[p] += zone->totalTicks;
+        }
+    }
+
+    mFrameTicks += frame->totalTicks;
+    mCounters.numDrawCalls += counters.numDrawCalls;
+    mCounters.numSprites += counters.numSprites;
+    mCounters.numEntities += counters.numEntities;
+    mCounters.numAllocations += counters.numAllocations;
+    mNumFrames++;
+
+    if (GG::TicksToNs(mFrameTicks) >= DISPLAY_INTERVAL_NS) {
+        UpdateDisplay();
+    }
+}
+
+/*
+================================================================================
+
+ProfilerOverlay::UpdateDisplay
+
+    Turns what's been added up since the last update into averages per
+    frame, and redoes the text.
+
+================================================================================
+*/
+void ProfilerOverlay::UpdateDisplay()
+{
+    float invFrames = 1.0f / mNumFrames;
+    char text[128];
+
+    for (int p = 0; p < NUM_PHASES; p++) {
+        mPhaseMs[p] = GG::TicksToNs(mPhaseTicks[p]) * 1e-6f * invFrames;
+        mPhaseTicks[p] = 0;
+
+        SDL_snprintf(text, sizeof(text), "%s  %.2f", PHASE_NAMES[p], mPhaseMs[p]);
+        mLabels[p]->SetText(text);
+    }
+
+    float frameMs = GG::TicksToNs(mFrameTicks) * 1e-6f * invFrames;
+    SDL_snprintf(text, sizeof(text), "frame  %.2f ms  (%.0f fps)", frameMs, frameMs > 0.0f ? 1000.0f / frameMs : 0.0f);
+    mLabels[NUM_PHASES]->SetText(text);
+
+    SDL_snprintf(text, sizeof(text), "%d draw calls,  %d sprites",
+                 (int)(mCounters.numDrawCalls * invFrames + 0.5f), (int)(mCounters.numSprites * invFrames + 0.5f));
+    mLabels[NUM_PHASES + 1]->SetText(text);
+
+    SDL_snprintf(text, sizeof(text), "%d entities,  %.1f allocs/frame",
+                 (int)(mCounters.numEntities * invFrames + 0.5f), mCounters.numAllocations * invFrames);
+    mLabels[NUM_PHASES + 2]->SetText(text);
+
+    mFrameTicks = 0;
+    std::memset(&mCounters, 0, sizeof(mCounters));
+    mNumFrames = 0;
+}
+
+/*
+================================================================================
+
+ProfilerOverlay::Draw
+
+================================================================================
+*/
+void ProfilerOverlay::Draw(GG::SpriteBatch* batch) const
+{
+    batch->FillRect(mPanel, PANEL_COLOR);
+
+    // frame time graph, oldest on the left
+    int bottom = mGraph.y + mGraph.h;
+    for (int i = 0; i < HISTORY; i++) {
+        float ms = mFrameMs[(mHistoryPos + i) % HISTORY];
+        int h = (int)(ms * GRAPH_SCALE);
+        h = h < GRAPH_HEIGHT ? h : GRAPH_HEIGHT;
+
+        const SDL_Color& color = ms <= FRAME_60HZ_MS * 1.1f ? GOOD_COLOR : (ms <= FRAME_60HZ_MS * 2.0f ? SLOW_COLOR : HITCH_COLOR);
+        batch->FillRect(GG::Rect(mGraph.x + i, bottom - h, 1, h), color);
+    }
+    batch->FillRect(GG::Rect(mGraph.x, bottom - (int)(mStepMs * GRAPH_SCALE), mGraph.w, 1), STEP_LINE_COLOR);
+    batch->FillRect(GG::Rect(mGraph.x, bottom - (int)(FRAME_60HZ_MS * GRAPH_SCALE), mGraph.w, 1), FRAME_LINE_COLOR);
+
+    // phase bars, next to their labels
+    int maxWidth = mPanel.x + mPanel.w - MARGIN - mBarX;
+    for (int p = 0; p < NUM_PHASES; p++) {
+        int w = (int)(mPhaseMs[p] * BAR_SCALE + 0.5f);
+        w = w < maxWidth ? w : maxWidth;
+
+        const GG::Rect& labelRect = mLabels[p]->GetRect();
+        batch->FillRect(GG::Rect(mBarX, labelRect.y + labelRect.h / 4, w, labelRect.h / 2), BAR_COLOR);
+    }
+
+    for (size_t i = 0; i < mLabels.size(); i++) {
+        mLabels[i]->Draw(batch);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef PROFILER_OVERLAY_H_
+#define PROFILER_OVERLAY_H_
+
+#include "GG_Profiler.h"
+#include "GG_SpriteBatch.h"
+#include "Label.h"
+
+#include <vector>
+
+/*
+================================================================================
+
+FrameCounters struct
+
+    The numbers besides zone times that the overlay shows for each frame.
+
+================================================================================
+*/
+struct FrameCounters {
+    int                     numDrawCalls;
+    int                     numSprites;
+    int                     numEntities;
+    int                     numAllocations;     // operator new calls during the frame
+    int                     numSteps;           // simulation steps run (only the hitch recorder shows this)
+};
+
+/*
+================================================================================
+
+ProfilerOverlay class
+
+    A panel that shows where the frames go, drawn on top of the game:
+    - a rolling graph of the last few seconds of frame times, with lines at
+      the simulation step and at 60 Hz
+    - a bar for each phase of the frame (events, robot, coins, crawlers,
+      meteors, HUD, grid draw, entity draw and present), averaged over a
+      quarter second so the numbers can be read
+    - counters for draw calls, sprites, entities and allocations
+
+    Game feeds it each frame's profiling zones with AddFrame (the profiler
+    has to be on, see GG::Profiler), and draws it with Draw.  The text only
+    gets laid out again when the averages are updated, so the overlay is a
+    few hundred solid quads and a few labels, in a couple of draw calls.
+
+================================================================================
+*/
+class ProfilerOverlay {
+
+    enum {
+        HISTORY = 240,              // frames in the graph
+        NUM_PHASES = 9
+    };
+
+    GG::Rect                mPanel;
+    GG::Rect                mGraph;
+    int                     mBarX;          // where the phase bars start
+    float                   mStepMs;        // where to draw the simulation step line
+
+    float                   mFrameMs[HISTORY];      // frame times, oldest first starting at mHistoryPos
+    int                     mHistoryPos;
+
+    GG::ProfileSummary      mFrameZones;    // scratch, for summing up one frame
+    Uint64                  mPhaseTicks[NUM_PHASES];    // since the last display update
+    Uint64                  mFrameTicks;
+    FrameCounters           mCounters;      // added up since the last display update
+    int                     mNumFrames;     // since the last display update
+
+    float                   mPhaseMs[NUM_PHASES];   // what's on display
+
+    std::vector<Label*>     mLabels;        // one per phase, then the counters
+
+    void                    UpdateDisplay();
+
+                            ProfilerOverlay(const ProfilerOverlay&);
+    ProfilerOverlay&        operator= (const ProfilerOverlay&);
+
+public:
+                            ProfilerOverlay(int x, int y, float stepMs);
+                            ~ProfilerOverlay();
+
+    void                    AddFrame(const std::vector<GG::ProfileEvent>& events, const FrameCounters& counters);
+
+    void                    Draw(GG::SpriteBatch* batch) const;
+};
+
+#endif
@@ -1,18 +1,21 @@
 #include "Robot.h"
-#include "Game.h"
+#include "World.h"
+#include "Assets.h"
 #include "Grid.h"
 
 const float Robot::GRAVITY = 2500.0f;
 
-Robot::Robot(float x, float y)
-	: mRenderable(NULL)
+Robot::Robot(World& world, float x, float y)
+	: mWorld(world)
+	, mRenderable(NULL)
 	, mRect(0,0,0,0)
-	, mRenderableIdle(NULL)
-	, mRenderableRun(NULL)
-	, mRenderableJump(NULL)
-	, mRenderableDie(NULL)
-	, mRenderableWalk(NULL)
-	, mRenderableCelebrate(NULL)
+	, mPrevRect(0,0,0,0)
+	, mRenderableIdle(world.GetClips()->GetClip(CLIP_ROBOT_IDLE))
+	, mRenderableRun(world.GetClips()->GetClip(CLIP_ROBOT_RUN))
+	, mRenderableJump(world.GetClips()->GetClip(CLIP_ROBOT_JUMP))
+	, mRenderableDie(world.GetClips()->GetClip(CLIP_ROBOT_DIE))
+	, mRenderableWalk(world.GetClips()->GetClip(CLIP_ROBOT_WALK))
+	, mRenderableCelebrate(world.GetClips()->GetClip(CLIP_ROBOT_CELEBRATE))
 	, mCollisionRect(0,0,0,0)
 	, mBottomTileRect(0,0,0,0)
 	, mTopTileRect(0,0,0,0)
@@ -25,67 +28,36 @@ Robot::Robot(float x, float y)
 	, mJumpDisabled(0)
 	, mVelocityY(-850.0f)
 {
-	Game* game = Game::GetInstance();
-	GG::TextureManager* texMgr = game->GetTextureManager();
-	GG::Texture *tex = texMgr->GetTexture("RobotIdle");
-	GG::Texture *grayTex = texMgr->GetTexture("RobotIdleGray");
-	mRenderableIdle = new GG::Renderable(tex, grayTex, 1.0f, true);
-	tex = texMgr->GetTexture("RobotRun");
-	grayTex = texMgr->GetTexture("RobotRunGray");
-	mRenderableRun = new GG::Renderable(tex, grayTex, 0.5f, true);
-	tex = texMgr->GetTexture("RobotJump");
-	grayTex = texMgr->GetTexture("RobotJumpGray");
-	mRenderableJump = new GG::Renderable(tex, grayTex, 1.0f, true);
-	tex = texMgr->GetTexture("RobotDie");
-	grayTex = texMgr->GetTexture("RobotDieGray");
-	mRenderableDie = new GG::Renderable(tex, grayTex, 1.4f, false);
-	tex = texMgr->GetTexture("RobotWalk");
-	grayTex = texMgr->GetTexture("RobotWalkGray");
-	mRenderableWalk = new GG::Renderable(tex, grayTex, 1.0f, true);
-	tex = texMgr->GetTexture("RobotCelebrate");
-	grayTex = texMgr->GetTexture("RobotCelebrateGray");
-	mRenderableCelebrate = new GG::Renderable(tex, grayTex, 1.4f, true);
-
-	mRenderable = mRenderableIdle;
+	mRenderable = &mRenderableIdle;
 	mRect.x = (int)x;
 	mRect.y = (int)y;
 	mRect.w = (int)mRenderable->GetWidth();
 	mRect.h = (int)mRenderable->GetHeight();
+	mPrevRect = mRect;
 
 	SetCollisionRect();
 }
 
-Robot::~Robot()
-{
-	delete mRenderableIdle;
-	delete mRenderableRun;
-	delete mRenderableJump;
-	delete mRenderableDie;
-	delete mRenderableWalk;
-	delete mRenderableCelebrate;
-}
-
 void Robot::Update(float dt)
 {
 	const float runningSpeed = 200;  // in pixels per second
 	const float walkingSpeed = 10;  // in pixels per second
-	Game* game = Game::GetInstance();
 
 	// Get the tiles that're directly above and beneath the robot's feet
-	int tileWidth = game->GetGrid()->TileWidth();
-    int tileHeight = game->GetGrid()->TileHeight();
+	int tileWidth = mWorld.GetGrid()->TileWidth();
+    int tileHeight = mWorld.GetGrid()->TileHeight();
 	mBottomTileRect.w = mTopTileRect.w = tileWidth;
 	mBottomTileRect.h = mTopTileRect.h = tileHeight;
 	// Get the bottom tile
 	int row = (mCollisionRect.y + mCollisionRect.h)/tileHeight;
 	int column = (mCollisionRect.x + mCollisionRect.w/2)/tileWidth;
-	GG::Renderable *bottomTileRenderable = game->GetGrid()->GetTile(row, column)->GetRenderable();
+	GG::Renderable *bottomTileRenderable = mWorld.GetGrid()->GetTile(row, column)->GetRenderable();
 	mBottomTileRect.x = column*tileWidth;
 	mBottomTileRect.y = row*tileHeight;
 	// Get the top tile
 	row = (mCollisionRect.y)/tileHeight;
 	column = (mCollisionRect.x + mCollisionRect.w/2)/tileWidth;
-	GG::Renderable *topTileRenderable = game->GetGrid()->GetTile(row, column)->GetRenderable();
+	GG::Renderable *topTileRenderable = mWorld.GetGrid()->GetTile(row, column)->GetRenderable();
 	mTopTileRect.x = column*tileWidth;
 	mTopTileRect.y = row*tileHeight;
 	//printf("\nRobot(%i, %i, %i, %i)", mCollisionRect.x, mCollisionRect.y, mCollisionRect.w, mCollisionRect.h);
@@ -98,9 +70,9 @@ void Robot::Update(float dt)
 		{
 			mDirection = 0;
 		}
-		if (mRect.x + mRect.w > game->GetFlagPole()->GetRect().x)
+		if (mRect.x + mRect.w > mWorld.GetFlagPole()->GetRect().x)
 		{
-			mRenderable = mRenderableCelebrate;
+			mRenderable = &mRenderableCelebrate;
 		}
 		else
 		{
@@ -115,21 +87,22 @@ void Robot::Update(float dt)
 	// anything else until it's brought back to life by using the "R" key (resurrect)
 	if (mDead)
 	{
-		if (mRenderable != mRenderableDie)
+		if (mRenderable != &mRenderableDie)
 		{
-			mRenderable = mRenderableDie;
+			mRenderable = &mRenderableDie;
 		}
-		if (game->IsKeyDown(SDL_SCANCODE_R) && mVelocityY == 0 && mLives > 0)
+		if (mWorld.IsKeyDown(SDL_SCANCODE_R) && mVelocityY == 0 && mLives > 0)
 		{
 			mDead = 0;
-			mRenderableDie->Rewind();
+			mRenderableDie.Rewind();
 			mVelocityY = -850.0f;
 			mRect.x = 35;
-			mRect.y = game->GetScrHeight()-160;
+			mRect.y = mWorld.GetHeight()-160;
+			mPrevRect = mRect;	// don't slide back from where it died
 			SetCollisionRect();
 			mDirection = 0;
-			game->SetScene(0);
-			game->LoadScene(game->GetScene(), true);
+			mWorld.SetScene(0);
+			mWorld.LoadScene(mWorld.GetScene(), true);
 			return;
 		}
 		mVelocityY += GRAVITY * dt;
@@ -166,20 +139,20 @@ void Robot::Update(float dt)
 			}
 		}
 	}
-	else if (game->IsKeyDown(SDL_SCANCODE_SPACE))
+	else if (mWorld.IsKeyDown(SDL_SCANCODE_SPACE))
 	{
 		if (!mJumpDisabled)
 		{
 			mJumpDisabled = true;
 			if (mJumping == 0 )
 			{
-				game->PlaySound("Jump");
+				mWorld.PlaySound(SOUND_JUMP);
 				mJumping = 1;
-				mRenderableJump->Rewind();
-				mRenderable = mRenderableJump;
+				mRenderableJump.Rewind();
+				mRenderable = &mRenderableJump;
 			}
 		}
-		else if (game->IsKeyDown(SDL_SCANCODE_A) || game->IsKeyDown(SDL_SCANCODE_D))
+		else if (mWorld.IsKeyDown(SDL_SCANCODE_A) || mWorld.IsKeyDown(SDL_SCANCODE_D))
 		{
 			//Now we check if he is jumping
 			if (mJumping)
@@ -187,15 +160,15 @@ void Robot::Update(float dt)
 				//If not jumping anymore change the renderable
 				if (!mRenderable->IsAnimating())
 				{
-					mRenderable = mRenderableRun;
+					mRenderable = &mRenderableRun;
 				}
 			}
 			else
 			{
 				//Else, if the renderable is not Run then set it to run
-				if (mRenderable != mRenderableRun)
+				if (mRenderable != &mRenderableRun)
 				{
-					mRenderable = mRenderableRun;
+					mRenderable = &mRenderableRun;
 				}
 			}
 		}
@@ -208,20 +181,20 @@ void Robot::Update(float dt)
 				//If not jumping anymore change the renderable
 				if (!mRenderable->IsAnimating())
 				{
-					mRenderable = mRenderableIdle;
+					mRenderable = &mRenderableIdle;
 				}
 			}
 			//Else, if the renderable is not Idle then set it to idle
 			else
 			{
-				if (mRenderable != mRenderableIdle)
+				if (mRenderable != &mRenderableIdle)
 				{
-					mRenderable = mRenderableIdle;
+					mRenderable = &mRenderableIdle;
 				}
 			}
 		}
 	}
-	else if (game->IsKeyDown(SDL_SCANCODE_A) || game->IsKeyDown(SDL_SCANCODE_D))
+	else if (mWorld.IsKeyDown(SDL_SCANCODE_A) || mWorld.IsKeyDown(SDL_SCANCODE_D))
 	{
 		mJumpDisabled = false;
 		//Now we check if he is jumping
@@ -230,15 +203,15 @@ void Robot::Update(float dt)
 			//If not jumping anymore change the renderable
 			if (!mRenderable->IsAnimating())
 			{
-				mRenderable = mRenderableRun;
+				mRenderable = &mRenderableRun;
 			}
 		}
 		else
 		{
 			//Else, if the renderable is not Run then set it to run
-			if (mRenderable != mRenderableRun)
+			if (mRenderable != &mRenderableRun)
 			{
-				mRenderable = mRenderableRun;
+				mRenderable = &mRenderableRun;
 			}
 		}
 	}
@@ -252,15 +225,15 @@ void Robot::Update(float dt)
 			//If not jumping anymore change the renderable
 			if (!mRenderable->IsAnimating())
 			{
-				mRenderable = mRenderableIdle;
+				mRenderable = &mRenderableIdle;
 			}
 		}
 		//Else, if the renderable is not Idle then set it to idle
 		else
 		{
-			if (mRenderable != mRenderableIdle)
+			if (mRenderable != &mRenderableIdle)
 			{
-				mRenderable = mRenderableIdle;
+				mRenderable = &mRenderableIdle;
 			}
 		}
 	}
@@ -286,14 +259,14 @@ void Robot::Update(float dt)
 		{
 			if (mCollisionRect.y < mTopTileRect.y + mTopTileRect.h)
 			{
-				game->StopSounds();
-				game->PlaySound("Block");
+				mWorld.StopSounds();
+				mWorld.PlaySound(SOUND_BLOCK);
 				mVelocityY = -mVelocityY;
 			}
 		}
 	}
 	// Change the robot's horizontal position based on key input
-    if (game->IsKeyDown(SDL_SCANCODE_A)) 
+    if (mWorld.IsKeyDown(SDL_SCANCODE_A)) 
 	{
 		if (!mDirection)
 		{
@@ -303,7 +276,7 @@ void Robot::Update(float dt)
 		{
 			// If we are still in the first scene,
 			// don't let the robot go back
-			if (!game->GetScene())
+			if (!mWorld.GetScene())
 			{
 				mRect.x = -10;
 			}
@@ -311,9 +284,10 @@ void Robot::Update(float dt)
 			// scene without any crawlers or coins
 			else
 			{
-				mRect.x = game->GetScrWidth() + 10 - mRect.w;
-				game->SetScene(game->GetScene() - 1);
-				game->LoadScene(game->GetScene(), false);
+				mRect.x = mWorld.GetWidth() + 10 - mRect.w;
+				mPrevRect = mRect;	// don't slide across the screen
+				mWorld.SetScene(mWorld.GetScene() - 1);
+				mWorld.LoadScene(mWorld.GetScene(), false);
 			}
 		}
 		else
@@ -321,17 +295,18 @@ void Robot::Update(float dt)
 			mRect.x -= (int)ceil(dt * runningSpeed);
 		}
     }
-    if (game->IsKeyDown(SDL_SCANCODE_D))
+    if (mWorld.IsKeyDown(SDL_SCANCODE_D))
 	{
 		if (mDirection)
 		{
 			mDirection = 0;
 		}
-		if (mRect.x >= game->GetScrWidth() + 10.0 - mRect.w)
+		if (mRect.x >= mWorld.GetWidth() + 10.0 - mRect.w)
 		{
 			mRect.x = -10;
-			game->SetScene(game->GetScene() + 1);
-			game->LoadScene(game->GetScene(), true);
+			mPrevRect = mRect;	// don't slide across the screen
+			mWorld.SetScene(mWorld.GetScene() + 1);
+			mWorld.LoadScene(mWorld.GetScene(), true);
 		}
 		else
 		{
@@ -347,8 +322,8 @@ void Robot::Update(float dt)
 	{
 		mFalling = 1;
 		mVelocityY = 0.0f;
-		mRenderableJump->Rewind();
-		mRenderable = mRenderableJump;
+		mRenderableJump.Rewind();
+		mRenderable = &mRenderableJump;
 	}
 	mRenderable->Animate(dt);
 }
@@ -364,7 +339,7 @@ void Robot::Bounce(float velocity, bool killed)
 	else
 	{
 		mJumping = 1;
-		mRenderable = mRenderableJump;
+		mRenderable = &mRenderableJump;
 	}
 	mVelocityY = velocity;
 }
@@ -392,16 +367,16 @@ void Robot::SetAutoPilot(bool mode)
 	if (mAutoPilot != mode)
 	{
 		mAutoPilot = mode; 
-		mRenderable = mRenderableWalk;
+		mRenderable = &mRenderableWalk;
 	}
 }
 
 void Robot::SetGrayscale(bool grayscale)
 {
-	mRenderableIdle->SetGrayscale(grayscale);
-	mRenderableWalk->SetGrayscale(grayscale);
-	mRenderableJump->SetGrayscale(grayscale);
-	mRenderableDie->SetGrayscale(grayscale);
-	mRenderableCelebrate->SetGrayscale(grayscale);
-	mRenderableRun->SetGrayscale(grayscale);
+	mRenderableIdle.SetGrayscale(grayscale);
+	mRenderableWalk.SetGrayscale(grayscale);
+	mRenderableJump.SetGrayscale(grayscale);
+	mRenderableDie.SetGrayscale(grayscale);
+	mRenderableCelebrate.SetGrayscale(grayscale);
+	mRenderableRun.SetGrayscale(grayscale);
 }
\ No newline at end of file
@@ -3,17 +3,21 @@
 
 #include "GG_Renderable.h"
 
+class World;
+
 class Robot{
 
 protected:
+	World&					mWorld;			// the world it's in
 	GG::Renderable*         mRenderable;
 	GG::Rect				mRect;
-	GG::Renderable*			mRenderableIdle;
-	GG::Renderable*			mRenderableRun;
-	GG::Renderable*			mRenderableJump;
-	GG::Renderable*			mRenderableDie;
-	GG::Renderable*			mRenderableWalk;
-	GG::Renderable*			mRenderableCelebrate;
+	GG::Rect				mPrevRect; // mRect as of the previous simulation step
+	GG::Renderable			mRenderableIdle;
+	GG::Renderable			mRenderableRun;
+	GG::Renderable			mRenderableJump;
+	GG::Renderable			mRenderableDie;
+	GG::Renderable			mRenderableWalk;
+	GG::Renderable			mRenderableCelebrate;
 
 	GG::Rect				mCollisionRect;
 	GG::Rect				mBottomTileRect; // the tile that's directly above the robot
@@ -30,10 +34,11 @@ protected:
 	static const float		GRAVITY;
 
 public:
-							Robot(float x, float y);
-							~Robot();
+							Robot(World& world, float x, float y);
 	GG::Renderable*         GetRenderable() 				{ return mRenderable; }
 	const GG::Rect&			GetRect() const						{ return mRect; }
+	const GG::Rect&			GetPrevRect() const					{ return mPrevRect; }
+	void					SavePreviousRect()					{ mPrevRect = mRect; }
 	const GG::Rect&			GetCollisonRect() const				{ return mCollisionRect; }
 	const GG::Rect&			GetBottomTileRect() const			{ return mBottomTileRect; }
 	const GG::Rect&			GetTopTileRect() const			{ return mTopTileRect; }
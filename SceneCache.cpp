@@ -0,0 +1,159 @@
+#include "SceneCache.h"
+
+#include <iostream>
+
+SceneCache::SceneCache()
+    : mRenderer(NULL)
+    , mWidth(0)
+    , mHeight(0)
+{
+    mTargets[0] = NULL;
+    mTargets[1] = NULL;
+}
+
+SceneCache::~SceneCache()
+{
+    DestroyTargets();
+}
+
+void SceneCache::DestroyTargets()
+{
+    for (int i = 0; i < 2; i++) {
+        if (mTargets[i]) {
+            SDL_DestroyTexture(mTargets[i]);
+            mTargets[i] = NULL;
+        }
+    }
+}
+
+// Creates the two render targets.  Returns false if the renderer can't
+// render to textures, in which case the cache simply isn't available.
+bool SceneCache::Initialize(SDL_Renderer* renderer, int width, int height)
+{
+    mRenderer = renderer;
+    mWidth = width;
+    mHeight = height;
+
+    if (!SDL_RenderTargetSupported(renderer)) {
+        std::cerr << "*** Render targets not supported, the static scene will be drawn every frame" << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        mTargets[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!mTargets[i]) {
+            std::cerr << "*** Failed to create scene cache: " << SDL_GetError() << std::endl;
+            return false;
+        }
+
+        // the scene is opaque, no need to blend it with anything
+        SDL_SetTextureBlendMode(mTargets[i], SDL_BLENDMODE_NONE);
+    }
+
+    Invalidate();
+
+    return true;
+}
+
+// Remakes the render targets at the new size, for when the window changes
+// size.  Returns false if they can't be made, like Initialize.
+bool SceneCache::Resize(int width, int height)
+{
+    DestroyTargets();
+    return Initialize(mRenderer, width, height);
+}
+
+void SceneCache::Invalidate()
+{
+    mDirtyRects.clear();
+    mDirtyRects.push_back(GG::Rect(0, 0, mWidth, mHeight));
+}
+
+void SceneCache::InvalidateRect(const GG::Rect& rect)
+{
+    mDirtyRects.push_back(rect);
+}
+
+// Recomposites whatever has been invalidated, in both targets
+void SceneCache::Update(GG::SpriteBatch* batch, const Layer* background, const Layer* flagPole, const Grid* grid)
+{
+    if (!IsAvailable()) {
+        return;
+    }
+
+    if (mDirtyRects.empty()) {
+        return;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        SDL_SetRenderTarget(mRenderer, mTargets[i]);
+
+        for (unsigned r = 0; r < mDirtyRects.size(); r++) {
+            const GG::Rect& region = mDirtyRects[r];
+
+            SDL_RenderSetClipRect(mRenderer, &region);
+
+            // start from black, same as the screen (RenderClear ignores the clip rect)
+            SDL_SetRenderDrawBlendMode(mRenderer, SDL_BLENDMODE_NONE);
+            SDL_SetRenderDrawColor(mRenderer, 0, 0, 0, 255);
+            SDL_RenderFillRect(mRenderer, &region);
+
+            batch->Begin();
+            Compose(batch, background, flagPole, grid, i == 1, region);
+            batch->End();
+        }
+
+        SDL_RenderSetClipRect(mRenderer, NULL);
+    }
+
+    SDL_SetRenderTarget(mRenderer, NULL);
+
+    mDirtyRects.clear();
+}
+
+// Draws the static part of the scene that overlaps the region, in the
+// current render target.  This is used for filling in the cache, and for
+// drawing directly when there is no cache.
+void SceneCache::Compose(GG::SpriteBatch* batch, const Layer* background, const Layer* flagPole, const Grid* grid,
+                         bool grayscale, const GG::Rect& region)
+{
+    const Layer* layers[2] = { background, flagPole };
+    for (int i = 0; i < 2; i++) {
+        const Layer* layer = layers[i];
+        if (layer && layer->GetRenderable()) {
+            const GG::Renderable* renderable = layer->GetRenderable();
+            batch->Draw(renderable->GetTexture(grayscale)->GetPtr(),
+                        renderable->GetSourceRect(grayscale),
+                        layer->GetRect(),
+                        0.0, NULL, SDL_FLIP_NONE);
+        }
+    }
+
+    if (grid && grid->TileWidth() > 0 && grid->TileHeight() > 0) {
+        int tileWidth = grid->TileWidth();
+        int tileHeight = grid->TileHeight();
+
+        // only the tiles that overlap the region
+        int firstCol = region.x / tileWidth;
+        int firstRow = region.y / tileHeight;
+        int lastCol = (region.x + region.w - 1) / tileWidth;
+        int lastRow = (region.y + region.h - 1) / tileHeight;
+
+        if (firstCol < 0) firstCol = 0;
+        if (firstRow < 0) firstRow = 0;
+        if (lastCol >= grid->NumCols()) lastCol = grid->NumCols() - 1;
+        if (lastRow >= grid->NumRows()) lastRow = grid->NumRows() - 1;
+
+        for (int y = firstRow; y <= lastRow; y++) {
+            for (int x = firstCol; x <= lastCol; x++) {
+                const GG::Renderable* renderable = grid->GetTile(y, x)->GetRenderable();
+                if (renderable) {
+                    batch->Draw(renderable->GetTexture(grayscale)->GetPtr(),
+                                renderable->GetSourceRect(grayscale),
+                                GG::Rect(x * tileWidth, y * tileHeight, tileWidth, tileHeight),
+                                0.0, NULL, SDL_FLIP_NONE);
+                }
+            }
+        }
+    }
+}
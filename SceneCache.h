@@ -0,0 +1,72 @@
+#ifndef SCENE_CACHE_H_
+#define SCENE_CACHE_H_
+
+#include "GG_SpriteBatch.h"
+#include "Layer.h"
+#include "Grid.h"
+
+#include <vector>
+
+/*
+================================================================================
+
+SceneCache class
+
+    The background, the flag pole, and the tile grid only change when a new
+    scene gets loaded, so there's no point in drawing them piece by piece
+    every frame.  The SceneCache composites them once into a render target
+    texture, and then the whole static part of the scene can be drawn with
+    a single copy.
+
+    There are two render targets, one in color and one in grayscale, so that
+    the grayscale flashes don't force anything to be redrawn.
+
+    Invalidate marks the whole scene for recompositing (for when a new scene
+    is loaded), and InvalidateRect marks part of it.  The actual
+    compositing happens in Update, which must be called outside of a sprite
+    batch frame, since it switches render targets.  Resize remakes the
+    render targets at a new size (for when the window changes size) and
+    invalidates the whole scene.
+
+    If the renderer can't render to textures, IsAvailable returns false and
+    the static scene has to be drawn with Compose every frame instead.
+
+================================================================================
+*/
+class SceneCache {
+
+    SDL_Renderer*           mRenderer;
+
+    SDL_Texture*            mTargets[2];    // color, grayscale
+
+    int                     mWidth;
+    int                     mHeight;
+
+    std::vector<GG::Rect>   mDirtyRects;
+
+    void                    DestroyTargets();
+
+public:
+                            SceneCache();
+                            ~SceneCache();
+
+    bool                    Initialize(SDL_Renderer* renderer, int width, int height);
+    bool                    Resize(int width, int height);
+
+    bool                    IsAvailable() const     { return mTargets[0] && mTargets[1]; }
+
+    void                    Invalidate();
+    void                    InvalidateRect(const GG::Rect& rect);
+
+    void                    Update(GG::SpriteBatch* batch, const Layer* background, const Layer* flagPole, const Grid* grid);
+
+    SDL_Texture*            GetTexture(bool grayscale) const    { return mTargets[grayscale ? 1 : 0]; }
+
+    int                     GetWidth() const        { return mWidth; }
+    int                     GetHeight() const       { return mHeight; }
+
+    static void             Compose(GG::SpriteBatch* batch, const Layer* background, const Layer* flagPole, const Grid* grid,
+                                    bool grayscale, const GG::Rect& region);
+};
+
+#endif
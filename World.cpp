@@ -0,0 +1,701 @@
+#include "World.h"
+#include "Assets.h"
+#include "GG_Profiler.h"
+
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+
+// room for this many entities of each kind gets reserved up front (no level
+// has more than 15 crawlers or 15 coins, the rest is headroom for the X and
+// C keys and the meteor shower in scene 5)
+static const int ENTITY_CAPACITY = 1024;
+
+// a few times the number of tiles on the screen
+static const int BROADPHASE_BUCKETS = 4096;
+
+// with fewer entities than this, the stages of a step are over before a
+// worker would even wake up, so they don't get handed to the workers
+static const int PARALLEL_ENTITIES = 256;
+
+// how many steps a coin stays around after its sound starts (the game used
+// to count 5 frames, at the 60 Hz it was drawn at)
+static const int COIN_REMOVE_STEPS = 5 * SIM_RATE / 60;
+
+/*
+================================================================================
+
+World constructor
+
+    Sets up an empty world that draws its random numbers from a generator
+    seeded with seed.  The entity memory and the stages of a step get
+    allocated here, not during play.  Call Reset to put a robot in it and load a scene.
+
+================================================================================
+*/
+World::World(const WorldAssets& assets, unsigned seed, WorldListener* listener)
+    : mAssets(assets)
+    , mListener(listener)
+    , mWorkers(NULL)
+    , mRandom(seed)
+    , mInput(0)
+    , mTime(0.0f)
+    , mNumSteps(0)
+    , mMeteorTime(0.0f)
+    , mFlashTime(0.0f)
+    , mFlashesNeeded(0.0f)
+    , mGrid(NULL)
+    , mGrayscale(false)
+    , mRobot(NULL)
+    , mBackground(NULL)
+    , mForeground(NULL)
+    , mFlagPole(NULL)
+    , mScene(0)
+    , mPoints(0)
+{
+    mClipClock.SetClipLibrary(mAssets.clips);
+    mEntities.Initialize(mAssets.clips, &mClipClock, ENTITY_CAPACITY, &mRandom);
+    mRobotContacts.reserve(64);
+    BuildStepGraph();
+
+    // initialize the foreground
+    mForeground = new Layer(mAssets.clips->GetClip(CLIP_FOREGROUND), 0.0f, 0.0f, 800.0f, 480.0f);
+}
+
+/*
+================================================================================
+
+World destructor
+
+================================================================================
+*/
+World::~World()
+{
+    delete mRobot;
+    delete mGrid;
+    delete mBackground;
+    delete mForeground;
+    delete mFlagPole;
+}
+
+/*
+================================================================================
+
+World::Reset
+
+    Starts over in the specified scene, with a fresh robot, no points and
+    the colors on.  The time keeps going.
+
+================================================================================
+*/
+void World::Reset(int scene)
+{
+    delete mRobot;
+    mRobot = new Robot(*this, 35.0f, mAssets.height-160.0f);
+    mPoints = 0;
+    mFlashesNeeded = 0.0f;
+    SetGrayscale(false);
+
+    mScene = scene;
+    LoadScene(mScene, true);
+}
+
+/*
+================================================================================
+
+World::Step
+
+    Advances the world by one SIM_STEP, with input as the player's (see
+    IsKeyDown).  The K, X and C bits happen right here; the rest is up to
+    the robot.
+
+================================================================================
+*/
+void World::Step(StepInput input)
+{
+    mInput = input;
+
+    mRobot->SavePreviousRect();
+    mEntities.SavePreviousRects();
+
+    // counting steps instead of adding up SIM_STEP keeps the
+    // rounding errors from piling up over a long session
+    mNumSteps++;
+    mTime = (float)(mNumSteps * (double)SIM_STEP);
+
+    if (mInput & INPUT_KILL_CRAWLERS)
+    {
+        mEntities.GetCrawlers().Clear();
+    }
+    if ((mInput & INPUT_ADD_STRONG_CRAWLER) && !mRobot->IsDead())
+    {
+        float x = mRandom.Float(32, mAssets.width - 32.0f);
+        mEntities.SpawnCrawler(x, mAssets.height - 1.0f - 32.0f, true, mRandom.Sign(), mTime);
+    }
+    if ((mInput & INPUT_ADD_WEAK_CRAWLER) && !mRobot->IsDead())
+    {
+        float x = mRandom.Float(32, mAssets.width - 32.0f);
+        mEntities.SpawnCrawler(x, mAssets.height - 1.0f - 32.0f, false, mRandom.Sign(), mTime);
+    }
+
+    Update();
+}
+
+// Adds the four bytes of value to an FNV-1a hash
+static void HashAdd(Uint32* hash, Uint32 value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        *hash = (*hash ^ ((value >> (i * 8)) & 0xff)) * 16777619u;
+    }
+}
+
+/*
+================================================================================
+
+World::ComputeChecksum
+
+    Hashes the state of the world (FNV-1a over the robot, the score, the
+    scene, the crawlers and where the random number generator is), for
+    checking that a replay is still doing what the recording did, or that
+    two runs of the same world came out the same.
+
+================================================================================
+*/
+Uint32 World::ComputeChecksum() const
+{
+    Uint32 hash = 2166136261u;
+
+    const GG::Rect& robotRect = mRobot->GetCollisonRect();
+    HashAdd(&hash, robotRect.x);
+    HashAdd(&hash, robotRect.y);
+    HashAdd(&hash, mRobot->GetLives());
+    HashAdd(&hash, mPoints);
+    HashAdd(&hash, mScene);
+    HashAdd(&hash, mEntities.GetCount());
+
+    const CrawlerTable& crawlers = mEntities.GetCrawlers();
+    for (int i = 0; i < crawlers.GetCount(); i++)
+    {
+        HashAdd(&hash, crawlers.rect[i].x);
+        HashAdd(&hash, crawlers.rect[i].y);
+    }
+
+    Uint64 random = mRandom.GetState();
+    HashAdd(&hash, (Uint32)random);
+    HashAdd(&hash, (Uint32)(random >> 32));
+
+    return hash;
+}
+
+/*
+================================================================================
+
+World::IsKeyDown
+
+    The world's view of the keyboard: only the keys in the current step's
+    input (see Step), so that replays see what the recording saw.
+
+================================================================================
+*/
+bool World::IsKeyDown(SDL_Scancode s) const
+{
+    switch (s)
+    {
+    case SDL_SCANCODE_A:        return (mInput & INPUT_LEFT) != 0;
+    case SDL_SCANCODE_D:        return (mInput & INPUT_RIGHT) != 0;
+    case SDL_SCANCODE_SPACE:    return (mInput & INPUT_JUMP) != 0;
+    case SDL_SCANCODE_R:        return (mInput & INPUT_RESURRECT) != 0;
+    default:                    return false;
+    }
+}
+
+/*
+================================================================================
+
+World::BuildStepGraph
+
+    Splits a step into stages and works out which ones have to wait for
+    which.  The robot moves first, then the contacts get found and the coins
+    and crawlers the robot touched get handled, one after the other (they
+    change the score, the robot, and the colors of everything).  After that,
+    the coins spin, the crawlers think and move, and the explosions burn,
+    all at the same time, since each of them only touches its own kind of
+    entity.  The clip clock ticks along with them (picking up a coin is the
+    only thing that reads it during a step).  The meteors that hit something
+    can only blow up after the old explosions moved on (or the new ones
+    would get a head start), and then the rest of them fall while the
+    mushrooms and the flashes get handled.  New meteors come last, after the
+    crawlers have drawn their random numbers, so the numbers come out in the
+    same order no matter which stage finishes first.
+
+    Changing colors (see SetGrayscale) only writes the grayscale flags of
+    the entities, which none of the stages it can run next to look at.
+
+================================================================================
+*/
+void World::BuildStepGraph()
+{
+    GG::TaskGraph& g = mStepGraph;
+
+    int robot       = g.AddTask("Update.Robot",         [this]() { UpdateRobot(SIM_STEP); });
+    int contacts    = g.AddTask("Update.Contacts",      [this]() { FindRobotContacts(); });
+    int coinHits    = g.AddTask("Update.CoinHits",      [this]() { HandleCoinContacts(); });
+    int crawlerHits = g.AddTask("Update.CrawlerHits",   [this]() { HandleCrawlerContacts(); });
+    int coins       = g.AddTask("Update.Coins",         [this]() { mEntities.GetCoins().anim.Animate(SIM_STEP); });
+    int clipClock   = g.AddTask("Update.ClipClock",     [this]() { mClipClock.Advance(SIM_STEP); });
+    int crawlers    = g.AddTask("Update.Crawlers",      [this]() { mEntities.UpdateCrawlers(SIM_STEP, mTime, mGrid); });
+    int explosions  = g.AddTask("Update.Explosions",    [this]() { mEntities.UpdateExplosions(SIM_STEP); });
+    int meteorHits  = g.AddTask("Update.MeteorHits",    [this]() { HandleMeteorContacts(); });
+    int meteors     = g.AddTask("Update.Meteors",       [this]() { mEntities.UpdateMeteors(SIM_STEP); });
+    int mushrooms   = g.AddTask("Update.Mushrooms",     [this]() { HandleMushroomContacts(); });
+    int flashes     = g.AddTask("Update.Flashes",       [this]() { UpdateFlashes(); });
+    int newMeteors  = g.AddTask("Update.NewMeteors",    [this]() { SpawnMeteors(); });
+
+    g.AddEdge(robot, contacts);
+    g.AddEdge(contacts, coinHits);
+    g.AddEdge(coinHits, crawlerHits);
+
+    g.AddEdge(crawlerHits, coins);
+    g.AddEdge(crawlerHits, clipClock);
+    g.AddEdge(crawlerHits, crawlers);
+    g.AddEdge(crawlerHits, explosions);
+
+    g.AddEdge(explosions, meteorHits);
+    g.AddEdge(meteorHits, meteors);
+    g.AddEdge(meteorHits, mushrooms);
+    g.AddEdge(mushrooms, flashes);
+
+    g.AddEdge(coins, newMeteors);
+    g.AddEdge(crawlers, newMeteors);
+    g.AddEdge(meteors, newMeteors);
+    g.AddEdge(flashes, newMeteors);
+}
+
+/*
+================================================================================
+
+World::Update
+
+    Performs the game logic of one SIM_STEP.  The stages (see
+    BuildStepGraph) run on the worker threads once there are enough
+    entities for that to pay off, and on this thread otherwise.
+
+================================================================================
+*/
+void World::Update()
+{
+    GG_PROFILE_SCOPE("Update");
+
+    bool parallel = mWorkers && mEntities.GetCount() >= PARALLEL_ENTITIES;
+    mStepGraph.Run(parallel ? mWorkers : NULL);
+}
+
+/*
+================================================================================
+
+World::UpdateRobot
+
+================================================================================
+*/
+void World::UpdateRobot(float dt)
+{
+    // If the robot has reached the last scene
+    // disable its controls and play game over animation
+    if (mScene == 6 && !mRobot->GetJumping() && !mRobot->GetFalling())
+    {
+        mRobot->SetAutoPilot(true);
+    }
+    mRobot->Update(dt);
+}
+
+/*
+================================================================================
+
+World::FindRobotContacts
+
+    Refills the broadphase with the entities' current positions, and finds
+    the ones that overlap the robot.  The HandleXContacts methods below
+    handle those contacts for each kind of entity.
+
+    The contacts are sorted from the highest id down, which puts each
+    kind's highest indices first.  That way, removing an entity (which
+    moves the last one of its kind into its place) never disturbs a
+    contact that hasn't been handled yet.
+
+================================================================================
+*/
+void World::FindRobotContacts()
+{
+    // the dead crawlers go first, so they don't get in the way
+    mEntities.RemoveDeadCrawlers();
+
+    mBroadphase.Clear();
+    mEntities.InsertColliders(&mBroadphase);
+
+    mRobotContacts.clear();
+    mBroadphase.Query(mRobot->GetCollisonRect(), &mRobotContacts);
+    std::sort(mRobotContacts.begin(), mRobotContacts.end(), std::greater<Uint32>());
+}
+
+/*
+================================================================================
+
+World::HandleCoinContacts
+
+    Picks up the coins the robot touches.
+
+================================================================================
+*/
+void World::HandleCoinContacts()
+{
+    CoinTable& coins = mEntities.GetCoins();
+
+    for (size_t c = 0; c < mRobotContacts.size(); c++)
+    {
+        if (EntityStore::GetIdKind(mRobotContacts[c]) != EntityStore::KIND_COIN)
+        {
+            continue;
+        }
+        int i = EntityStore::GetIdIndex(mRobotContacts[c]);
+
+        //I have found that the sound is delayed...So I start it a bit earlier than the actualy delete of the Coin
+        if (coins.soundDelay[i] == 0)
+        {
+            // You get 5 points!
+            mPoints += 5;
+            PlaySound(SOUND_COIN);
+            coins.soundDelay[i]++;
+            // it stops spinning while it's being picked up
+            coins.anim[i].Unsync();
+            coins.anim[i].SetRate(0.0f);
+        }
+        //Once the sound has had a head start then it Deletes the coin
+        else if (coins.soundDelay[i] >= COIN_REMOVE_STEPS)
+        {
+            coins.Remove(i);
+        }
+        else
+        {
+            coins.soundDelay[i]++;
+        }
+    }
+}
+
+/*
+================================================================================
+
+World::HandleCrawlerContacts
+
+    Handles the robot stomping on crawlers or running into them.  The
+    crawlers think and move afterwards (see EntityStore::UpdateCrawlers).
+
+================================================================================
+*/
+void World::HandleCrawlerContacts()
+{
+    CrawlerTable& crawlers = mEntities.GetCrawlers();
+    const GG::Rect& robotRect = mRobot->GetCollisonRect();
+
+    for (size_t c = 0; c < mRobotContacts.size(); c++)
+    {
+        if (EntityStore::GetIdKind(mRobotContacts[c]) != EntityStore::KIND_CRAWLER)
+        {
+            continue;
+        }
+        int i = EntityStore::GetIdIndex(mRobotContacts[c]);
+
+        const GG::Rect& rect = crawlers.collisionRect[i];
+        const CrawlerAI& ai = crawlers.ai[i];
+
+        // If the robot is falling from a jump or just falling
+        if (mRobot->GetVerticalVelocity() > 0.0 && (mRobot->GetJumping() || mRobot->GetFalling()))
+        {
+            // Check if the robot has started squashing the poor crawler (from above)
+            if (robotRect.y < rect.y && ai.state != CRAWLER_DYING)
+            {
+                // You get 25 points!
+                mPoints += 25;
+                PlaySound(ai.jumpedOn ? SOUND_STOMP : SOUND_STOMP_NO_KILL);
+                mRobot->Bounce(-400, false);
+                mEntities.SetCrawlerState(i, CRAWLER_DYING, mTime);
+            }
+        }
+        // If the robot runs into a crawler, the robot must die (but it should not falling onto it from above)
+        else if (!mRobot->IsDead() && mRobot->GetVerticalVelocity() == -850.0f && ai.state != CRAWLER_DYING)
+        {
+            // You lose a life:(
+            mRobot->SetLives(mRobot->GetLives() - 1);
+            PlaySound(SOUND_DIE);
+            // Stop the background music
+            if (mListener)
+            {
+                mListener->StopMusic();
+            }
+            if (mRobot->GetLives() == 0)
+            {
+                if (mListener)
+                {
+                    printf("\nGame over music is being played!");
+                    mListener->SetMusicVolume(32);
+                    mListener->PlayMusic(MUSIC_BAD_GAME_OVER, 0);
+                }
+                SetGrayscale(true);
+            }
+            mRobot->Bounce(-400, true);             // kill the robot
+        }
+    }
+}
+
+/*
+================================================================================
+
+World::HandleMeteorContacts
+
+    Blows up the meteors that hit the robot (killing it) or the ground.
+    The rest fall afterwards (see EntityStore::UpdateMeteors).
+
+================================================================================
+*/
+void World::HandleMeteorContacts()
+{
+    MeteorTable& meteors = mEntities.GetMeteors();
+    int groundY = mAssets.height-32-64;
+
+    // If the meteor has hit the robot from the top, destroy it with an explosion and also kill the robot
+    for (size_t c = 0; c < mRobotContacts.size(); c++)
+    {
+        if (EntityStore::GetIdKind(mRobotContacts[c]) != EntityStore::KIND_METEOR)
+        {
+            continue;
+        }
+        int i = EntityStore::GetIdIndex(mRobotContacts[c]);
+
+        // reaching the ground comes first
+        const GG::Rect& rect = meteors.rect[i];
+        if (rect.y > groundY || mRobot->IsDead())
+        {
+            continue;
+        }
+
+        // You lose a life:(
+        mRobot->SetLives(mRobot->GetLives() - 1);
+        PlaySound(SOUND_THUD);
+        PlaySound(SOUND_DIE);
+        // Stop the background music
+        if (mListener)
+        {
+            mListener->StopMusic();
+        }
+        if (mRobot->GetLives() == 0)
+        {
+            if (mListener)
+            {
+                mListener->SetMusicVolume(32);
+                mListener->PlayMusic(MUSIC_BAD_GAME_OVER, 0);
+            }
+            SetGrayscale(true);
+        }
+        mRobot->Bounce(-400, true);             // kill the robot
+        mEntities.SpawnExplosion(rect.x + rect.w / 2, rect.y + rect.h / 2);
+        meteors.Remove(i);
+    }
+
+    // If the meteor has reached the ground, destroy it with an explosion
+    int i = 0;
+    while (i < meteors.GetCount())
+    {
+        const GG::Rect& rect = meteors.rect[i];
+        if (rect.y > groundY)
+        {
+            if (!mRobot->IsDead())
+            {
+                PlaySound(SOUND_THUD);
+            }
+            mEntities.SpawnExplosion(rect.x + rect.w / 2, rect.y + rect.h / 2);
+            meteors.Remove(i);      // the last meteor moves in here, so don't advance
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+/*
+================================================================================
+
+World::HandleMushroomContacts
+
+    If the robot collects a mushroom, it gets an extra life!
+
+================================================================================
+*/
+void World::HandleMushroomContacts()
+{
+    MushroomTable& mushrooms = mEntities.GetMushrooms();
+
+    for (size_t c = 0; c < mRobotContacts.size(); c++)
+    {
+        if (EntityStore::GetIdKind(mRobotContacts[c]) != EntityStore::KIND_MUSHROOM || mRobot->IsDead())
+        {
+            continue;
+        }
+
+        mRobot->SetLives(mRobot->GetLives() + 1);
+        SetFlashesNeeded(2);
+        PlaySound(SOUND_ONEUP);
+        mushrooms.Remove(EntityStore::GetIdIndex(mRobotContacts[c]));
+    }
+}
+
+// Generates a grayscale flash every 50 ms (if needed)
+void World::UpdateFlashes()
+{
+    if (mFlashesNeeded > 0.0f)
+    {
+        if (mTime - mFlashTime > 0.1)
+        {
+            if ((int)mFlashesNeeded % 2)
+            {
+                SetGrayscale(false);
+            }
+            else
+            {
+                SetGrayscale(true);
+            }
+            mFlashesNeeded--;
+            mFlashTime = mTime;
+        }
+    }
+}
+
+// Creates a new meteor every 0.2 to 1.2 seconds in scene 5
+void World::SpawnMeteors()
+{
+    if (mTime - mMeteorTime > mRandom.Unit() + 0.2 && mScene == 5)
+    {
+        int randomX = mRandom.Int(mAssets.width-64);
+        int randomRotation = mRandom.Int(90) + 180;
+        randomRotation = (randomRotation % 2) ? randomRotation : -randomRotation;
+        mEntities.SpawnMeteor(randomX, -64, (float)randomRotation);
+        // timestamp this meteor!
+        mMeteorTime = mTime;
+    }
+}
+
+// The sounds go to the listener, if there is one
+void World::PlaySound(WorldSound sound)
+{
+    if (mListener)
+    {
+        mListener->PlaySound(sound);
+    }
+}
+
+void World::StopSounds()
+{
+    if (mListener)
+    {
+        mListener->StopSounds();
+    }
+}
+
+// Load the scene with/without the crawlers and coins
+void World::LoadScene(int scene, bool items)
+{
+    GG_PROFILE_SCOPE("LoadScene");
+
+    mScene = scene;
+
+    // delete all crawlers, coins, meteors and mushrooms (the explosions can finish)
+    mEntities.GetCrawlers().Clear();
+    mEntities.GetCoins().Clear();
+    mEntities.GetMeteors().Clear();
+    mEntities.GetMushrooms().Clear();
+
+    delete mBackground;
+    mBackground = NULL;
+
+    // only the game over scene has a flag pole (it gets made below)
+    delete mFlagPole;
+    mFlagPole = NULL;
+
+    delete mGrid;
+    mGrid = NULL;
+
+    static const GG::ClipId backgrounds[] = {
+        CLIP_BACKGROUND1,
+        CLIP_BACKGROUND2,
+        CLIP_BACKGROUND3,
+        CLIP_BACKGROUND4,
+        CLIP_BACKGROUND5,
+        CLIP_BACKGROUND6,
+        CLIP_BACKGROUND7,
+    };
+    mBackground = new Layer(mAssets.clips->GetClip(backgrounds[mScene]), 0.0f, 0.0f, 800.0f, 480.0f);
+
+    // the level was read at startup, only the grid and entities get made here
+    mGrid = BuildLevel((*mAssets.levels)[mScene], *this, items);
+
+    // collision cells are the size of the tiles
+    if (mGrid)
+    {
+        mBroadphase.Initialize(mGrid->TileWidth(), mGrid->TileHeight(), BROADPHASE_BUCKETS);
+    }
+
+    // First scene
+    if (mScene == 0 && mListener)
+    {
+        // Play the background music
+        mListener->SetMusicVolume(32);
+        mListener->PlayMusic(MUSIC_MAIN, -1);
+    }
+    // Game over scene
+    if (mScene == 6)
+    {
+        mFlagPole = new Layer(mAssets.clips->GetClip(CLIP_FLAG_POLE), mAssets.width *.7f, 68.0f, 124.0f, 380.0f);
+        if (mListener)
+        {
+            mListener->SetMusicVolume(128);
+            mListener->PlayMusic(MUSIC_GOOD_GAME_OVER, 0);
+        }
+    }
+
+    // the static part of the scene has to be composited again
+    if (mListener)
+    {
+        mListener->SceneLoaded();
+    }
+}
+
+// Tells the entities to use their grayscale renderables
+// instead of their colored ones (applies to all entities)
+void World::SetGrayscale(bool grayscale)
+{
+    GG_PROFILE_SCOPE("Update.Grayscale");
+
+    mGrayscale = grayscale;
+
+    if (mRobot) mRobot->SetGrayscale(grayscale);
+    if (mBackground) mBackground->SetGrayscale(grayscale);
+    if (mForeground) mForeground->SetGrayscale(grayscale);
+    if (mFlagPole) mFlagPole->SetGrayscale(grayscale);
+
+    if (mGrid)
+    {
+        for (int y = 0; y < mGrid->NumRows(); y++)
+        {
+            for (int x = 0; x < mGrid->NumCols(); x++)
+            {
+                Tile* tile = mGrid->GetTile(y, x);
+                if (tile->GetRenderable())
+                {
+                    tile->SetGrayscale(grayscale);
+                }
+            }
+        }
+    }
+
+    mEntities.SetGrayscale(grayscale);
+}
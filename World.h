@@ -0,0 +1,197 @@
+#ifndef WORLD_H_
+#define WORLD_H_
+
+#include "GG_Graphics.h"
+#include "GG_SpatialHash.h"
+#include "GG_TaskGraph.h"
+#include "Grid.h"
+#include "EntityStore.h"
+#include "Robot.h"
+#include "Layer.h"
+#include "Level.h"
+#include "InputRecording.h"
+
+#include <vector>
+
+// the simulation always advances in steps of this many seconds, however
+// fast or slow the frames come
+static const int SIM_RATE = 120;
+static const float SIM_STEP = 1.0f / SIM_RATE;
+
+enum WorldSound {
+    SOUND_COIN,
+    SOUND_JUMP,
+    SOUND_STOMP,
+    SOUND_STOMP_NO_KILL,
+    SOUND_DIE,
+    SOUND_BLOCK,
+    SOUND_THUD,
+    SOUND_ONEUP
+};
+
+enum WorldMusic {
+    MUSIC_MAIN,
+    MUSIC_GOOD_GAME_OVER,
+    MUSIC_BAD_GAME_OVER
+};
+
+/*
+================================================================================
+
+WorldListener class
+
+    What a world tells the outside about: the sounds and music that go
+    with what happens in it, and new scenes (which the scene cache has to
+    composite again).  Game listens to the world it shows.  Worlds that
+    nobody watches (like the ones in a batch run) have no listener.
+
+================================================================================
+*/
+class WorldListener {
+
+public:
+    virtual                 ~WorldListener() {}
+
+    virtual void            PlaySound(WorldSound /*sound*/)                 {}
+    virtual void            StopSounds()                                    {}
+    virtual void            PlayMusic(WorldMusic /*music*/, int /*loops*/)  {}
+    virtual void            StopMusic()                                     {}
+    virtual void            SetMusicVolume(int /*volume*/)                  {}
+    virtual void            SceneLoaded()                                   {}
+};
+
+/*
+================================================================================
+
+WorldAssets struct
+
+    The things every world uses and none of them changes: the animation
+    clips (which point at the textures), the parsed levels (one per scene,
+    see LEVEL_FILES), and the size of the screen the worlds are laid out
+    for.  Game loads them once, and
+    any number of worlds can read them at the same time, from any thread.
+
+================================================================================
+*/
+struct WorldAssets {
+    const GG::ClipLibrary*          clips;
+    const std::vector<LevelData>*   levels;
+    int                             width;
+    int                             height;
+};
+
+/*
+================================================================================
+
+World class
+
+    One running game: the robot, the entities, the scene and its grid,
+    the score and the time, and the random number generator they all
+    draw from.  The robot and the level loader get the world by
+    reference, and everything they change is in it, so any number of
+    worlds can exist at once, and worlds on different threads stay out of
+    each other's way (the assets they share are only ever read).
+
+    Step advances the world by one SIM_STEP with the given input.  A world
+    only ever sees the player through that input (see IsKeyDown), and only
+    ever draws random numbers from its own generator, so the same seed and
+    the same inputs give the same world, bit for bit, on any thread.
+
+    A step is made of stages, some of which don't depend on each other
+    (see BuildStepGraph).  Given workers with SetWorkers, a busy world
+    runs those at the same time, and still comes out the same as running
+    them one after the other.  The sounds and music can then come from a
+    worker thread, in the middle of Step.
+
+    Drawing is up to whoever owns the world (see Game::Draw); the world
+    just keeps each moving thing's previous rect around for it.
+
+================================================================================
+*/
+class World {
+
+    WorldAssets             mAssets;
+    WorldListener*          mListener;      // NULL if nobody's listening
+    GG::ThreadPool*         mWorkers;       // NULL runs every step on the calling thread
+    GG::Random              mRandom;
+
+    StepInput               mInput;         // the input of the current (or last) step
+    float                   mTime;          // simulated time since the world was made (in seconds)
+    Uint64                  mNumSteps;
+
+    float                   mMeteorTime;    // time that the last meteor was created (in seconds)
+    float                   mFlashTime;     // time that the last grayscale/color switch occured
+    float                   mFlashesNeeded; // number of flashes that are needed
+
+    Grid*                   mGrid;
+    bool                    mGrayscale;     // are the entities currently drawn in grayscale?
+
+    Robot*                  mRobot;
+    Layer*                  mBackground;
+    Layer*                  mForeground;
+    Layer*                  mFlagPole;
+
+    GG::ClipClock           mClipClock;     // what the coins and idle crawlers animate by
+    EntityStore             mEntities;      // crawlers, coins, meteors, explosions and mushrooms
+    GG::SpatialHash         mBroadphase;    // the entities that can be touched, refilled every step
+    std::vector<Uint32>     mRobotContacts; // entities the robot touches this step (highest ids first)
+    GG::TaskGraph           mStepGraph;     // the stages of Update
+
+    int                     mScene;
+    int                     mPoints;
+
+    void                    BuildStepGraph();
+    void                    Update();
+    void                    UpdateRobot(float dt);
+    void                    FindRobotContacts();
+    void                    HandleCoinContacts();
+    void                    HandleCrawlerContacts();
+    void                    HandleMeteorContacts();
+    void                    HandleMushroomContacts();
+    void                    UpdateFlashes();
+    void                    SpawnMeteors();
+
+                            World(const World&);
+    World&                  operator= (const World&);
+
+public:
+                            World(const WorldAssets& assets, unsigned seed, WorldListener* listener);
+                            ~World();
+
+    void                    SetWorkers(GG::ThreadPool* workers) { mWorkers = workers; }
+
+    void                    Reset(int scene);
+    void                    Step(StepInput input);
+
+    Uint32                  ComputeChecksum() const;
+
+    const GG::ClipLibrary*  GetClips() const                { return mAssets.clips; }
+    int                     GetWidth() const                { return mAssets.width; }
+    int                     GetHeight() const               { return mAssets.height; }
+
+    GG::Random*             GetRandom()                     { return &mRandom; }
+    float                   GetTime() const                 { return mTime; }
+    Uint64                  GetNumSteps() const             { return mNumSteps; }
+
+    Grid*                   GetGrid() const                 { return mGrid; }
+    Robot*                  GetRobot() const                { return mRobot; }
+    Layer*                  GetBackground() const           { return mBackground; }
+    Layer*                  GetFlagPole() const             { return mFlagPole; }
+    EntityStore*            GetEntities()                   { return &mEntities; }
+    const EntityStore*      GetEntities() const             { return &mEntities; }
+    bool                    IsGrayscale() const             { return mGrayscale; }
+    int                     GetPoints() const               { return mPoints; }
+
+    int                     GetScene() const                { return mScene; }
+    void                    SetScene(int scene)             { mScene = scene; }
+    void                    LoadScene(int scene, bool items);
+
+    bool                    IsKeyDown(SDL_Scancode s) const;
+    void                    PlaySound(WorldSound sound);
+    void                    StopSounds();
+
+    void                    SetGrayscale(bool grayscale);
+    void                    SetFlashesNeeded(int flashes)   { mFlashesNeeded = (float)flashes*2.0f; }
+};
+
+#endif
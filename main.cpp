@@ -1,4 +1,5 @@
 #include "GG_Common.h"
+#include "GG_Cpu.h"
 
 #include "Game.h"
 
@@ -9,8 +10,13 @@ int main(int argc, char** argv)
     // initialize the random number generator
     GG::InitRandom();
 
-    // create and run a Game instance
-    Game::GetInstance()->Run();
+    // find out which SIMD code paths the CPU can run (before any threads start)
+    GG::InitSimdLevel();
+
+    // create and run a Game instance (unless the command line asked for something else)
+    if (Game::GetInstance()->Configure(argc, argv)) {
+        Game::GetInstance()->Run();
+    }
 
     return 0;
 }